@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nest/bounded_queue.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Holds the result of decoding an asset on a worker thread of an `AssetStreamer`.
+template <typename Data>
+struct DecodedAsset {
+    /// Holds the decoded data, e.g. vertices and indices, or the source code of shaders.
+    Data data;
+
+    /// Holds the number of bytes the upload of `data` transfers, which counts against the upload budget.
+    std::size_t size = 0u;
+};
+
+/// Holds the limits of the work the renderer thread does on uploads per frame. Uploads stop once either limit is
+/// reached, the upload crossing it still completes, so at least one asset is uploaded per frame regardless of its size.
+struct UploadBudget {
+    /// Holds the maximum number of bytes uploaded per frame.
+    std::size_t bytes_per_frame = 4u << 20u;
+
+    /// Holds the maximum time spent on uploads per frame.
+    std::chrono::microseconds time_per_frame{2000};
+};
+
+/// A handle of an asset being streamed by an `AssetStreamer`. The asset becomes available once it's uploaded. Handles
+/// are cheap to copy, and copies refer to the same asset, which is destroyed along with the last of them. Assets
+/// owning OpenGL objects, e.g. a `Mesh`, must therefore lose their last handle on the renderer thread.
+template <typename T>
+class AssetFuture final {
+  public:
+    /// Constructs an empty `AssetFuture`, which refers to no asset.
+    AssetFuture() noexcept = default;
+
+    /// \returns `true` when this `AssetFuture` refers to an asset, `false` otherwise.
+    explicit operator bool() const
+    {
+        return nullptr != state;
+    }
+
+    /// \returns `true` when the asset has been uploaded, and can be used, `false` otherwise.
+    bool is_ready() const
+    {
+        return state && Ready == state->status.load(std::memory_order_acquire);
+    }
+
+    /// \returns `true` when decoding or uploading the asset has thrown an exception, or when the streamer has been
+    /// destroyed before uploading it, `false` otherwise.
+    bool has_failed() const
+    {
+        return state && Failed == state->status.load(std::memory_order_acquire);
+    }
+
+    /// \returns The uploaded asset. Call this only when `is_ready()`.
+    T& get() const
+    {
+        return *state->value;
+    }
+
+  private:
+    friend class AssetStreamer;
+    friend class BackgroundUploader;
+
+    enum Status { Pending, Ready, Failed };
+
+    /// The state shared by the copies of an `AssetFuture` and by the streamer.
+    struct State {
+        std::atomic<Status> status{Pending};
+        std::optional<T> value;
+    };
+
+    /// Holds the state of the asset.
+    std::shared_ptr<State> state;
+};
+
+/// A class for streaming assets without stalling frames.
+///
+/// Assets are loaded in two steps. The first one, e.g. reading and decoding a file, runs on a pool of worker threads.
+/// Decoded assets are passed through a bounded queue to the second step, e.g. `Mesh::Builder` or
+/// `ShaderProgram::Builder`, which needs the OpenGL context, and so runs on the renderer thread. Call `upload` from a
+/// command at the beginning of every frame: it uploads decoded assets until the `UploadBudget` of the frame is spent,
+/// so streaming a level spreads over frames rather than stalling one of them.
+class AssetStreamer final {
+  public:
+    /// Holds the default capacity of the queue of decoded assets.
+    static constexpr std::size_t DefaultCapacity = 64u;
+
+    /// Constructs a streamer of the given upload `budget`, which decodes assets on `num_threads` worker threads. At
+    /// most `capacity` decoded assets wait for upload, the workers wait for room in the queue beyond that.
+    explicit AssetStreamer(UploadBudget const& budget = {},
+                           std::size_t const num_threads = std::max(2u, std::thread::hardware_concurrency()) - 1u,
+                           std::size_t const capacity = DefaultCapacity)
+        : decoded(capacity)
+    {
+        set_budget(budget);
+        for (std::size_t i = 0u; i < std::max<std::size_t>(1u, num_threads); ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~AssetStreamer() noexcept
+    {
+        {
+            std::unique_lock lock(mutex);
+            stopping = true;
+        }
+        requested.notify_all();
+        space_available.notify_all();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Fails the assets, which will never be uploaded, so that their futures don't stay pending.
+        for (auto& job : requests) {
+            job(true);
+        }
+        for (std::unique_ptr<PendingUpload> pending; decoded.try_pop(pending); pending.reset()) {
+            pending->cancel();
+            num_pending.fetch_sub(1u);
+        }
+    }
+
+    AssetStreamer(AssetStreamer const&) = delete;
+    AssetStreamer& operator=(AssetStreamer const&) = delete;
+
+    /// Starts streaming an asset: `decode()` is called on a worker thread, and returns a `DecodedAsset`, whose data is
+    /// then passed to `upload(data)` on the renderer thread, which returns the asset. Both are copied into the
+    /// streamer. Assets are decoded in the order they are requested, but may be uploaded out of order.
+    /// \returns A handle of the asset, which becomes ready once it's uploaded.
+    template <typename Decode, typename Upload> // Decode models DecodedAsset<Data>(), Upload models T(Data&&)
+    auto stream(Decode decode, Upload upload)
+    {
+        using Data = decltype(std::declval<Decode&>()().data);
+        using T = std::invoke_result_t<Upload&, Data&&>;
+
+        AssetFuture<T> future;
+        future.state = std::make_shared<typename AssetFuture<T>::State>();
+
+        auto job = [this, decode = std::move(decode), upload = std::move(upload),
+                    state = future.state](bool const cancelled) {
+            std::unique_ptr<PendingUpload> pending;
+            try {
+                if (!cancelled) {
+                    pending = std::make_unique<TypedUpload<T, Data, Upload>>(decode(), upload, state);
+                }
+            }
+            catch (...) {
+            }
+
+            if (!pending) {
+                state->status.store(AssetFuture<T>::Failed, std::memory_order_release);
+                num_pending.fetch_sub(1u);
+                return;
+            }
+            push(std::move(pending));
+        };
+
+        num_pending.fetch_add(1u);
+        {
+            std::unique_lock lock(mutex);
+            requests.emplace_back(std::move(job));
+        }
+        requested.notify_one();
+        return future;
+    }
+
+    /// Uploads decoded assets until the budget of the frame is spent. Call this on the renderer thread once per frame.
+    /// \returns The number of uploaded assets.
+    std::size_t upload()
+    {
+        auto const start = Clock::now();
+        auto const bytes_per_frame = budget_bytes.load(std::memory_order_relaxed);
+        auto const time_per_frame = std::chrono::microseconds(budget_microseconds.load(std::memory_order_relaxed));
+
+        std::size_t num_uploaded = 0u;
+        std::size_t num_bytes = 0u;
+        for (std::unique_ptr<PendingUpload> pending; decoded.try_pop(pending); pending.reset()) {
+            num_bytes += pending->size;
+            pending->upload();
+            ++num_uploaded;
+
+            if (num_bytes >= bytes_per_frame || Clock::now() - start >= time_per_frame) {
+                break;
+            }
+        }
+
+        if (num_uploaded) {
+            num_pending.fetch_sub(num_uploaded);
+
+            // Wakes up the workers waiting for room in the queue.
+            std::unique_lock lock(mutex);
+            space_available.notify_all();
+        }
+        return num_uploaded;
+    }
+
+    /// Sets the upload `budget` of a frame. It takes effect on the next `upload` call.
+    void set_budget(UploadBudget const& budget)
+    {
+        budget_bytes.store(budget.bytes_per_frame, std::memory_order_relaxed);
+        budget_microseconds.store(budget.time_per_frame.count(), std::memory_order_relaxed);
+    }
+
+    /// \returns The number of assets, which have been requested, but neither uploaded nor failed yet.
+    std::size_t get_pending_count() const
+    {
+        return num_pending.load();
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    /// A decoded asset waiting for upload.
+    struct PendingUpload {
+        virtual ~PendingUpload() = default;
+
+        /// Uploads the asset, and makes its future ready.
+        virtual void upload() = 0;
+
+        /// Makes the future of the asset failed without uploading it.
+        virtual void cancel() = 0;
+
+        /// Holds the number of bytes the upload transfers.
+        std::size_t size = 0u;
+    };
+
+    /// A decoded asset of the given type `T` waiting for upload.
+    template <typename T, typename Data, typename Upload>
+    struct TypedUpload final : PendingUpload {
+        TypedUpload(DecodedAsset<Data>&& decoded, Upload const& upload,
+                    std::shared_ptr<typename AssetFuture<T>::State> state)
+            : data(std::move(decoded.data)), upload_fn(upload), state(std::move(state))
+        {
+            size = decoded.size;
+        }
+
+        void upload() override
+        {
+            try {
+                state->value.emplace(upload_fn(std::move(data)));
+                state->status.store(AssetFuture<T>::Ready, std::memory_order_release);
+            }
+            catch (...) {
+                state->status.store(AssetFuture<T>::Failed, std::memory_order_release);
+            }
+        }
+
+        void cancel() override
+        {
+            state->status.store(AssetFuture<T>::Failed, std::memory_order_release);
+        }
+
+        Data data;
+        Upload upload_fn;
+        std::shared_ptr<typename AssetFuture<T>::State> state;
+    };
+
+    /// Is run by every worker thread: decodes the requested assets one by one.
+    void work()
+    {
+        for (;;) {
+            std::function<void(bool)> job;
+            {
+                std::unique_lock lock(mutex);
+                requested.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (stopping) {
+                    return;
+                }
+                job = std::move(requests.front());
+                requests.pop_front();
+            }
+            job(false);
+        }
+    }
+
+    /// Passes the given decoded asset to the renderer thread, waiting while the queue is full. The asset fails if the
+    /// streamer is being destroyed in the meantime.
+    void push(std::unique_ptr<PendingUpload> pending)
+    {
+        if (decoded.try_push(std::move(pending))) {
+            return;
+        }
+
+        // Slow path: the renderer is behind, wait until it uploads some assets. The timeout covers a wake-up sent
+        // between the failed push and the wait.
+        std::unique_lock lock(mutex);
+        while (!stopping && !decoded.try_push(std::move(pending))) {
+            space_available.wait_for(lock, std::chrono::milliseconds(1));
+        }
+
+        if (pending) {
+            pending->cancel();
+            num_pending.fetch_sub(1u);
+        }
+    }
+
+    /// Holds the worker threads.
+    std::vector<std::thread> workers;
+
+    /// Holds a handle to a mutex which protects `requests` and `stopping`.
+    std::mutex mutex;
+
+    /// Is used to wake up the workers when an asset is requested.
+    std::condition_variable requested;
+
+    /// Is used to wake up the workers waiting for room in `decoded`.
+    std::condition_variable space_available;
+
+    /// Holds the jobs decoding the requested assets, the oldest one first. A job called with `true` fails its asset
+    /// instead of decoding it.
+    std::deque<std::function<void(bool)>> requests;
+
+    /// Holds the decoded assets waiting for upload.
+    BoundedQueue<std::unique_ptr<PendingUpload>> decoded;
+
+    /// Holds the number of assets, which have been requested, but neither uploaded nor failed yet.
+    std::atomic<std::size_t> num_pending{0u};
+
+    /// Hold the upload budget of a frame.
+    /// @{
+    std::atomic<std::size_t> budget_bytes{0u};
+    std::atomic<std::chrono::microseconds::rep> budget_microseconds{0};
+    /// @}
+
+    /// Holds a boolean which specifies whether the workers shall stop.
+    bool stopping = false;
+};
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace nest {
+inline namespace v1 {
+
+/// A lock-free queue of a fixed capacity, which can be used by any number of producer and consumer threads.
+///
+/// Every cell of the ring holds a sequence number, which tells whether the cell is ready to be written to or read
+/// from on the current lap. Producers and consumers claim cells with a CAS on their own position counter, so neither
+/// of them ever blocks another one.
+template <typename T> // T models DefaultConstructible and MoveAssignable
+class BoundedQueue final {
+  public:
+    /// Constructs a queue, which can hold at least `capacity` values. The capacity is rounded up to a power of two.
+    explicit BoundedQueue(std::size_t const capacity)
+    {
+        std::size_t size = 2u;
+        while (size < capacity) {
+            size <<= 1u;
+        }
+
+        cells = std::make_unique<Cell[]>(size);
+        mask = size - 1u;
+
+        for (std::size_t i = 0u; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(BoundedQueue const&) = delete;
+    BoundedQueue& operator=(BoundedQueue const&) = delete;
+
+    /// Moves the given `value` into the queue.
+    /// \returns `true` on success, `false` when the queue is full. In the latter case `value` is left untouched.
+    bool try_push(T&& value)
+    {
+        auto position = enqueue_position.load(std::memory_order_relaxed);
+
+        for (;;) {
+            auto& cell = cells[position & mask];
+            auto const sequence = cell.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (0 == difference) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1u, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Moves the oldest value in the queue into `value`.
+    /// \returns `true` on success, `false` when the queue is empty.
+    bool try_pop(T& value)
+    {
+        auto position = dequeue_position.load(std::memory_order_relaxed);
+
+        for (;;) {
+            auto& cell = cells[position & mask];
+            auto const sequence = cell.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast<std::ptrdiff_t>(sequence - (position + 1u));
+
+            if (0 == difference) {
+                if (dequeue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask + 1u, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// \returns `true` when the queue looks empty at the moment of the call. The result is only a hint when other
+    /// threads are using the queue concurrently.
+    bool empty() const
+    {
+        auto const position = dequeue_position.load(std::memory_order_acquire);
+        auto const sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+        return sequence != position + 1u;
+    }
+
+    /// \returns The maximum number of values the queue can hold.
+    std::size_t capacity() const noexcept
+    {
+        return mask + 1u;
+    }
+
+  private:
+    /// Holds the size of a cache line, which is used to keep the positions from false sharing.
+    static constexpr std::size_t CacheLineSize = 64u;
+
+    /// A slot of the ring.
+    struct Cell {
+        std::atomic<std::size_t> sequence{0u};
+        T value;
+    };
+
+    /// Holds the ring of cells.
+    std::unique_ptr<Cell[]> cells;
+
+    /// Holds `capacity() - 1`, which is used to map positions to cells.
+    std::size_t mask = 0u;
+
+    /// Holds the position of the next cell to be written to.
+    alignas(CacheLineSize) std::atomic<std::size_t> enqueue_position{0u};
+
+    /// Holds the position of the next cell to be read from.
+    alignas(CacheLineSize) std::atomic<std::size_t> dequeue_position{0u};
+};
+
+} // namespace v1
+} // namespace nest
@@ -10,3 +10,16 @@
 #ifndef NEST_RENDERER
 #define NEST_RENDERER NEST_RENDERER_OPENGL
 #endif
+
+// Make OpenGL state cache check itself against the actual OpenGL state. This stalls the pipeline, so it's meant for
+// debugging only.
+#ifndef NEST_VALIDATE_OPENGL_STATE
+#define NEST_VALIDATE_OPENGL_STATE 0
+#endif
+
+// Make headless OpenGL contexts available, see `OpenGL::Builder::with_headless`. They are created through EGL, which
+// Mesa provides on Linux even without a display or a GPU. It's off by default, since it makes EGL a dependency of the
+// build: define it to 1, and link with -lEGL, to use them.
+#ifndef NEST_OPENGL_HEADLESS
+#define NEST_OPENGL_HEADLESS 0
+#endif
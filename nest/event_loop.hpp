@@ -7,6 +7,9 @@
 
 #include <SDL2/SDL.h>
 
+#include <nest/fixed_timestep.hpp>
+#include <nest/frame_pacer.hpp>
+
 namespace nest {
 inline namespace v1 {
 
@@ -22,6 +25,28 @@ class EventLoop {
     /// delegate is not called unless something is bound to it.
     std::function<void(float const time_step)> on_tick;
 
+    /// If this delegate is bound, then the loop runs in fixed-timestep mode: the delegate gets called with a constant
+    /// `time_step` of `fixed_time_step` seconds as many times per frame as it takes to catch up with real time, but no
+    /// more than `max_fixed_updates` times. Simulation results then don't depend on the frame rate.
+    std::function<void(float const time_step)> on_fixed_update;
+
+    /// Gets called once per frame, after `on_fixed_update`. Takes `alpha` in the [0, 1) range, which tells how far real
+    /// time is between the last two fixed updates: render `mix(previous_state, current_state, alpha)`. When
+    /// `on_fixed_update` is not bound, `alpha` is always 1. This delegate is not called unless something is bound to it.
+    std::function<void(float const alpha)> on_render;
+
+    /// Holds the time step of `on_fixed_update` in seconds. A step, which is not positive or is shorter than a tick of
+    /// the clock, is rejected: `on_fixed_update` is not called, and `alpha` is 1. See `FixedTimestep`.
+    float fixed_time_step = 1.f / 60.f;
+
+    /// Holds the maximum number of `on_fixed_update` calls per frame. When a frame takes longer than that many steps,
+    /// the rest of the backlog is dropped instead of being caught up with in the following frames, which would only
+    /// make them slower.
+    unsigned max_fixed_updates = 5u;
+
+    /// Paces the loop, 60 frames per second by default. Set the rate to zero when the loop is paced by vsync.
+    FramePacer pacer{60.0};
+
     /// Runs event loop. The loop will terminate when:
     ///     - `EventLoop::on_quit` is not bound and the user closes the window;
     ///     - `EventLoop::quit()`  is called.
@@ -31,11 +56,10 @@ class EventLoop {
 
         running.store(true);
 
-        // Holds the desired duration of a single frame.
-        auto desired_duration = high_resolution_clock::duration(std::chrono::nanoseconds(1'000'000'000 / 60));
+        pacer.reset();
 
-        // Holds a zero-length duration.
-        auto const zero_duration = high_resolution_clock::duration::zero();
+        // Holds the real time, which hasn't been simulated by `on_fixed_update` yet.
+        FixedTimestep timestep;
 
         auto then = high_resolution_clock::now();
 
@@ -53,10 +77,18 @@ class EventLoop {
                 on_tick(time_step);
             }
 
-            if (auto const mod = frame_duration % desired_duration; zero_duration == mod) {
-                std::this_thread::sleep_for(mod);
+            auto alpha = 1.f;
+
+            if (on_fixed_update) {
+                alpha = timestep.advance(frame_duration, fixed_time_step, max_fixed_updates, on_fixed_update);
             }
 
+            if (on_render) {
+                on_render(alpha);
+            }
+
+            pacer.wait();
+
             then = now;
         }
     }
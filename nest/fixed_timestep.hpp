@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for running a simulation at a fixed time step, so that its results don't depend on the frame rate.
+///
+/// Real time is accumulated frame by frame, and spent in steps of the fixed duration. The time left over, which is
+/// shorter than a step, tells how far real time is between the last two steps, so rendering can interpolate between
+/// them.
+class FixedTimestep final {
+  public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    /// Forgets the accumulated time.
+    void reset() noexcept
+    {
+        accumulator = Clock::duration::zero();
+    }
+
+    /// Accumulates the given `frame_duration`, and calls `update` with the given `time_step` in seconds as many times
+    /// as it takes to catch up with real time, but no more than `max_updates` times. The rest of the backlog is dropped
+    /// instead of being caught up with in the following frames, which would only make them slower.
+    ///
+    /// A `time_step`, which is not positive or is shorter than a tick of the clock, is rejected: `update` is not
+    /// called.
+    /// \returns The interpolation factor in the [0, 1) range, or 1 if the `time_step` is rejected.
+    template <typename F>
+    float advance(Clock::duration const frame_duration, float const time_step, unsigned const max_updates, F&& update)
+    {
+        if (!(time_step > 0.f)) {
+            // TODO: report the error.
+            return 1.f;
+        }
+
+        auto const step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(time_step));
+        if (step <= Clock::duration::zero()) {
+            // TODO: report the error.
+            return 1.f;
+        }
+
+        accumulator += frame_duration;
+
+        for (auto i = 0u; accumulator >= step && i < max_updates; ++i) {
+            update(time_step);
+            accumulator -= step;
+        }
+
+        if (accumulator >= step) {
+            accumulator %= step;
+        }
+
+        return static_cast<float>(accumulator.count()) / static_cast<float>(step.count());
+    }
+
+  private:
+    /// Holds the real time, which hasn't been simulated yet.
+    Clock::duration accumulator = Clock::duration::zero();
+};
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for pacing a loop at a target frame rate.
+///
+/// Waiting for a frame deadline is done in two phases: the thread sleeps until the deadline is closer than the spin
+/// threshold, then it yields until the deadline. Sleeping keeps the CPU usage low, while the short spin hides the
+/// coarse granularity of OS timers. In the unlimited mode the pacer never waits, which is what you want when the loop
+/// is paced by something else, e.g. by vsync in `swap_buffers`.
+class FramePacer final {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Holds statistics of the paced frames.
+    struct Statistics {
+        /// Holds the number of frames paced so far.
+        std::size_t frame_count = 0u;
+
+        /// Holds the number of frames, which were finished after their deadline.
+        std::size_t missed_deadline_count = 0u;
+
+        /// Holds the average distance between a deadline and the moment the pacer returned control.
+        std::chrono::nanoseconds average_jitter{};
+
+        /// Holds the largest distance between a deadline and the moment the pacer returned control.
+        std::chrono::nanoseconds max_jitter{};
+    };
+
+    /// Holds the default duration of the spinning phase of a wait.
+    static constexpr std::chrono::microseconds DefaultSpinThreshold{1'000};
+
+    /// Constructs a pacer with the given target `rate` in frames per second. A `rate` of zero means unlimited.
+    explicit FramePacer(double const rate = 60.0)
+    {
+        set_rate(rate);
+    }
+
+    FramePacer(FramePacer const&) = delete;
+    FramePacer& operator=(FramePacer const&) = delete;
+
+    /// Sets the target `rate` in frames per second. A `rate` of zero means unlimited. May be called from any thread.
+    void set_rate(double const rate)
+    {
+        auto const period = rate > 0.0 ? static_cast<std::int64_t>(1'000'000'000.0 / rate) : 0;
+        period_ns.store(period);
+    }
+
+    /// \returns The target rate in frames per second, or zero if the rate is unlimited.
+    double get_rate() const
+    {
+        auto const period = period_ns.load();
+        return period ? 1'000'000'000.0 / period : 0.0;
+    }
+
+    /// Sets how long before a deadline the pacer stops sleeping and starts spinning. Larger values trade CPU time for
+    /// accuracy on systems with coarse timers. May be called from any thread.
+    void set_spin_threshold(std::chrono::nanoseconds const threshold)
+    {
+        spin_threshold_ns.store(std::max<std::int64_t>(threshold.count(), 0));
+    }
+
+    /// Blocks the calling thread until the deadline of the current frame, and schedules the next one. A frame that
+    /// overran its deadline is counted as missed, and the schedule restarts from now instead of trying to catch up.
+    void wait()
+    {
+        auto const period = std::chrono::nanoseconds(period_ns.load());
+        auto now = Clock::now();
+
+        frame_count.fetch_add(1u, std::memory_order_relaxed);
+
+        if (period == period.zero()) {
+            deadline = now;
+            scheduled = false;
+            return;
+        }
+
+        if (!scheduled) {
+            // Paces from the first call on, there's nothing to wait for yet.
+            deadline = now + period;
+            scheduled = true;
+            return;
+        }
+
+        if (now > deadline) {
+            missed_deadline_count.fetch_add(1u, std::memory_order_relaxed);
+            deadline = now + period;
+            return;
+        }
+
+        auto const spin_threshold = std::chrono::nanoseconds(spin_threshold_ns.load());
+        if (deadline - now > spin_threshold) {
+            std::this_thread::sleep_for(deadline - now - spin_threshold);
+        }
+
+        while ((now = Clock::now()) < deadline) {
+            std::this_thread::yield();
+        }
+
+        auto const jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count();
+        jitter_sum_ns.fetch_add(jitter, std::memory_order_relaxed);
+        jitter_count.fetch_add(1u, std::memory_order_relaxed);
+        if (jitter > max_jitter_ns.load(std::memory_order_relaxed)) {
+            max_jitter_ns.store(jitter, std::memory_order_relaxed);
+        }
+
+        deadline += period;
+    }
+
+    /// Forgets the schedule, so the next `wait()` starts a new one. Call this after the loop has been idle on purpose,
+    /// otherwise the idle time is counted as a missed deadline.
+    void reset()
+    {
+        scheduled = false;
+    }
+
+    /// \returns The statistics of the paced frames. May be called from any thread.
+    Statistics get_statistics() const
+    {
+        Statistics statistics;
+        statistics.frame_count = frame_count.load(std::memory_order_relaxed);
+        statistics.missed_deadline_count = missed_deadline_count.load(std::memory_order_relaxed);
+        if (auto const count = static_cast<std::int64_t>(jitter_count.load(std::memory_order_relaxed)); count) {
+            statistics.average_jitter = std::chrono::nanoseconds(jitter_sum_ns.load(std::memory_order_relaxed) / count);
+        }
+        statistics.max_jitter = std::chrono::nanoseconds(max_jitter_ns.load(std::memory_order_relaxed));
+        return statistics;
+    }
+
+    /// Resets the statistics. May be called from any thread.
+    void reset_statistics()
+    {
+        frame_count.store(0u, std::memory_order_relaxed);
+        missed_deadline_count.store(0u, std::memory_order_relaxed);
+        jitter_sum_ns.store(0, std::memory_order_relaxed);
+        jitter_count.store(0u, std::memory_order_relaxed);
+        max_jitter_ns.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+    /// Holds the duration of a frame in nanoseconds, or zero if the rate is unlimited.
+    std::atomic<std::int64_t> period_ns{0};
+
+    /// Holds the duration of the spinning phase of a wait in nanoseconds.
+    std::atomic<std::int64_t> spin_threshold_ns{std::chrono::nanoseconds(DefaultSpinThreshold).count()};
+
+    /// Holds the deadline of the current frame.
+    Clock::time_point deadline;
+
+    /// Holds a boolean which specifies whether `deadline` is valid.
+    bool scheduled = false;
+
+    // clang-format off
+    /// Hold the statistics.
+    /// @{
+    std::atomic<std::size_t>  frame_count{0u};
+    std::atomic<std::size_t>  missed_deadline_count{0u};
+    std::atomic<std::int64_t> jitter_sum_ns{0};
+    std::atomic<std::size_t>  jitter_count{0u};
+    std::atomic<std::int64_t> max_jitter_ns{0};
+    /// @}
+    // clang-format on
+};
+
+} // namespace v1
+} // namespace nest
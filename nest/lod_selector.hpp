@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for picking the level of detail of an object from its projected size on the screen.
+///
+/// Every level has an error relative to the radius of the object bounds, e.g. the one of `MeshLod`. The selector picks
+/// the coarsest level, whose error projects to no more than the given number of pixels. The error of `MeshLod` is an
+/// estimate rather than a bound, so leave a margin in the number of pixels. An object close to a switch distance would
+/// flicker between two levels, so switching to a coarser level takes the projected error to be lower by the given
+/// `hysteresis` fraction.
+class LodSelector final {
+  public:
+    /// Constructs a selector of a single level.
+    LodSelector() : LodSelector(std::vector<float>{0.f})
+    {
+    }
+
+    /// Constructs a selector of the levels of the given relative `errors`, the most detailed level first, which keeps
+    /// their projected errors within the given number of pixels.
+    explicit LodSelector(std::vector<float> errors, float const pixel_error = 1.f, float const hysteresis = 0.25f)
+        : errors(std::move(errors)), pixel_error(pixel_error), hysteresis(hysteresis)
+    {
+    }
+
+    /// \returns The diameter in pixels of a sphere of the given `radius` at the given `distance` from the eye, which is
+    /// projected by a perspective projection of the given vertical field of view `fov_y` in radians onto a viewport of
+    /// the given `viewport_height` in pixels.
+    static float get_screen_size(float const radius, float const distance, float const fov_y,
+                                 float const viewport_height)
+    {
+        if (distance <= radius) {
+            return viewport_height;
+        }
+        return viewport_height * radius / (distance * std::tan(0.5f * fov_y));
+    }
+
+    /// Picks the level for an object of the given projected `screen_size` in pixels, e.g. from `get_screen_size`.
+    /// \returns The index of the picked level.
+    std::size_t select(float const screen_size)
+    {
+        auto const radius = 0.5f * screen_size;
+
+        // Refines while the current level is too coarse.
+        while (level > 0u && errors[level] * radius > pixel_error) {
+            --level;
+        }
+
+        // Coarsens while the next level is well within the limit.
+        while (level + 1u < errors.size() && errors[level + 1u] * radius <= pixel_error * (1.f - hysteresis)) {
+            ++level;
+        }
+
+        return level;
+    }
+
+    /// \returns The index of the level picked by the last `select` call.
+    std::size_t get_level() const
+    {
+        return level;
+    }
+
+    /// \returns The number of levels.
+    std::size_t get_level_count() const
+    {
+        return errors.size();
+    }
+
+  private:
+    /// Holds the errors of the levels relative to the radius of the object bounds.
+    std::vector<float> errors;
+
+    /// Holds the largest projected error in pixels.
+    float pixel_error = 1.f;
+
+    /// Holds the fraction, which the projected error of a coarser level must be lower by before switching to it.
+    float hysteresis = 0.25f;
+
+    /// Holds the index of the current level.
+    std::size_t level = 0u;
+};
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for mapping a file into memory for reading.
+///
+/// The pages of the file are read by the OS on first access, and are shared with the page cache, so reading a mapped
+/// file takes no copies, unlike reading it into a buffer.
+class MappedFile final {
+  public:
+    /// Constructs an empty `MappedFile`.
+    MappedFile() noexcept = default;
+
+    /// Maps the file at the given `path`. The `MappedFile` is empty if the file can't be mapped, or if it's empty.
+    explicit MappedFile(char const* const path)
+    {
+#if defined(_WIN32)
+        auto const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (INVALID_HANDLE_VALUE == file) {
+            // TODO: report the error.
+            return;
+        }
+
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+            if (auto const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                data = static_cast<std::byte const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                size = data ? static_cast<std::size_t>(file_size.QuadPart) : 0u;
+
+                // The view keeps the mapping alive.
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        auto const file = open(path, O_RDONLY);
+        if (-1 == file) {
+            // TODO: report the error.
+            return;
+        }
+
+        struct stat status;
+        if (0 == fstat(file, &status) && status.st_size > 0) {
+            auto const length = static_cast<std::size_t>(status.st_size);
+            auto const address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            if (MAP_FAILED != address) {
+                data = static_cast<std::byte const*>(address);
+                size = length;
+                madvise(address, length, MADV_WILLNEED);
+            }
+        }
+
+        // The mapping keeps the file alive.
+        close(file);
+#endif
+        if (!data) {
+            // TODO: report the error.
+        }
+    }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile(MappedFile&& that) noexcept
+    {
+        swap(that);
+    }
+
+    ~MappedFile() noexcept
+    {
+        if (!data) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<std::byte*>(data), size);
+#endif
+    }
+
+    MappedFile& operator=(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile&& that) noexcept
+    {
+        swap(that);
+        return *this;
+    }
+
+    void swap(MappedFile& that) noexcept
+    {
+        std::swap(data, that.data);
+        std::swap(size, that.size);
+    }
+
+    /// \returns `true` when this `MappedFile` is not empty, `false` otherwise.
+    explicit operator bool() const
+    {
+        return nullptr != data;
+    }
+
+    /// \returns A pointer to the first byte of the file.
+    std::byte const* get_data() const
+    {
+        return data;
+    }
+
+    /// \returns The size of the file in bytes.
+    std::size_t get_size() const
+    {
+        return size;
+    }
+
+  private:
+    /// Holds the address the file is mapped at.
+    std::byte const* data = nullptr;
+
+    /// Holds the size of the file in bytes.
+    std::size_t size = 0u;
+};
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nest/mapped_file.hpp>
+#include <nest/mesh_simplifier.hpp>
+#include <nest/packed_types.hpp>
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Enumerates the types of the components of vertex attributes stored in a mesh file.
+enum class ComponentType : std::uint8_t {
+    Float,
+    Half,
+    Byte,
+    UnsignedByte,
+    Short,
+    UnsignedShort,
+    Int,
+    UnsignedInt,
+    Fixed,
+    Int2101010
+};
+
+namespace detail {
+
+/// The type of the elements of the given vector type `T`, e.g. of an array or of a `glm::vec3`.
+template <typename T>
+using Element = std::remove_cv_t<std::remove_reference_t<decltype(std::declval<T&>()[0])>>;
+
+} // namespace detail
+
+/// Holds a `ComponentType` that corresponds to the given type `T`. Vectors take the type of their elements.
+///@{
+// clang-format off
+template <typename T, typename = void> static constexpr ComponentType component_type;
+
+template <typename T> constexpr ComponentType component_type<T, std::void_t<detail::Element<T>>> =
+    component_type<detail::Element<T>>;
+
+template <> constexpr ComponentType component_type<float>         = ComponentType::Float;
+template <> constexpr ComponentType component_type<Half>          = ComponentType::Half;
+template <> constexpr ComponentType component_type<std::int8_t>   = ComponentType::Byte;
+template <> constexpr ComponentType component_type<Snorm8>        = ComponentType::Byte;
+template <> constexpr ComponentType component_type<std::uint8_t>  = ComponentType::UnsignedByte;
+template <> constexpr ComponentType component_type<Unorm8>        = ComponentType::UnsignedByte;
+template <> constexpr ComponentType component_type<std::int16_t>  = ComponentType::Short;
+template <> constexpr ComponentType component_type<Snorm16>       = ComponentType::Short;
+template <> constexpr ComponentType component_type<std::uint16_t> = ComponentType::UnsignedShort;
+template <> constexpr ComponentType component_type<Unorm16>       = ComponentType::UnsignedShort;
+template <> constexpr ComponentType component_type<std::int32_t>  = ComponentType::Int;
+template <> constexpr ComponentType component_type<std::uint32_t> = ComponentType::UnsignedInt;
+template <> constexpr ComponentType component_type<Fixed>         = ComponentType::Fixed;
+template <> constexpr ComponentType component_type<Snorm2101010>  = ComponentType::Int2101010;
+// clang-format on
+///@}
+
+/// Enumerates the vertex attributes stored in a mesh file.
+enum class AttributeSemantic : std::uint8_t { Position, Color, Texcoord };
+
+/// Describes a vertex attribute stored in a mesh file.
+struct MeshFileAttribute {
+    AttributeSemantic semantic;
+    ComponentType type;
+    std::uint8_t component_count;
+    std::uint8_t normalized;
+
+    /// Holds the offset of the attribute within a vertex.
+    std::uint32_t offset;
+};
+
+/// Describes a section of a mesh file.
+struct MeshFileSection {
+    /// Holds the offset of the section from the beginning of the file, which is a multiple of `SectionAlignment`.
+    std::uint64_t offset;
+
+    /// Holds the size of the section in bytes.
+    std::uint64_t size;
+};
+
+/// Describes a level of detail stored in a mesh file.
+struct MeshFileLod {
+    std::uint64_t first_index;
+    std::uint64_t index_count;
+    float error;
+    std::uint32_t reserved;
+};
+
+/// The header, which a mesh file begins with. It's followed by the sections of vertices, of indices and of levels of
+/// detail, each aligned to `SectionAlignment` bytes, so that they can be used straight from a mapped file. All the
+/// numbers are stored in the byte order of the host, which is little-endian on every platform we target.
+struct MeshFileHeader {
+    static constexpr char Magic[8] = {'N', 'E', 'S', 'T', 'M', 'E', 'S', 'H'};
+    static constexpr std::uint32_t Version = 1u;
+    static constexpr std::size_t MaxAttributeCount = 8u;
+    static constexpr std::size_t SectionAlignment = 64u;
+
+    char magic[8];
+    std::uint32_t version;
+
+    /// Describe the vertices.
+    /// @{
+    std::uint32_t vertex_stride;
+    std::uint32_t attribute_count;
+    MeshFileAttribute attributes[MaxAttributeCount];
+    /// @}
+
+    /// Holds the size of an index in bytes: 2 or 4.
+    std::uint32_t index_size;
+
+    /// Hold the numbers of vertices, indices, and levels of detail.
+    /// @{
+    std::uint64_t vertex_count;
+    std::uint64_t index_count;
+    std::uint64_t lod_count;
+    /// @}
+
+    /// Describe the sections of vertices, of indices, and of levels of detail.
+    /// @{
+    MeshFileSection vertices;
+    MeshFileSection indices;
+    MeshFileSection lods;
+    /// @}
+};
+
+namespace detail {
+
+/// Adds an attribute of the given type `T` to the given mesh file `header`.
+template <typename T>
+void add_attribute(MeshFileHeader& header, AttributeSemantic const semantic, std::size_t const offset)
+{
+    auto& attribute = header.attributes[header.attribute_count++];
+    attribute.semantic = semantic;
+    attribute.type = component_type<T>;
+    attribute.component_count = static_cast<std::uint8_t>(component_count<T>);
+    attribute.normalized = is_normalized<T> ? 1u : 0u;
+    attribute.offset = static_cast<std::uint32_t>(offset);
+}
+
+/// \returns The size in bytes of the given `attribute` of a mesh file, or 0 if it has an unknown semantic or type, or
+/// a number of components its type can't have.
+inline std::size_t get_attribute_size(MeshFileAttribute const& attribute)
+{
+    if (attribute.semantic > AttributeSemantic::Texcoord || attribute.component_count < 1u ||
+        attribute.component_count > 4u || attribute.normalized > 1u) {
+        return 0u;
+    }
+
+    switch (attribute.type) {
+    case ComponentType::Byte:
+    case ComponentType::UnsignedByte:
+        return attribute.component_count;
+    case ComponentType::Half:
+    case ComponentType::Short:
+    case ComponentType::UnsignedShort:
+        return 2u * attribute.component_count;
+    case ComponentType::Float:
+    case ComponentType::Int:
+    case ComponentType::UnsignedInt:
+    case ComponentType::Fixed:
+        return 4u * attribute.component_count;
+    case ComponentType::Int2101010:
+        // All 4 components are packed into 32 bits.
+        return 4u == attribute.component_count ? 4u : 0u;
+    }
+    return 0u;
+}
+
+/// \returns The given `offset` rounded up to the alignment of the sections of a mesh file.
+inline std::uint64_t align_section(std::uint64_t const offset)
+{
+    constexpr auto alignment = MeshFileHeader::SectionAlignment;
+    return (offset + alignment - 1u) / alignment * alignment;
+}
+
+} // namespace detail
+
+/// Writes the given `vertices`, `indices`, and levels of detail `lods` into a mesh file at the given `path`. The
+/// attributes of the vertices are found by their names. Indices are narrowed to 16 bits when there are few enough
+/// vertices.
+/// \returns `true` on success, `false` otherwise.
+template <typename Vertex>
+bool write_mesh_file(char const* const path, std::vector<Vertex> const& vertices,
+                     std::vector<std::uint32_t> const& indices, std::vector<MeshLod> const& lods = {})
+{
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MeshFileHeader::Magic, sizeof(header.magic));
+    header.version = MeshFileHeader::Version;
+    header.vertex_stride = static_cast<std::uint32_t>(sizeof(Vertex));
+
+    if constexpr (has_position<Vertex>) {
+        detail::add_attribute<decltype(Vertex::position)>(header, AttributeSemantic::Position,
+                                                          offsetof(Vertex, position));
+    }
+    if constexpr (has_color<Vertex>) {
+        detail::add_attribute<decltype(Vertex::color)>(header, AttributeSemantic::Color, offsetof(Vertex, color));
+    }
+    if constexpr (has_texcoord<Vertex>) {
+        detail::add_attribute<decltype(Vertex::texcoord)>(header, AttributeSemantic::Texcoord,
+                                                          offsetof(Vertex, texcoord));
+    }
+
+    auto const narrow = vertices.size() <= 65536u;
+    header.index_size = narrow ? 2u : 4u;
+    header.vertex_count = vertices.size();
+    header.index_count = indices.size();
+    header.lod_count = lods.size();
+
+    header.vertices = {detail::align_section(sizeof(MeshFileHeader)), vertices.size() * sizeof(Vertex)};
+    header.indices = {detail::align_section(header.vertices.offset + header.vertices.size),
+                      indices.size() * header.index_size};
+    header.lods = {detail::align_section(header.indices.offset + header.indices.size),
+                   lods.size() * sizeof(MeshFileLod)};
+
+    std::ofstream file(path, std::ios::binary);
+    auto const write = [&file](std::uint64_t const offset, void const* const data, std::size_t const size) {
+        // Pads the previous section with zeros.
+        std::vector<char> const padding(static_cast<std::size_t>(offset) - static_cast<std::size_t>(file.tellp()));
+        file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+    };
+
+    write(0u, &header, sizeof(header));
+    write(header.vertices.offset, vertices.data(), header.vertices.size);
+    if (narrow) {
+        std::vector<std::uint16_t> const narrow_indices(indices.begin(), indices.end());
+        write(header.indices.offset, narrow_indices.data(), header.indices.size);
+    }
+    else {
+        write(header.indices.offset, indices.data(), header.indices.size);
+    }
+
+    std::vector<MeshFileLod> file_lods;
+    for (auto const& lod : lods) {
+        file_lods.push_back({lod.first_index, lod.index_count, lod.error, 0u});
+    }
+    write(header.lods.offset, file_lods.data(), header.lods.size);
+
+    return static_cast<bool>(file);
+}
+
+/// A class for reading a mesh file written by `write_mesh_file`.
+///
+/// The file is mapped into memory rather than read, so its vertices and indices can be uploaded to the GPU straight
+/// from the mapped pages, with no copies made on the way.
+class MeshFile final {
+  public:
+    /// Constructs an empty `MeshFile`.
+    MeshFile() noexcept = default;
+
+    /// Maps the mesh file at the given `path`. The `MeshFile` is empty if the file can't be mapped, or is not a valid
+    /// mesh file of the supported version.
+    explicit MeshFile(char const* const path) : file(path)
+    {
+        if (file && !is_valid()) {
+            // TODO: report the error.
+            file = MappedFile{};
+        }
+    }
+
+    MeshFile(MeshFile const&) = delete;
+    MeshFile(MeshFile&& that) noexcept
+    {
+        swap(that);
+    }
+
+    MeshFile& operator=(MeshFile const&) = delete;
+    MeshFile& operator=(MeshFile&& that) noexcept
+    {
+        swap(that);
+        return *this;
+    }
+
+    void swap(MeshFile& that) noexcept
+    {
+        file.swap(that.file);
+    }
+
+    /// \returns `true` when this `MeshFile` is not empty, `false` otherwise.
+    explicit operator bool() const
+    {
+        return static_cast<bool>(file);
+    }
+
+    /// \returns The header of the mesh file, which describes its vertices, indices, and levels of detail.
+    MeshFileHeader const& get_header() const
+    {
+        return *reinterpret_cast<MeshFileHeader const*>(file.get_data());
+    }
+
+    /// \returns A pointer to the first vertex.
+    std::byte const* get_vertex_data() const
+    {
+        return file.get_data() + get_header().vertices.offset;
+    }
+
+    /// \returns A pointer to the first index.
+    std::byte const* get_index_data() const
+    {
+        return file.get_data() + get_header().indices.offset;
+    }
+
+    /// \returns The levels of detail, or none if the mesh has a single level.
+    std::vector<MeshLod> get_lods() const
+    {
+        auto const& header = get_header();
+        auto const lods = reinterpret_cast<MeshFileLod const*>(file.get_data() + header.lods.offset);
+
+        std::vector<MeshLod> result;
+        for (std::size_t i = 0u; i < header.lod_count; ++i) {
+            result.push_back({static_cast<std::size_t>(lods[i].first_index),
+                              static_cast<std::size_t>(lods[i].index_count), lods[i].error});
+        }
+        return result;
+    }
+
+  private:
+    /// \returns `true` when the mapped file is a valid mesh file of the supported version, `false` otherwise. Every
+    /// attribute has to fit in a vertex, and every index has to refer to a vertex, since a draw call would read out of
+    /// bounds otherwise.
+    bool is_valid() const
+    {
+        if (file.get_size() < sizeof(MeshFileHeader)) {
+            return false;
+        }
+
+        auto const& header = get_header();
+        if (0 != std::memcmp(header.magic, MeshFileHeader::Magic, sizeof(header.magic)) ||
+            MeshFileHeader::Version != header.version || header.attribute_count > MeshFileHeader::MaxAttributeCount ||
+            (2u != header.index_size && 4u != header.index_size)) {
+            return false;
+        }
+
+        for (std::size_t i = 0u; i < header.attribute_count; ++i) {
+            auto const& attribute = header.attributes[i];
+            auto const size = detail::get_attribute_size(attribute);
+            if (0u == size || attribute.offset > header.vertex_stride ||
+                size > header.vertex_stride - attribute.offset) {
+                return false;
+            }
+        }
+
+        // The counts are checked against the size of the file before they are multiplied, so that a crafted count
+        // can't wrap the size of its section around.
+        auto const fits = [this](MeshFileSection const& section, std::uint64_t const count, std::uint64_t const size) {
+            return (0u == size || count <= file.get_size() / size) && section.size == count * size &&
+                   0u == section.offset % MeshFileHeader::SectionAlignment && section.offset <= file.get_size() &&
+                   section.size <= file.get_size() - section.offset;
+        };
+        if (!fits(header.vertices, header.vertex_count, header.vertex_stride) ||
+            !fits(header.indices, header.index_count, header.index_size) ||
+            !fits(header.lods, header.lod_count, sizeof(MeshFileLod))) {
+            return false;
+        }
+
+        for (auto const& lod : get_lods()) {
+            if (lod.first_index > header.index_count || lod.index_count > header.index_count - lod.first_index) {
+                return false;
+            }
+        }
+
+        auto const refer_to_vertices = [&header](auto const* const indices) {
+            for (std::uint64_t i = 0u; i < header.index_count; ++i) {
+                if (indices[i] >= header.vertex_count) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        return 2u == header.index_size ? refer_to_vertices(reinterpret_cast<std::uint16_t const*>(get_index_data()))
+                                       : refer_to_vertices(reinterpret_cast<std::uint32_t const*>(get_index_data()));
+    }
+
+    /// Holds the mapped file.
+    MappedFile file;
+};
+
+} // namespace v1
+} // namespace nest
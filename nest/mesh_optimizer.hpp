@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Holds the statistics of a simulated post-transform vertex cache.
+struct VertexCacheStatistics {
+    /// Holds the average cache miss ratio: the number of transformed vertices per triangle. It ranges from 0.5 for an
+    /// ideal regular grid to 3.
+    float acmr = 0.f;
+
+    /// Holds the average transform to vertex ratio: the number of transformed vertices per referenced vertex. It
+    /// ranges from 1, which is ideal, to 6.
+    float atvr = 0.f;
+};
+
+/// Holds the options of `optimize_mesh`.
+struct MeshOptimization {
+    /// Holds a boolean value which specifies whether triangles are reordered for the post-transform vertex cache.
+    bool vertex_cache = true;
+
+    /// Holds a boolean value which specifies whether clusters of triangles are reordered to reduce overdraw. It only
+    /// applies to vertices with a `position`.
+    bool overdraw = true;
+
+    /// Holds a boolean value which specifies whether vertices are reordered in the order they are fetched. Vertices,
+    /// which aren't referenced by indices, are dropped.
+    bool vertex_fetch = true;
+
+    /// Holds a boolean value which specifies whether indices may be narrowed to 16 bits, when there are few enough
+    /// vertices.
+    bool narrow_indices = true;
+
+    /// Holds the number of vertices the simulated cache holds.
+    std::size_t cache_size = 32u;
+
+    /// Holds how much worse the cache miss ratio may get for the sake of reducing overdraw, e.g. 1.05 for 5%.
+    float overdraw_threshold = 1.05f;
+};
+
+/// Holds the report of `optimize_mesh`.
+struct MeshOptimizationReport {
+    /// Hold the vertex cache statistics before and after the optimization.
+    /// @{
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+    /// @}
+
+    /// Holds the size in bytes of an index, which the optimized indices can be narrowed to.
+    std::size_t index_size = sizeof(std::uint32_t);
+};
+
+/// Simulates a FIFO post-transform vertex cache of the given `cache_size`, which draws the triangles of the given
+/// `indices` referencing `vertex_count` vertices.
+/// \returns The statistics of the cache.
+inline VertexCacheStatistics analyze_vertex_cache(std::vector<std::uint32_t> const& indices,
+                                                  std::size_t const vertex_count, std::size_t const cache_size = 32u)
+{
+    // A vertex is cached when less than `cache_size` vertices were transformed after it.
+    constexpr auto never = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> transformed_at(vertex_count, never);
+
+    std::size_t num_transformed = 0u;
+    std::size_t num_referenced = 0u;
+    for (auto const index : indices) {
+        auto& time = transformed_at[index];
+        num_referenced += never == time ? 1u : 0u;
+        if (never == time || num_transformed - time >= cache_size) {
+            time = num_transformed++;
+        }
+    }
+
+    VertexCacheStatistics statistics;
+    if (auto const num_triangles = indices.size() / 3u) {
+        statistics.acmr = static_cast<float>(num_transformed) / num_triangles;
+        statistics.atvr = static_cast<float>(num_transformed) / num_referenced;
+    }
+    return statistics;
+}
+
+namespace detail {
+
+/// \returns The score of a vertex at the given `cache_position` of an LRU cache of the given `cache_size`, which is
+/// used by the given number of triangles not drawn yet, as proposed by Tom Forsyth in "Linear-Speed Vertex Cache
+/// Optimisation".
+inline float forsyth_score(int const cache_position, std::size_t const cache_size, std::uint32_t const num_live)
+{
+    if (!num_live) {
+        return -1.f;
+    }
+
+    auto score = 0.f;
+    if (cache_position < 0) {
+        // The vertex is not cached.
+    }
+    else if (cache_position < 3) {
+        // The vertex was used by the last triangle, which favors strips over fans.
+        score = 0.75f;
+    }
+    else {
+        auto const scale = 1.f / static_cast<float>(cache_size - 3u);
+        score = std::pow(1.f - static_cast<float>(cache_position - 3) * scale, 1.5f);
+    }
+
+    // Favors vertices with few triangles left, so that lone triangles don't get stranded.
+    return score + 2.f / std::sqrt(static_cast<float>(num_live));
+}
+
+/// \returns The position of the given `vertex` as a 3D vector.
+template <typename Vertex>
+glm::vec3 get_position(Vertex const& vertex)
+{
+    glm::vec3 position(0.f, 0.f, 0.f);
+    for (std::size_t i = 0u; i < std::min<std::size_t>(3u, component_count<decltype(Vertex::position)>); ++i) {
+        position[static_cast<int>(i)] = static_cast<float>(vertex.position[static_cast<int>(i)]);
+    }
+    return position;
+}
+
+} // namespace detail
+
+/// Reorders the triangles of the given `indices`, which reference `vertex_count` vertices, so that their vertices are
+/// more likely to be found in the post-transform vertex cache of the given `cache_size`.
+inline void optimize_vertex_cache(std::vector<std::uint32_t>& indices, std::size_t const vertex_count,
+                                  std::size_t const cache_size = 32u)
+{
+    constexpr auto none = std::numeric_limits<std::size_t>::max();
+    auto const num_triangles = indices.size() / 3u;
+
+    // Lists the triangles not drawn yet per vertex: the first `num_live[vertex]` items starting from
+    // `first_triangle[vertex]` in `adjacency`.
+    std::vector<std::uint32_t> num_live(vertex_count, 0u);
+    for (auto const index : indices) {
+        ++num_live[index];
+    }
+
+    std::vector<std::size_t> first_triangle(vertex_count + 1u, 0u);
+    std::partial_sum(num_live.begin(), num_live.end(), first_triangle.begin() + 1);
+
+    std::vector<std::uint32_t> adjacency(indices.size());
+    {
+        auto next = first_triangle;
+        for (std::size_t i = 0u; i < indices.size(); ++i) {
+            adjacency[next[indices[i]]++] = static_cast<std::uint32_t>(i / 3u);
+        }
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (std::size_t vertex = 0u; vertex < vertex_count; ++vertex) {
+        vertex_score[vertex] = detail::forsyth_score(-1, cache_size, num_live[vertex]);
+    }
+
+    std::vector<float> triangle_score(num_triangles, 0.f);
+    std::vector<bool> drawn(num_triangles, false);
+    for (std::size_t i = 0u; i < indices.size(); ++i) {
+        triangle_score[i / 3u] += vertex_score[indices[i]];
+    }
+
+    std::vector<std::uint32_t> optimized;
+    optimized.reserve(indices.size());
+
+    std::vector<std::uint32_t> cache;
+    std::vector<std::uint32_t> next_cache;
+    cache.reserve(cache_size + 3u);
+    next_cache.reserve(cache_size + 3u);
+
+    auto const first = std::max_element(triangle_score.begin(), triangle_score.end());
+    auto best = num_triangles ? static_cast<std::size_t>(first - triangle_score.begin()) : none;
+    std::size_t cursor = 0u;
+
+    while (none != best) {
+        auto const triangle = &indices[best * 3u];
+        optimized.insert(optimized.end(), triangle, triangle + 3);
+        drawn[best] = true;
+
+        // Moves the drawn triangle past the live triangles of its vertices.
+        for (std::size_t i = 0u; i < 3u; ++i) {
+            auto const vertex = triangle[i];
+            auto const live = adjacency.begin() + static_cast<std::ptrdiff_t>(first_triangle[vertex]);
+            auto const last = live + num_live[vertex] - 1;
+            std::iter_swap(std::find(live, last, static_cast<std::uint32_t>(best)), last);
+            --num_live[vertex];
+        }
+
+        // Puts the vertices of the drawn triangle to the front of the cache.
+        next_cache.assign(triangle, triangle + 3);
+        for (auto const vertex : cache) {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                next_cache.push_back(vertex);
+            }
+        }
+        std::swap(cache, next_cache);
+
+        // Rescores the cached vertices, and the vertices evicted from the cache, along with their triangles.
+        for (std::size_t i = 0u; i < cache.size(); ++i) {
+            auto const vertex = cache[i];
+            cache_position[vertex] = i < cache_size ? static_cast<int>(i) : -1;
+
+            auto const score = detail::forsyth_score(cache_position[vertex], cache_size, num_live[vertex]);
+            auto const delta = score - vertex_score[vertex];
+            vertex_score[vertex] = score;
+
+            auto const live = adjacency.begin() + static_cast<std::ptrdiff_t>(first_triangle[vertex]);
+            for (auto it = live; it != live + num_live[vertex]; ++it) {
+                triangle_score[*it] += delta;
+            }
+        }
+        cache.resize(std::min(cache.size(), cache_size));
+
+        // Picks the best of the triangles of the cached vertices.
+        best = none;
+        auto best_score = -1.f;
+        for (auto const vertex : cache) {
+            auto const live = adjacency.begin() + static_cast<std::ptrdiff_t>(first_triangle[vertex]);
+            for (auto it = live; it != live + num_live[vertex]; ++it) {
+                if (triangle_score[*it] > best_score) {
+                    best_score = triangle_score[*it];
+                    best = *it;
+                }
+            }
+        }
+
+        // Falls back to the next triangle not drawn yet, when the cached vertices have no triangles left.
+        if (none == best) {
+            while (cursor < num_triangles && drawn[cursor]) {
+                ++cursor;
+            }
+            best = cursor < num_triangles ? cursor : none;
+        }
+    }
+
+    indices = std::move(optimized);
+}
+
+/// Reorders clusters of the triangles of the given `indices`, which reference the given `vertices`, so that the
+/// clusters facing outwards get drawn first, and occlude the rest. Call this after `optimize_vertex_cache`, since
+/// the clusters are cut where the cache would be flushed anyway, or where the cache miss ratio gets worse no more than
+/// the given `threshold` times.
+template <typename Vertex>
+void optimize_overdraw(std::vector<std::uint32_t>& indices, std::vector<Vertex> const& vertices,
+                       float const threshold = 1.05f, std::size_t const cache_size = 32u)
+{
+    auto const num_triangles = indices.size() / 3u;
+    if (!num_triangles) {
+        return;
+    }
+
+    auto const acmr = analyze_vertex_cache(indices, vertices.size(), cache_size).acmr;
+
+    // Cuts the triangles into clusters.
+    constexpr auto never = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> transformed_at(vertices.size(), never);
+    std::size_t num_transformed = 0u;
+
+    std::vector<std::size_t> cluster_starts = {0u};
+    std::size_t cluster_misses = 0u;
+    for (std::size_t triangle = 0u; triangle < num_triangles; ++triangle) {
+        std::size_t misses = 0u;
+        for (std::size_t i = 0u; i < 3u; ++i) {
+            auto& time = transformed_at[indices[triangle * 3u + i]];
+            if (never == time || num_transformed - time >= cache_size) {
+                time = num_transformed++;
+                ++misses;
+            }
+        }
+
+        auto const cluster_size = triangle - cluster_starts.back();
+        auto const hard_boundary = 3u == misses;
+        auto const soft_boundary =
+            misses >= 2u && cluster_size && static_cast<float>(cluster_misses) <= threshold * acmr * cluster_size;
+        if (cluster_size && (hard_boundary || soft_boundary)) {
+            cluster_starts.push_back(triangle);
+            cluster_misses = 0u;
+        }
+        cluster_misses += misses;
+    }
+    cluster_starts.push_back(num_triangles);
+
+    // Finds the area-weighted centroid and the average normal of every cluster, and of the whole mesh.
+    auto const num_clusters = cluster_starts.size() - 1u;
+    std::vector<glm::vec3> centroids(num_clusters, glm::vec3(0.f, 0.f, 0.f));
+    std::vector<glm::vec3> normals(num_clusters, glm::vec3(0.f, 0.f, 0.f));
+    auto mesh_centroid = glm::vec3(0.f, 0.f, 0.f);
+    auto mesh_area = 0.f;
+
+    for (std::size_t cluster = 0u; cluster < num_clusters; ++cluster) {
+        auto cluster_area = 0.f;
+        for (auto triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1u]; ++triangle) {
+            auto const a = detail::get_position(vertices[indices[triangle * 3u]]);
+            auto const b = detail::get_position(vertices[indices[triangle * 3u + 1u]]);
+            auto const c = detail::get_position(vertices[indices[triangle * 3u + 2u]]);
+
+            auto const u = b - a;
+            auto const v = c - a;
+            auto const normal = glm::vec3(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x);
+            auto const area = 0.5f * std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+            centroids[cluster] += (a + b + c) * (area / 3.f);
+            normals[cluster] += normal;
+            cluster_area += area;
+        }
+
+        mesh_centroid += centroids[cluster];
+        mesh_area += cluster_area;
+        if (cluster_area > 0.f) {
+            centroids[cluster] = centroids[cluster] * (1.f / cluster_area);
+        }
+    }
+    if (mesh_area > 0.f) {
+        mesh_centroid = mesh_centroid * (1.f / mesh_area);
+    }
+
+    // Sorts the clusters by how far out they face.
+    std::vector<float> keys(num_clusters, 0.f);
+    for (std::size_t cluster = 0u; cluster < num_clusters; ++cluster) {
+        auto const& n = normals[cluster];
+        auto const length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (length > 0.f) {
+            auto const d = centroids[cluster] - mesh_centroid;
+            keys[cluster] = (d.x * n.x + d.y * n.y + d.z * n.z) / length;
+        }
+    }
+
+    std::vector<std::size_t> order(num_clusters);
+    std::iota(order.begin(), order.end(), std::size_t{0u});
+    std::stable_sort(order.begin(), order.end(), [&keys](auto const a, auto const b) { return keys[a] > keys[b]; });
+
+    std::vector<std::uint32_t> optimized;
+    optimized.reserve(indices.size());
+    for (auto const cluster : order) {
+        optimized.insert(optimized.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster_starts[cluster] * 3u),
+                         indices.begin() + static_cast<std::ptrdiff_t>(cluster_starts[cluster + 1u] * 3u));
+    }
+    indices = std::move(optimized);
+}
+
+/// Reorders the given `vertices` in the order the given `indices` reference them, and remaps the `indices`
+/// accordingly, so that vertices are fetched from memory sequentially. Vertices, which aren't referenced, are dropped.
+template <typename Vertex>
+void optimize_vertex_fetch(std::vector<std::uint32_t>& indices, std::vector<Vertex>& vertices)
+{
+    constexpr auto unmapped = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> remap(vertices.size(), unmapped);
+
+    std::vector<Vertex> optimized;
+    optimized.reserve(vertices.size());
+    for (auto& index : indices) {
+        auto& mapped = remap[index];
+        if (unmapped == mapped) {
+            mapped = static_cast<std::uint32_t>(optimized.size());
+            optimized.push_back(vertices[index]);
+        }
+        index = mapped;
+    }
+    vertices = std::move(optimized);
+}
+
+/// Optimizes the given triangle `vertices` and `indices` in place with the given `options`. It doesn't need an OpenGL
+/// context, so meshes can be optimized offline as well as when they are built. The OpenGL headers are still needed at
+/// compile time, since `nest/vertex_traits.hpp` includes the traits of the renderer.
+/// \returns The report of the optimization, which is empty when the `indices` aren't valid triangles.
+template <typename Vertex>
+MeshOptimizationReport optimize_mesh(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices,
+                                     MeshOptimization const& options = {})
+{
+    MeshOptimizationReport report;
+
+    auto const out_of_range = [&vertices](auto const index) { return index >= vertices.size(); };
+    if (indices.size() % 3u || std::any_of(indices.begin(), indices.end(), out_of_range)) {
+        // TODO: report the error.
+        return report;
+    }
+
+    report.before = analyze_vertex_cache(indices, vertices.size(), options.cache_size);
+
+    if (options.vertex_cache) {
+        optimize_vertex_cache(indices, vertices.size(), options.cache_size);
+    }
+
+    if constexpr (has_position<Vertex>) {
+        if (options.overdraw) {
+            optimize_overdraw(indices, vertices, options.overdraw_threshold, options.cache_size);
+        }
+    }
+
+    if (options.vertex_fetch) {
+        optimize_vertex_fetch(indices, vertices);
+    }
+
+    report.after = analyze_vertex_cache(indices, vertices.size(), options.cache_size);
+
+    if (options.narrow_indices && vertices.size() <= std::size_t{std::numeric_limits<std::uint16_t>::max()} + 1u) {
+        report.index_size = sizeof(std::uint16_t);
+    }
+
+    return report;
+}
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <nest/mesh_optimizer.hpp>
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Holds a level of detail of a mesh: a range of the indices shared by all the levels.
+struct MeshLod {
+    /// Holds the index of the first index of the level.
+    std::size_t first_index = 0u;
+
+    /// Holds the number of indices of the level.
+    std::size_t index_count = 0u;
+
+    /// Holds an estimate of how far the level is from the full-detail mesh, relative to the radius of the mesh bounds,
+    /// so that it can be compared with the projected size of the mesh. It's the sum of the errors of `simplify_mesh`
+    /// over the levels up to this one, which is not a bound on the distance: parts of the level may be farther away.
+    float error = 0.f;
+};
+
+/// Holds the levels of detail of a mesh, which share its vertices.
+struct LodChain {
+    /// Holds the indices of all the levels one after another, the most detailed level first.
+    std::vector<std::uint32_t> indices;
+
+    /// Holds the levels, the most detailed one first.
+    std::vector<MeshLod> levels;
+};
+
+/// Holds the options of `build_lod_chain`.
+struct LodOptions {
+    /// Holds the largest number of levels, including the full-detail one.
+    std::size_t max_level_count = 4u;
+
+    /// Holds the number of triangles of a level relative to the previous one.
+    float reduction = 0.5f;
+
+    /// Holds the largest error of a level, see `MeshLod::error`.
+    float max_error = 0.05f;
+
+    /// Holds the weight of the squared difference of the attributes, e.g. colors and texture coordinates, of collapsed
+    /// vertices relative to their squared distance. It only affects the order of collapses, not their errors.
+    float attribute_weight = 0.1f;
+};
+
+namespace detail {
+
+/// A quadric, which measures the squared distance to a set of planes, weighted by their areas.
+struct Quadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+
+    /// Holds the total weight of the planes.
+    double weight = 0.0;
+
+    /// Adds the plane through the given `point` with the given unit `normal`, whose distances are scaled by the given
+    /// `weight`.
+    void add_plane(glm::vec3 const& normal, glm::vec3 const& point, double const weight)
+    {
+        double const a = normal.x, b = normal.y, c = normal.z;
+        double const d = -(a * point.x + b * point.y + c * point.z);
+
+        // clang-format off
+        a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+                              b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+                                                    c2 += weight * c * c; cd += weight * c * d;
+                                                                          d2 += weight * d * d;
+        // clang-format on
+        this->weight += weight;
+    }
+
+    Quadric& operator+=(Quadric const& that)
+    {
+        // clang-format off
+        a2 += that.a2; ab += that.ab; ac += that.ac; ad += that.ad;
+                       b2 += that.b2; bc += that.bc; bd += that.bd;
+                                      c2 += that.c2; cd += that.cd;
+                                                     d2 += that.d2;
+        // clang-format on
+        weight += that.weight;
+        return *this;
+    }
+
+    /// \returns The weighted sum of the squared distances from the given `point` to the planes.
+    double evaluate(glm::vec3 const& point) const
+    {
+        double const x = point.x, y = point.y, z = point.z;
+        auto const error = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x + b2 * y * y +
+                           2.0 * bc * y * z + 2.0 * bd * y + c2 * z * z + 2.0 * cd * z + d2;
+        return std::max(error, 0.0);
+    }
+};
+
+/// \returns The cross product of the given vectors.
+inline glm::vec3 cross(glm::vec3 const& u, glm::vec3 const& v)
+{
+    return glm::vec3(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x);
+}
+
+/// \returns The dot product of the given vectors.
+inline float dot(glm::vec3 const& u, glm::vec3 const& v)
+{
+    return u.x * v.x + u.y * v.y + u.z * v.z;
+}
+
+/// \returns The squared distance between the given attributes.
+template <typename T>
+float component_distance2(T const& a, T const& b)
+{
+    auto distance2 = 0.f;
+    for (std::size_t i = 0u; i < component_count<T>; ++i) {
+        auto const delta = static_cast<float>(a[static_cast<int>(i)]) - static_cast<float>(b[static_cast<int>(i)]);
+        distance2 += delta * delta;
+    }
+    return distance2;
+}
+
+/// \returns The squared distance between the attributes of the given vertices, which are found by their names.
+template <typename Vertex>
+float attribute_distance2(Vertex const& a, Vertex const& b)
+{
+    auto distance2 = 0.f;
+    if constexpr (has_color<Vertex>) {
+        distance2 += component_distance2(a.color, b.color);
+    }
+    if constexpr (has_texcoord<Vertex>) {
+        distance2 += component_distance2(a.texcoord, b.texcoord);
+    }
+    return distance2;
+}
+
+/// \returns A key of the given directed edge.
+inline std::uint64_t edge_key(std::uint32_t const from, std::uint32_t const to)
+{
+    return static_cast<std::uint64_t>(from) << 32u | to;
+}
+
+} // namespace detail
+
+/// Simplifies the triangles of the given `indices`, which reference the given `vertices`, by collapsing their edges
+/// in the order of the quadric error metric, as proposed by Garland and Heckbert in "Surface Simplification Using
+/// Quadric Error Metrics". Vertices are collapsed onto their neighbors rather than moved, so the result references
+/// the same `vertices`, and keeps their attributes. The borders of the mesh are kept in place, and so are the seams,
+/// where vertices share a position, but not their attributes.
+/// \returns The indices of the simplified triangles, which are no more than `target_index_count`, unless collapsing
+/// more edges would exceed the given `max_error`. The error of a collapse is the root mean square distance, weighted
+/// by area, from the vertex collapsed onto to the planes of the triangles merged into the collapsed one, relative to
+/// the radius of the mesh bounds. It estimates the deviation rather than bounds it. The largest error of a collapse is
+/// stored into the given `result_error`, unless it's `nullptr`.
+template <typename Vertex>
+std::vector<std::uint32_t> simplify_mesh(std::vector<Vertex> const& vertices, std::vector<std::uint32_t> indices,
+                                         std::size_t const target_index_count, float const max_error = 0.05f,
+                                         float const attribute_weight = 0.1f, float* const result_error = nullptr)
+{
+    static_assert(has_position<Vertex>, "Only vertices with a position can be simplified.");
+
+    auto const vertex_count = vertices.size();
+    auto const index_count = indices.size() - indices.size() % 3u;
+    indices.resize(index_count);
+
+    // Normalizes positions to the unit sphere, so that errors are relative to the mesh size, like attributes.
+    std::vector<glm::vec3> positions(vertex_count);
+    std::transform(vertices.begin(), vertices.end(), positions.begin(), detail::get_position<Vertex>);
+
+    auto low = glm::vec3(std::numeric_limits<float>::max());
+    auto high = glm::vec3(std::numeric_limits<float>::lowest());
+    for (auto const index : indices) {
+        for (int i = 0; i < 3; ++i) {
+            low[i] = std::min(low[i], positions[index][i]);
+            high[i] = std::max(high[i], positions[index][i]);
+        }
+    }
+    auto const center = (low + high) * 0.5f;
+    auto const extent = high - center;
+    auto const radius = std::sqrt(detail::dot(extent, extent));
+    for (auto& position : positions) {
+        position = (position - center) * (radius > 0.f ? 1.f / radius : 1.f);
+    }
+
+    // Welds vertices of the same position, so that seams don't look like borders.
+    std::vector<std::uint32_t> weld(vertex_count);
+    std::vector<std::uint32_t> locked(vertex_count, 0u);
+    {
+        std::vector<std::uint32_t> order(vertex_count);
+        std::iota(order.begin(), order.end(), 0u);
+
+        auto const key = [&vertices](std::uint32_t const vertex) {
+            auto const position = detail::get_position(vertices[vertex]);
+            return std::make_tuple(position.x, position.y, position.z);
+        };
+        std::sort(order.begin(), order.end(), [&key](auto const a, auto const b) { return key(a) < key(b); });
+
+        for (std::size_t i = 0u; i < vertex_count; ++i) {
+            auto const same = i && key(order[i]) == key(order[i - 1u]);
+            weld[order[i]] = same ? weld[order[i - 1u]] : order[i];
+            if (same) {
+                locked[order[i]] = locked[order[i - 1u]] = locked[weld[order[i]]] = 1u;
+            }
+        }
+    }
+
+    // Lists the directed edges of the triangles, so that the open edges, which only one triangle uses, can be found.
+    std::vector<std::uint64_t> edges;
+    auto const find_edges = [&edges, &indices, &weld] {
+        edges.clear();
+        for (std::size_t i = 0u; i < indices.size(); ++i) {
+            auto const next = i - i % 3u + (i + 1u) % 3u;
+            edges.push_back(detail::edge_key(weld[indices[i]], weld[indices[next]]));
+        }
+        std::sort(edges.begin(), edges.end());
+    };
+    find_edges();
+
+    auto const has_edge = [&edges, &weld](std::uint32_t const from, std::uint32_t const to) {
+        return std::binary_search(edges.begin(), edges.end(), detail::edge_key(weld[from], weld[to]));
+    };
+    auto const is_open = [&has_edge](std::uint32_t const a, std::uint32_t const b) {
+        return has_edge(a, b) != has_edge(b, a);
+    };
+
+    std::vector<std::uint32_t> on_border(vertex_count, 0u);
+    for (std::size_t i = 1u; i < edges.size(); ++i) {
+        if (edges[i] == edges[i - 1u]) {
+            // Locks non-manifold edges.
+            locked[edges[i] >> 32u] = locked[edges[i] & 0xffffffffu] = 1u;
+        }
+    }
+
+    // Accumulates the quadrics of the triangles, and of the planes perpendicular to the open edges.
+    std::vector<detail::Quadric> quadrics(vertex_count);
+    for (std::size_t i = 0u; i < index_count; i += 3u) {
+        auto const normal = detail::cross(positions[indices[i + 1u]] - positions[indices[i]],
+                                          positions[indices[i + 2u]] - positions[indices[i]]);
+        auto const length = std::sqrt(detail::dot(normal, normal));
+        if (0.f == length) {
+            continue;
+        }
+
+        auto const unit_normal = normal * (1.f / length);
+        for (std::size_t j = 0u; j < 3u; ++j) {
+            auto const a = indices[i + j];
+            auto const b = indices[i + (j + 1u) % 3u];
+            quadrics[a].add_plane(unit_normal, positions[a], 0.5 * length);
+
+            if (is_open(a, b)) {
+                on_border[a] = on_border[b] = 1u;
+
+                auto const edge = positions[b] - positions[a];
+                auto const edge_normal = detail::cross(edge, unit_normal);
+                auto const edge_length2 = detail::dot(edge_normal, edge_normal);
+                if (edge_length2 > 0.f) {
+                    auto const weight = 10.0 * detail::dot(edge, edge);
+                    quadrics[a].add_plane(edge_normal * (1.f / std::sqrt(edge_length2)), positions[a], weight);
+                    quadrics[b].add_plane(edge_normal * (1.f / std::sqrt(edge_length2)), positions[a], weight);
+                }
+            }
+        }
+    }
+    for (std::uint32_t vertex = 0u; vertex < vertex_count; ++vertex) {
+        if (weld[vertex] != vertex) {
+            quadrics[weld[vertex]] += quadrics[vertex];
+        }
+    }
+
+    /// A collapse of the vertex `from` onto the vertex `to`, whose `cost` adds the weighted difference of their
+    /// attributes to the squared geometric `error`.
+    struct Collapse {
+        std::uint32_t from;
+        std::uint32_t to;
+        float cost;
+        float error;
+    };
+
+    std::vector<std::uint32_t> remap(vertex_count);
+    std::vector<std::uint32_t> first_triangle(vertex_count + 1u);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    auto largest_error = 0.f;
+
+    while (indices.size() > target_index_count) {
+        find_edges();
+
+        // Lists the triangles of every vertex.
+        std::fill(first_triangle.begin(), first_triangle.end(), 0u);
+        for (auto const index : indices) {
+            ++first_triangle[index + 1u];
+        }
+        std::partial_sum(first_triangle.begin(), first_triangle.end(), first_triangle.begin());
+
+        adjacency.resize(indices.size());
+        {
+            auto next = first_triangle;
+            for (std::size_t i = 0u; i < indices.size(); ++i) {
+                adjacency[next[indices[i]]++] = static_cast<std::uint32_t>(i / 3u);
+            }
+        }
+
+        // Lists the collapses allowed by the kinds of the vertices, with their costs.
+        collapses.clear();
+        for (std::size_t i = 0u; i < indices.size(); ++i) {
+            auto const from = indices[i];
+            auto const to = indices[i - i % 3u + (i + 1u) % 3u];
+            for (auto const& [a, b] : {std::make_pair(from, to), std::make_pair(to, from)}) {
+                // Vertices on a border may only slide along it.
+                if (locked[a] || (on_border[a] && !is_open(a, b))) {
+                    continue;
+                }
+
+                auto const& quadric = quadrics[weld[a]];
+                auto const weight = std::max(quadric.weight, 1e-12);
+                auto const error2 = static_cast<float>(quadric.evaluate(positions[b]) / weight);
+                auto const cost = error2 + attribute_weight * detail::attribute_distance2(vertices[a], vertices[b]);
+                collapses.push_back({a, b, cost, std::sqrt(error2)});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](auto const& a, auto const& b) { return a.cost < b.cost; });
+
+        // Collapses the edges of the least cost, as long as they don't touch the triangles of each other.
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::vector<std::uint32_t> touched(vertex_count, 0u);
+        auto triangle_count = indices.size() / 3u;
+        std::size_t collapse_count = 0u;
+
+        for (auto const& collapse : collapses) {
+            if (triangle_count * 3u <= target_index_count) {
+                break;
+            }
+
+            auto const from = collapse.from;
+            auto const to = collapse.to;
+            if (collapse.error > max_error || touched[from] || touched[to]) {
+                continue;
+            }
+
+            // Rejects the collapse, if it flips a triangle.
+            auto flips = false;
+            std::size_t removed = 0u;
+            for (auto t = first_triangle[from]; t < first_triangle[from + 1u] && !flips; ++t) {
+                auto const triangle = &indices[adjacency[t] * 3u];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                    ++removed;
+                    continue;
+                }
+
+                glm::vec3 corners[3] = {positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]};
+                auto const before = detail::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                for (auto& corner : corners) {
+                    corner = corner == positions[from] ? positions[to] : corner;
+                }
+                auto const after = detail::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                flips = detail::dot(before, after) <= 0.f;
+            }
+            if (flips) {
+                continue;
+            }
+
+            for (auto t = first_triangle[from]; t < first_triangle[from + 1u]; ++t) {
+                auto const triangle = &indices[adjacency[t] * 3u];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1u;
+            }
+
+            remap[from] = to;
+            quadrics[weld[to]] += quadrics[weld[from]];
+            largest_error = std::max(largest_error, collapse.error);
+            triangle_count -= removed;
+            ++collapse_count;
+        }
+
+        if (!collapse_count) {
+            break;
+        }
+
+        // Remaps the indices, and drops the triangles, which got degenerate.
+        std::size_t count = 0u;
+        for (std::size_t i = 0u; i < indices.size(); i += 3u) {
+            auto const a = remap[indices[i]];
+            auto const b = remap[indices[i + 1u]];
+            auto const c = remap[indices[i + 2u]];
+            if (a != b && b != c && c != a) {
+                indices[count++] = a;
+                indices[count++] = b;
+                indices[count++] = c;
+            }
+        }
+        indices.resize(count);
+    }
+
+    if (result_error) {
+        *result_error = largest_error;
+    }
+    return indices;
+}
+
+/// Builds levels of detail of the triangles of the given `indices`, which reference the given `vertices`, with the
+/// given `options`. Every level is simplified from the previous one with `simplify_mesh`, and gets optimized for the
+/// vertex cache. The levels share the `vertices`, so they fit into a single vertex buffer and a single index buffer.
+/// The error of a level adds up the errors of simplifying every level before it, see `MeshLod::error`.
+/// \returns The levels, which end early when a level can't be simplified any further within the error.
+template <typename Vertex>
+LodChain build_lod_chain(std::vector<Vertex> const& vertices, std::vector<std::uint32_t> const& indices,
+                         LodOptions const& options = {})
+{
+    LodChain chain;
+    chain.indices = indices;
+    chain.levels.push_back({0u, indices.size(), 0.f});
+
+    auto level = indices;
+    auto error = 0.f;
+    while (chain.levels.size() < options.max_level_count) {
+        auto const target = static_cast<std::size_t>(static_cast<float>(level.size() / 3u) * options.reduction) * 3u;
+
+        auto level_error = 0.f;
+        auto simplified = simplify_mesh(vertices, level, target, options.max_error - error, options.attribute_weight,
+                                        &level_error);
+
+        // Stops, when the level is not much simpler than the previous one.
+        if (simplified.empty() || simplified.size() * 20u > level.size() * 19u) {
+            break;
+        }
+
+        optimize_vertex_cache(simplified, vertices.size());
+
+        error += level_error;
+        chain.levels.push_back({chain.indices.size(), simplified.size(), error});
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+        level = std::move(simplified);
+    }
+
+    return chain;
+}
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Describes the attributes found in a Wavefront OBJ file.
+struct ObjAttributes {
+    /// Holds `true` when the positions are followed by colors, e.g. `v 0 0 0 1 0 0`.
+    bool has_color = false;
+
+    /// Holds `true` when the faces refer to texture coordinates, e.g. `f 1/1 2/2 3/3`.
+    bool has_texcoord = false;
+};
+
+namespace detail {
+
+/// Skips spaces and tabs starting at the given `text`.
+/// \returns A pointer to the first other character.
+inline char const* skip_blanks(char const* text)
+{
+    while (' ' == *text || '\t' == *text || '\r' == *text) {
+        ++text;
+    }
+    return text;
+}
+
+/// \returns `true` when the given character `c` begins an index, `false` otherwise.
+inline bool is_index(char const c)
+{
+    return '-' == c || std::isdigit(static_cast<unsigned char>(c));
+}
+
+/// Reads up to `N` floats from the given line of `text`, which is advanced past them.
+/// \returns The number of floats read.
+template <std::size_t N>
+std::size_t read_floats(char const*& text, float (&values)[N])
+{
+    std::size_t count = 0u;
+    for (; count < N; ++count) {
+        char* end = nullptr;
+        values[count] = std::strtof(text, &end);
+        if (end == text) {
+            break;
+        }
+        text = end;
+    }
+    return count;
+}
+
+/// Sets the given attribute of a vertex to the given `values`, padding missing components, e.g. the alpha of a color,
+/// with the given `padding`.
+template <typename T>
+void set_components(T& attribute, float const* const values, std::size_t const count, float const padding = 0.f)
+{
+    for (std::size_t i = 0u; i < component_count<T>; ++i) {
+        attribute[static_cast<int>(i)] = i < count ? values[i] : padding;
+    }
+}
+
+} // namespace detail
+
+/// Parses the given Wavefront OBJ `text` into `vertices` and `indices` of triangles. Positions, colors following the
+/// positions, and texture coordinates are read into the attributes of the given `Vertex` type found by their names.
+/// Normals, materials, groups, and other statements are ignored. Polygons are split into fans of triangles. A vertex is
+/// made for every distinct pair of position and texture coordinates. The attributes found in the file are stored into
+/// the given `attributes`, unless it's `nullptr`.
+/// \returns `true` on success, `false` if a face refers to a missing position or texture coordinates.
+template <typename Vertex>
+bool parse_obj(std::string const& text, std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices,
+               ObjAttributes* const attributes = nullptr)
+{
+    struct Position final {
+        float values[6];
+        std::size_t count;
+    };
+    std::vector<Position> positions;
+    std::vector<glm::vec2> texcoords;
+    std::unordered_map<std::uint64_t, std::uint32_t> vertex_indices;
+    ObjAttributes found;
+
+    // Resolves the given 1-based or negative relative index into the given number of items.
+    auto const resolve = [](long const index, std::size_t const count) {
+        return index > 0 ? static_cast<std::size_t>(index - 1) : count - static_cast<std::size_t>(-index);
+    };
+
+    auto line = text.c_str();
+    while (*line) {
+        auto cursor = detail::skip_blanks(line);
+
+        if ('v' == cursor[0] && ' ' == cursor[1]) {
+            cursor += 2;
+            Position position = {};
+            position.count = detail::read_floats(cursor, position.values);
+            found.has_color = found.has_color || position.count >= 6u;
+            positions.push_back(position);
+        }
+        else if ('v' == cursor[0] && 't' == cursor[1] && ' ' == cursor[2]) {
+            cursor += 3;
+            float values[2] = {};
+            detail::read_floats(cursor, values);
+            texcoords.emplace_back(values[0], values[1]);
+        }
+        else if ('f' == cursor[0] && ' ' == cursor[1]) {
+            cursor += 2;
+            std::vector<std::uint32_t> face;
+            for (cursor = detail::skip_blanks(cursor); detail::is_index(*cursor);
+                 cursor = detail::skip_blanks(cursor)) {
+                char* end = nullptr;
+                auto const position = resolve(std::strtol(cursor, &end, 10), positions.size());
+                auto texcoord = std::size_t{0u};
+                auto with_texcoord = false;
+                if ('/' == *end && '/' != end[1]) {
+                    texcoord = resolve(std::strtol(end + 1, &end, 10), texcoords.size());
+                    with_texcoord = true;
+                }
+                // Skips the normal.
+                while (*end && ' ' != *end && '\t' != *end && '\r' != *end && '\n' != *end) {
+                    ++end;
+                }
+                cursor = end;
+
+                if (position >= positions.size() || (with_texcoord && texcoord >= texcoords.size())) {
+                    // TODO: report the error.
+                    return false;
+                }
+                found.has_texcoord = found.has_texcoord || with_texcoord;
+
+                auto const key = static_cast<std::uint64_t>(position) << 32u |
+                                 static_cast<std::uint64_t>(with_texcoord ? texcoord + 1u : 0u);
+                auto const [it, inserted] =
+                    vertex_indices.emplace(key, static_cast<std::uint32_t>(vertex_indices.size()));
+                if (inserted) {
+                    Vertex vertex = {};
+                    auto const& values = positions[position];
+                    if constexpr (has_position<Vertex>) {
+                        detail::set_components(vertex.position, values.values, values.count < 3u ? values.count : 3u);
+                    }
+                    if constexpr (has_color<Vertex>) {
+                        auto const count = values.count >= 6u ? values.count - 3u : 0u;
+                        detail::set_components(vertex.color, values.values + 3u, count, 1.f);
+                    }
+                    if constexpr (has_texcoord<Vertex>) {
+                        if (with_texcoord) {
+                            detail::set_components(vertex.texcoord, &texcoords[texcoord][0], 2u);
+                        }
+                    }
+                    vertices.push_back(vertex);
+                }
+                face.push_back(it->second);
+            }
+
+            for (std::size_t i = 2u; i < face.size(); ++i) {
+                indices.insert(indices.end(), {face[0], face[i - 1u], face[i]});
+            }
+        }
+
+        // Moves to the next line.
+        while (*cursor && '\n' != *cursor) {
+            ++cursor;
+        }
+        line = *cursor ? cursor + 1 : cursor;
+    }
+
+    if (attributes) {
+        *attributes = found;
+    }
+    return true;
+}
+
+} // namespace v1
+} // namespace nest
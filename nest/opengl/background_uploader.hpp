@@ -0,0 +1,214 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <GL/glew.h>
+
+#include <nest/asset_streamer.hpp>
+#include <nest/opengl/context.hpp>
+#include <nest/opengl/fence.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for creating OpenGL objects on a thread of its own, in parallel with drawing.
+///
+/// The uploader owns a context, which shares objects with the renderer's one, see
+/// `OpenGL::Builder::with_shared_objects`. Buffers, textures, and shader programs are created on it, e.g. by
+/// `Mesh::Builder` or `ShaderProgram::Builder`, so neither `glBufferData` nor shader compilation takes time from the
+/// frames. Every object is published once a fence inserted after its creation is signaled, so the renderer never sees
+/// a half-uploaded one. Vertex arrays are not shared between contexts, so build meshes with
+/// `Mesh::Builder::with_deferred_vertex_array`.
+class BackgroundUploader final {
+  public:
+    /// Constructs an uploader, which makes the given shared `context` current on a thread of its own.
+    explicit BackgroundUploader(OpenGL&& context)
+    {
+        thread = std::thread([this, context = std::move(context)]() mutable {
+            context.make_current();
+            loop();
+        });
+    }
+
+    ~BackgroundUploader() noexcept
+    {
+        {
+            std::unique_lock lock(mutex);
+            stopping = true;
+        }
+        requested.notify_one();
+
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    BackgroundUploader(BackgroundUploader const&) = delete;
+    BackgroundUploader& operator=(BackgroundUploader const&) = delete;
+
+    /// Calls `create()` on the upload thread, which returns an object, e.g. a `Mesh`. The `create` is moved into the
+    /// uploader. Objects are created in the order they are requested. The handles of objects, which haven't been
+    /// published when the uploader is destroyed, are failed.
+    /// \returns A handle of the object, which becomes ready once the GPU has finished creating it.
+    template <typename F> // F models T()
+    auto upload(F create)
+    {
+        using T = std::invoke_result_t<F&>;
+
+        AssetFuture<T> future;
+        future.state = std::make_shared<typename AssetFuture<T>::State>();
+
+        num_pending.fetch_add(1u);
+        {
+            std::unique_lock lock(mutex);
+            jobs.push_back(std::make_unique<TypedJob<T, F>>(std::move(create), future.state));
+        }
+        requested.notify_one();
+        return future;
+    }
+
+    /// \returns The number of objects, which have been requested, but not yet published.
+    std::size_t get_pending_count() const
+    {
+        return num_pending.load();
+    }
+
+  private:
+    /// A request for an object.
+    struct Job {
+        virtual ~Job() = default;
+
+        /// Creates the object on the upload thread.
+        virtual void create() = 0;
+
+        /// Makes the created object available to its handles.
+        virtual void publish() = 0;
+
+        /// Destroys the created object, if any, and makes its handles failed.
+        virtual void cancel() = 0;
+    };
+
+    /// A request for an object of the given type `T`.
+    template <typename T, typename F>
+    struct TypedJob final : Job {
+        TypedJob(F&& create_fn, std::shared_ptr<typename AssetFuture<T>::State> state)
+            : create_fn(std::move(create_fn)), state(std::move(state))
+        {
+        }
+
+        void create() override
+        {
+            try {
+                state->value.emplace(create_fn());
+            }
+            catch (...) {
+                state->status.store(AssetFuture<T>::Failed, std::memory_order_release);
+            }
+        }
+
+        void publish() override
+        {
+            if (state->value) {
+                state->status.store(AssetFuture<T>::Ready, std::memory_order_release);
+            }
+        }
+
+        void cancel() override
+        {
+            state->value.reset();
+            state->status.store(AssetFuture<T>::Failed, std::memory_order_release);
+        }
+
+        F create_fn;
+        std::shared_ptr<typename AssetFuture<T>::State> state;
+    };
+
+    /// An object, which has been created, but may still be processed by the GPU.
+    struct PendingJob {
+        std::unique_ptr<Job> job;
+        Fence fence;
+    };
+
+    /// 'Infinite' loop which creates the requested objects.
+    void loop()
+    {
+        // Holds how long to wait for the GPU when there are no requests.
+        auto const fence_timeout = std::chrono::milliseconds(1);
+
+        // Holds the objects, which haven't been finished by the GPU yet, the oldest one first.
+        std::deque<PendingJob> pending;
+
+        for (;;) {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock lock(mutex);
+                if (pending.empty()) {
+                    requested.wait(lock, [this] { return stopping || !jobs.empty(); });
+                }
+                if (stopping) {
+                    // Fails the objects, which will never be published. The created ones are destroyed here, while
+                    // the context is current, since the GPU may still be processing them.
+                    for (auto& pending_job : pending) {
+                        pending_job.job->cancel();
+                    }
+                    for (auto& requested_job : jobs) {
+                        requested_job->cancel();
+                    }
+                    num_pending.fetch_sub(pending.size() + jobs.size());
+                    jobs.clear();
+                    return;
+                }
+                if (!jobs.empty()) {
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+            }
+
+            if (job) {
+                job->create();
+                pending.push_back({std::move(job), Fence::insert()});
+            }
+
+            // Publishes the objects finished by the GPU, the oldest one first. Waits for the oldest one a little when
+            // there's nothing else to do.
+            std::chrono::nanoseconds timeout = job ? std::chrono::nanoseconds::zero() : fence_timeout;
+            while (!pending.empty() && pending.front().fence.wait(timeout)) {
+                pending.front().job->publish();
+                pending.pop_front();
+                num_pending.fetch_sub(1u);
+                timeout = std::chrono::nanoseconds::zero();
+            }
+        }
+    }
+
+    /// Holds a handle to the upload thread.
+    std::thread thread;
+
+    /// Holds a handle to a mutex which protects `jobs` and `stopping`.
+    std::mutex mutex;
+
+    /// Is used to wake up the thread when an object is requested.
+    std::condition_variable requested;
+
+    /// Holds the requested objects, the oldest one first.
+    std::deque<std::unique_ptr<Job>> jobs;
+
+    /// Holds the number of objects, which have been requested, but not yet published.
+    std::atomic<std::size_t> num_pending{0u};
+
+    /// Holds a boolean which specifies whether the thread shall stop.
+    bool stopping = false;
+};
+
+} // namespace v1
+} // namespace nest
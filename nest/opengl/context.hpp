@@ -1,15 +1,30 @@
 #pragma once
 
 #include <algorithm>
+#include <memory>
+#include <string>
 
 #include <SDL2/SDL.h>
 
 #include <GL/glew.h>
 
+#include <nest/config.hpp>
+
+#if NEST_OPENGL_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <nest/opengl/fence.hpp>
+#include <nest/opengl/state_cache.hpp>
+
 namespace nest {
 inline namespace v1 {
 
 /// A class for managing OpenGL context. The instances of this class are immutable.
+///
+/// A context either draws to a window, or is headless: it has no window and draws to an offscreen framebuffer, which
+/// takes the place of the default one. Headless contexts need no display, so they're handy for benchmarks and tests.
 class OpenGL final {
   public:
     /// Enumerates possible OpenGL profiles, the actual availability depends on your target platform.
@@ -25,12 +40,27 @@ class OpenGL final {
     /// Performs OpenGL shutdown.
     ~OpenGL() noexcept
     {
+        if (state_cache && StateCache::current() == state_cache.get()) {
+            StateCache::make_current(nullptr);
+        }
         if (context) {
             SDL_GL_DeleteContext(context);
         }
         if (window) {
             SDL_DestroyWindow(window);
         }
+#if NEST_OPENGL_HEADLESS
+        // Destroying the context frees the offscreen framebuffer as well.
+        if (headless_context) {
+            if (eglGetCurrentContext() == headless_context) {
+                eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            }
+            eglDestroyContext(display, headless_context);
+        }
+        if (surface) {
+            eglDestroySurface(display, surface);
+        }
+#endif
     };
 
     OpenGL(OpenGL const& that) = delete;
@@ -53,27 +83,109 @@ class OpenGL final {
     void swap(OpenGL& that) noexcept
     {
         // clang-format off
-        std::swap(window,  that.window);
-        std::swap(context, that.context);
+        std::swap(window,      that.window);
+        std::swap(context,     that.context);
+        std::swap(state_cache, that.state_cache);
+#if NEST_OPENGL_HEADLESS
+        std::swap(display,          that.display);
+        std::swap(surface,          that.surface);
+        std::swap(headless_context, that.headless_context);
+        std::swap(framebuffer,      that.framebuffer);
+#endif
         // clang-format on
     }
 
-    /// Makes the context, manged by this `OpenGL` object, be the current one.
+    /// Makes the context, manged by this `OpenGL` object, be the current one. Its state cache becomes the current one
+    /// on the calling thread as well.
     void make_current()
     {
-        SDL_GL_MakeCurrent(window, context);
+#if NEST_OPENGL_HEADLESS
+        if (headless_context) {
+            eglMakeCurrent(display, surface, surface, headless_context);
+        }
+        else
+#endif
+        {
+            SDL_GL_MakeCurrent(window, context);
+        }
+        StateCache::make_current(state_cache.get());
     }
 
-    /// Swaps front and back buffers, updating the window with OpenGL rendering.
+    /// Makes the context, managed by this `OpenGL` object, no longer be current on the calling thread, so that it can
+    /// be made current on another one, e.g. by the `AsyncRenderer`.
+    void release_current()
+    {
+#if NEST_OPENGL_HEADLESS
+        if (headless_context) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+        else
+#endif
+        {
+            SDL_GL_MakeCurrent(window, nullptr);
+        }
+        if (StateCache::current() == state_cache.get()) {
+            StateCache::make_current(nullptr);
+        }
+    }
+
+    /// Swaps front and back buffers, updating the window with OpenGL rendering. A headless context has nothing to
+    /// swap, so it only flushes the commands issued so far.
     void swap_buffers()
     {
-        SDL_GL_SwapWindow(window);
+#if NEST_OPENGL_HEADLESS
+        if (headless_context) {
+            glFlush();
+        }
+        else
+#endif
+        {
+            SDL_GL_SwapWindow(window);
+        }
+
+        if (state_cache) {
+            state_cache->end_frame();
+        }
+    }
+
+    /// \returns The cache of this context's state, or `nullptr` if the context is null. The cache must only be used on
+    /// the thread the context is current on.
+    StateCache* get_state_cache()
+    {
+        return state_cache.get();
+    }
+
+    /// \returns A `Fence` inserted into the command stream of this context, which must be the current one.
+    Fence insert_fence()
+    {
+        return Fence::insert();
+    }
+
+    /// \returns A handle to the framebuffer, which takes the place of the default one: the offscreen framebuffer of a
+    /// headless context, or 0 otherwise. Bind it instead of 0 to draw to the screen.
+    GLuint get_default_framebuffer() const
+    {
+#if NEST_OPENGL_HEADLESS
+        return framebuffer;
+#else
+        return 0u;
+#endif
+    }
+
+    /// \returns `true` when the context has no window and draws to an offscreen framebuffer, `false` otherwise.
+    bool is_headless() const
+    {
+#if NEST_OPENGL_HEADLESS
+        return nullptr != headless_context;
+#else
+        return false;
+#endif
     }
 
     /// Checks whether the `OpenGL` manages a non-null context.
     explicit operator bool() const
     {
-        return nullptr != context;
+        return nullptr != context || is_headless();
     }
 
   private:
@@ -82,6 +194,24 @@ class OpenGL final {
 
     /// Holds an opaque poitner to SDL OpenGL context object.
     SDL_GLContext context = nullptr;
+
+    /// Holds the cache of the context's state. It's allocated on the heap, so it stays put when the `OpenGL` object is
+    /// moved to another thread.
+    std::unique_ptr<StateCache> state_cache;
+
+#if NEST_OPENGL_HEADLESS
+    /// Holds a handle to the EGL display of a headless context.
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    /// Holds a handle to the pbuffer surface of a headless context, if the implementation can't do without one.
+    EGLSurface surface = EGL_NO_SURFACE;
+
+    /// Holds a handle to the EGL context of a headless context.
+    EGLContext headless_context = EGL_NO_CONTEXT;
+
+    /// Holds a handle to the offscreen framebuffer of a headless context.
+    GLuint framebuffer = 0u;
+#endif
 };
 
 /// A class for making `OpenGL` instances.
@@ -93,6 +223,36 @@ class OpenGL::Builder final {
         window_title = title;
         window_width = width;
         window_height = height;
+        headless = false;
+
+        return *this;
+    }
+
+#if NEST_OPENGL_HEADLESS
+    /// Specifies that the context has no window, and draws to an offscreen framebuffer of the given dimensions. The
+    /// framebuffer is bound in place of the default one, see `OpenGL::get_default_framebuffer`.
+    Builder& with_headless(int width, int height)
+    {
+        window_width = width;
+        window_height = height;
+        headless = true;
+
+        return *this;
+    }
+#endif
+
+    /// Makes the context being built share objects, e.g. buffers, textures and shader programs, with the given
+    /// `context`, so that they can be created on another thread, e.g. by a `BackgroundUploader`. Container objects,
+    /// e.g. vertex arrays and framebuffers, are never shared. The shared context is headless if `context` is, and has
+    /// no offscreen framebuffer, otherwise it gets a hidden window of its own, and `context` must be current on the
+    /// calling thread. The `context` must outlive the built one. Building a shared context leaves the current context
+    /// as it was.
+    Builder& with_shared_objects(OpenGL const& context)
+    {
+        shared = &context;
+#if NEST_OPENGL_HEADLESS
+        headless = context.is_headless();
+#endif
 
         return *this;
     }
@@ -107,6 +267,8 @@ class OpenGL::Builder final {
         SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, num_a_bits);
         // clang-format on
 
+        has_alpha = 0 < num_a_bits;
+
         return *this;
     }
 
@@ -118,6 +280,9 @@ class OpenGL::Builder final {
         SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, num_stencil_bits);
         // clang-format on
 
+        has_depth = 0 < num_depth_bits;
+        has_stencil = 0 < num_stencil_bits;
+
         return *this;
     }
 
@@ -135,6 +300,9 @@ class OpenGL::Builder final {
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, major);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, minor);
 
+        major_version = major;
+        minor_version = minor;
+
         return *this;
     }
 
@@ -147,20 +315,72 @@ class OpenGL::Builder final {
                                                                            : SDL_GL_CONTEXT_PROFILE_ES));
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, value);
 
+        context_profile = profile;
+
         return *this;
     }
 
     /// \returns The built `OpenGL` instance.
     operator OpenGL()
     {
+        if (!shared) {
+            build();
+            return std::move(instance);
+        }
+
+        // Creating a context makes it current, while a shared one is meant to be current on another thread.
+        auto const cache = StateCache::current();
+        auto const window = SDL_GL_GetCurrentWindow();
+        auto const context = SDL_GL_GetCurrentContext();
+#if NEST_OPENGL_HEADLESS
+        auto const display = eglGetCurrentDisplay();
+        auto const draw_surface = eglGetCurrentSurface(EGL_DRAW);
+        auto const read_surface = eglGetCurrentSurface(EGL_READ);
+        auto const headless_context = eglGetCurrentContext();
+#endif
+
+        build();
+
+#if NEST_OPENGL_HEADLESS
+        if (EGL_NO_CONTEXT != headless_context) {
+            eglMakeCurrent(display, draw_surface, read_surface, headless_context);
+        }
+        else if (instance.is_headless()) {
+            eglMakeCurrent(instance.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+        if (!instance.is_headless())
+#endif
+        {
+            SDL_GL_MakeCurrent(window, context);
+        }
+        StateCache::make_current(cache);
+
+        return std::move(instance);
+    }
+
+  private:
+    /// Creates the context of the instance, and makes it current.
+    void build()
+    {
+#if NEST_OPENGL_HEADLESS
+        if (headless) {
+            build_headless();
+            return;
+        }
+#endif
+
         auto const title = window_title.empty() ? "" : window_title.data();
 
         auto const x = SDL_WINDOWPOS_CENTERED;
         auto const y = SDL_WINDOWPOS_CENTERED;
 
+        // A shared context draws nothing, so its window is never shown.
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, shared ? 1 : 0);
+
         // TODO: Seems like `SDL_WINDOW_RESIZABLE` is a good candidate for being configured though the builder as well.
-        instance.window =
-            SDL_CreateWindow(title, x, y, window_width, window_height, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+        instance.window = shared ? SDL_CreateWindow(title, x, y, 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN)
+                                 : SDL_CreateWindow(title, x, y, window_width, window_height,
+                                                    SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
 
         if (!instance.window) {
             // TODO: Output error notification.
@@ -171,28 +391,191 @@ class OpenGL::Builder final {
                 // TODO: Output error notification.
             }
             else {
-                auto const error_code = glewInit();
-                if (GLEW_OK != error_code) {
-                    // TODO: Output error notification.
-                }
+                // Creating a context makes it current.
+                initialize_current();
             }
         }
 
-        return std::move(instance);
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
     }
 
-  private:
+    /// Initializes GLEW and the state cache of the instance, which context must be the current one.
+    void initialize_current()
+    {
+        auto const error_code = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+        // GLEW built for GLX fails to load GLX entry points for an EGL context, but the OpenGL ones are loaded fine.
+        if (GLEW_OK != error_code && !(headless && GLEW_ERROR_NO_GLX_DISPLAY == error_code)) {
+#else
+        if (GLEW_OK != error_code) {
+#endif
+            // TODO: Output error notification.
+        }
+
+        // Lets the driver compile shaders on as many threads as it sees fit, see `ShaderProgram::Builder::build_async`.
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        }
+        else if (GLEW_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        }
+
+        instance.state_cache = std::make_unique<StateCache>();
+        StateCache::make_current(instance.state_cache.get());
+    }
+
+#if NEST_OPENGL_HEADLESS
+    /// Creates a headless context through EGL, preferably on Mesa's surfaceless platform, and makes it current.
+    void build_headless()
+    {
+        auto& display = instance.display;
+
+        // A shared context must be on the display of the context it shares objects with.
+        auto const client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (shared) {
+            display = shared->display;
+        }
+        else if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+            display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (EGL_NO_DISPLAY == display) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        if (EGL_NO_DISPLAY == display || !eglInitialize(display, nullptr, nullptr)) {
+            // TODO: Output error notification.
+            instance.display = EGL_NO_DISPLAY;
+            return;
+        }
+
+        auto const is_es = Profile::ES == context_profile;
+        eglBindAPI(is_es ? EGL_OPENGL_ES_API : EGL_OPENGL_API);
+
+        // clang-format off
+        EGLint const config_attributes[] = {
+            EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, is_es ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        // clang-format on
+
+        EGLConfig config = nullptr;
+        EGLint num_configs = 0;
+        if (!eglChooseConfig(display, config_attributes, &config, 1, &num_configs) || !num_configs) {
+            config = nullptr;
+        }
+
+        auto const display_extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (!config && !has_extension(display_extensions, "EGL_KHR_no_config_context")) {
+            // TODO: Output error notification.
+            return;
+        }
+
+        auto const profile_mask = Profile::Compatability == context_profile
+                                      ? EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT
+                                      : EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT;
+
+        // clang-format off
+        EGLint const context_attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION,       major_version,
+            EGL_CONTEXT_MINOR_VERSION,       minor_version,
+            is_es ? EGL_NONE : EGL_CONTEXT_OPENGL_PROFILE_MASK, profile_mask,
+            EGL_NONE
+        };
+        // clang-format on
+
+        auto const share_context = shared ? shared->headless_context : EGL_NO_CONTEXT;
+        instance.headless_context = eglCreateContext(display, config, share_context, context_attributes);
+        if (EGL_NO_CONTEXT == instance.headless_context) {
+            // TODO: Output error notification.
+            return;
+        }
+
+        // Surfaceless contexts need no surface at all, the rest get a tiny pbuffer, which is never drawn to.
+        if (!has_extension(display_extensions, "EGL_KHR_surfaceless_context") && config) {
+            EGLint const surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            instance.surface = eglCreatePbufferSurface(display, config, surface_attributes);
+        }
+
+        if (!eglMakeCurrent(display, instance.surface, instance.surface, instance.headless_context)) {
+            // TODO: Output error notification.
+            return;
+        }
+
+        initialize_current();
+
+        // A shared context draws nothing, so it needs no framebuffer.
+        if (!shared) {
+            create_framebuffer();
+        }
+    }
+
+    /// Creates the offscreen framebuffer of the instance, and binds it in place of the default one.
+    void create_framebuffer()
+    {
+        auto const color_format = has_alpha ? GL_RGBA8 : GL_RGB8;
+        auto const depth_format = has_stencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24;
+        auto const depth_attachment = has_stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+
+        // The renderbuffers are owned by the framebuffer once attached, and are freed along with the context.
+        GLuint renderbuffers[2] = {0u, 0u};
+        glGenRenderbuffers(has_depth ? 2 : 1, renderbuffers);
+
+        glGenFramebuffers(1, &instance.framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, instance.framebuffer);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, color_format, window_width, window_height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+
+        if (has_depth) {
+            glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+            glRenderbufferStorage(GL_RENDERBUFFER, depth_format, window_width, window_height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, depth_attachment, GL_RENDERBUFFER, renderbuffers[1]);
+        }
+
+        if (GL_FRAMEBUFFER_COMPLETE != glCheckFramebufferStatus(GL_FRAMEBUFFER)) {
+            // TODO: Output error notification.
+        }
+
+        glViewport(0, 0, window_width, window_height);
+    }
+
+    /// \returns `true` when the space-separated list of `extensions` contains the given `extension`.
+    static bool has_extension(char const* const extensions, std::string const& extension)
+    {
+        if (!extensions) {
+            return false;
+        }
+        std::string const list = std::string(" ") + extensions + " ";
+        return std::string::npos != list.find(" " + extension + " ");
+    }
+#endif
+
     /// Holds the title of the window being built.
     std::string window_title = "";
 
     // clang-format off
-    /// Holds the size of the window being built.
+    /// Holds the size of the window, or the offscreen framebuffer, being built.
     /// @{
     int window_width  = 800;
     int window_height = 600;
     /// @}
+
+    /// Hold the attributes of the context being built, which are needed to create a headless one.
+    /// @{
+    bool    headless        = false;
+    bool    has_alpha       = true;
+    bool    has_depth       = true;
+    bool    has_stencil     = true;
+    int     major_version   = 3;
+    int     minor_version   = 2;
+    Profile context_profile = Profile::Core;
+    /// @}
     // clang-format on
 
+    /// Holds the context, which the context being built shares objects with, if any.
+    OpenGL const* shared = nullptr;
+
     /// Holds the `OpenGL` instance being built.
     OpenGL instance;
 };
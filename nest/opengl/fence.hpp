@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+#include <GL/glew.h>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for managing an OpenGL fence sync object. A fence gets signaled when the GPU has finished executing all the
+/// commands issued before the fence was inserted.
+class Fence final {
+  public:
+    /// Constructs an empty `Fence`, which is considered to be signaled.
+    Fence() noexcept = default;
+
+    Fence(Fence const&) = delete;
+    Fence(Fence&& that) noexcept
+    {
+        swap(that);
+    }
+
+    ~Fence() noexcept
+    {
+        if (sync) {
+            glDeleteSync(sync);
+        }
+    }
+
+    Fence& operator=(Fence const&) = delete;
+    Fence& operator=(Fence&& that) noexcept
+    {
+        swap(that);
+        return *this;
+    }
+
+    void swap(Fence& that) noexcept
+    {
+        std::swap(sync, that.sync);
+        std::swap(flushed, that.flushed);
+    }
+
+    /// \returns A `Fence` inserted into the command stream of the current context.
+    static Fence insert()
+    {
+        Fence fence;
+        fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        if (!fence.sync) {
+            // TODO: report the error.
+        }
+        return fence;
+    }
+
+    /// \returns `true` when the fence is not empty, `false` otherwise.
+    explicit operator bool() const
+    {
+        return nullptr != sync;
+    }
+
+    /// Blocks the calling thread until the fence gets signaled or the `timeout` expires. The context the fence was
+    /// inserted into must be current.
+    /// \returns `true` when the fence is signaled, `false` otherwise.
+    bool wait(std::chrono::nanoseconds const timeout)
+    {
+        if (!sync) {
+            return true;
+        }
+
+        // Commands preceding the fence have to be flushed at least once, otherwise the wait may never finish.
+        GLbitfield const flags = flushed ? 0u : GL_SYNC_FLUSH_COMMANDS_BIT;
+        flushed = true;
+
+        auto const nanoseconds = static_cast<GLuint64>(std::max<std::chrono::nanoseconds::rep>(timeout.count(), 0));
+
+        switch (glClientWaitSync(sync, flags, nanoseconds)) {
+        case GL_ALREADY_SIGNALED:
+        case GL_CONDITION_SATISFIED:
+            return true;
+
+        case GL_WAIT_FAILED:
+            // TODO: report the error.
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    /// \returns `true` when the fence is signaled, `false` otherwise. Never blocks.
+    bool is_signaled()
+    {
+        return wait(std::chrono::nanoseconds::zero());
+    }
+
+  private:
+    /// Holds the OpenGL sync object.
+    GLsync sync = nullptr;
+
+    /// Holds a boolean, which specifies whether the commands preceding the fence have been flushed.
+    bool flushed = false;
+};
+
+} // namespace v1
+} // namespace nest
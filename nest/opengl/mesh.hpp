@@ -1,11 +1,25 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <GL/glew.h>
 
+#include <nest/mesh_format.hpp>
+#include <nest/mesh_optimizer.hpp>
+#include <nest/mesh_simplifier.hpp>
+#include <nest/opengl/mesh_pool.hpp>
+#include <nest/opengl/state_cache.hpp>
+#include <nest/opengl/stream_buffer.hpp>
+#include <nest/opengl/vertex_layout.hpp>
+#include <nest/quantization.hpp>
 #include <nest/vertex_traits.hpp>
 
 namespace nest {
@@ -27,11 +41,15 @@ class Mesh final {
 
     ~Mesh() noexcept
     {
+        if (pool) {
+            pool->destroy_slot(pool_slot);
+        }
+
         // A value of 0 will be silently ignored.
-        glDeleteVertexArrays(1, &vao_handle);
+        detail::delete_vertex_arrays(1, &vao_handle);
 
         // A value of 0 will be silently ignored.
-        glDeleteBuffers(VboCount, vbo_handle);
+        detail::delete_buffers(VboCount, vbo_handle);
     }
 
     Mesh& operator=(Mesh const&) = delete;
@@ -43,29 +61,187 @@ class Mesh final {
 
     void swap(Mesh& that)
     {
-        std::swap(vao_handle, that.vao_handle);
-        std::swap(vbo_handle, that.vbo_handle);
+        // clang-format off
+        std::swap(vao_handle,    that.vao_handle);
+        std::swap(vbo_handle,    that.vbo_handle);
+        std::swap(num_vertices,  that.num_vertices);
+        std::swap(num_indices,   that.num_indices);
+        std::swap(num_instances, that.num_instances);
+        std::swap(index_type,    that.index_type);
+        std::swap(lods,          that.lods);
+        std::swap(lod,           that.lod);
+        std::swap(pending_setup, that.pending_setup);
+        std::swap(pool,          that.pool);
+        std::swap(pool_slot,     that.pool_slot);
+        // clang-format on
     }
 
     /// \returns `true` when this `Mesh` is not empty, `false` otherwise.
     explicit operator bool() const
     {
-        return 0u != vao_handle;
+        return 0u != vao_handle || nullptr != pool || static_cast<bool>(pending_setup);
+    }
+
+    /// \returns The OpenGL name of the `Mesh` vertex array object, e.g. for building a `SortKey`. Meshes of the same
+    /// `MeshPool` share it. Meshes with a deferred vertex array have none until they are first enabled.
+    GLuint get_vao_handle() const
+    {
+        return pool ? pool->vao_handle : vao_handle;
+    }
+
+    /// \returns `true` when the `Mesh` is drawn with indices, `false` otherwise.
+    bool has_indices() const
+    {
+        return 0u != num_indices;
+    }
+
+    /// \returns The number of vertices in the `Mesh`.
+    std::size_t get_vertex_count() const
+    {
+        return num_vertices;
+    }
+
+    /// \returns The number of indices in the `Mesh`.
+    std::size_t get_index_count() const
+    {
+        return num_indices;
+    }
+
+    /// \returns The number of instances drawn by `draw`, or 0 if the `Mesh` is not instanced.
+    std::size_t get_instance_count() const
+    {
+        return num_instances;
+    }
+
+    /// \returns The levels of detail of the `Mesh`, the most detailed one first, or none if it has a single level.
+    std::vector<MeshLod> const& get_lods() const
+    {
+        return lods;
+    }
+
+    /// \returns The index of the level of detail drawn by `draw`.
+    std::size_t get_lod() const
+    {
+        return lod;
     }
 
-    /// Makes the `Mesh` be used for drawing.
+    /// Makes `draw` draw the level of detail of the given index, e.g. the one picked by a `LodSelector`.
+    void set_lod(std::size_t const level)
+    {
+        lod = std::min(level, lods.empty() ? std::size_t{0u} : lods.size() - 1u);
+    }
+
+    /// Makes the `Mesh` be used for drawing. Creates the vertex array object, if it has been deferred.
     void enable()
     {
-        if (vao_handle) {
-            glBindVertexArray(vao_handle);
+        if (pending_setup) {
+            create_vertex_array();
+        }
+        if (auto const handle = get_vao_handle()) {
+            detail::bind_vertex_array(handle);
+        }
+    }
+
+    /// Draws the `Mesh` as primitives of the given `mode` with the current shader program. Meshes of a `MeshPool` are
+    /// drawn from the pool's buffers with `glDrawElementsBaseVertex`. Instanced meshes draw all their instances with
+    /// a single `glDrawElementsInstanced`. Meshes with levels of detail draw the current level.
+    void draw(GLenum const mode = GL_TRIANGLES)
+    {
+        enable();
+
+        auto first_index = std::size_t{0u};
+        auto index_count = num_indices;
+        if (!lods.empty()) {
+            first_index = lods[lod].first_index;
+            index_count = lods[lod].index_count;
+        }
+
+        if (num_instances) {
+            auto const count = static_cast<GLsizei>(num_instances);
+            if (num_indices) {
+                glDrawElementsInstanced(mode, static_cast<GLsizei>(index_count), index_type,
+                                        get_index_offset(first_index), count);
+            }
+            else {
+                glDrawArraysInstanced(mode, 0, static_cast<GLsizei>(num_vertices), count);
+            }
+            return;
+        }
+
+        if (pool) {
+            auto const& slot = pool->slots[pool_slot];
+            if (slot.index_count) {
+                glDrawElementsBaseVertex(mode, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT,
+                                         get_index_offset(slot.first_index + first_index),
+                                         static_cast<GLint>(slot.first_vertex));
+            }
+            else {
+                glDrawArrays(mode, static_cast<GLint>(slot.first_vertex), static_cast<GLsizei>(slot.vertex_count));
+            }
+        }
+        else if (num_indices) {
+            glDrawElements(mode, static_cast<GLsizei>(index_count), index_type, get_index_offset(first_index));
+        }
+        else if (num_vertices) {
+            glDrawArrays(mode, 0, static_cast<GLsizei>(num_vertices));
         }
     }
 
   private:
-    enum { Vertices, Indices, VboCount };
+    enum { Vertices, Indices, Instances, VboCount };
+
+    /// Creates the deferred vertex array object in the current context, and sets its attributes up.
+    void create_vertex_array()
+    {
+        glGenVertexArrays(1, &vao_handle);
+        if (!vao_handle) {
+            // TODO: report the error.
+            return;
+        }
+
+        detail::bind_vertex_array(vao_handle);
+        std::exchange(pending_setup, nullptr)();
+        if (vbo_handle[Indices]) {
+            detail::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, vbo_handle[Indices]);
+        }
+    }
+
+    /// \returns The offset of the index of the given index within the bound index buffer.
+    GLvoid const* get_index_offset(std::size_t const index) const
+    {
+        auto const index_size = pool || GL_UNSIGNED_INT == index_type ? sizeof(GLuint)
+                                : GL_UNSIGNED_SHORT == index_type  ? sizeof(GLushort)
+                                                                   : sizeof(GLubyte);
+        return reinterpret_cast<GLvoid const*>(index * index_size);
+    }
 
     GLuint vao_handle = 0u;
-    GLuint vbo_handle[VboCount] = {0u, 0u};
+    GLuint vbo_handle[VboCount] = {0u, 0u, 0u};
+
+    /// Hold the numbers of vertices, indices and instances.
+    /// @{
+    std::size_t num_vertices = 0u;
+    std::size_t num_indices = 0u;
+    std::size_t num_instances = 0u;
+    /// @}
+
+    /// Holds the type of indices.
+    GLenum index_type = GL_UNSIGNED_INT;
+
+    /// Holds the levels of detail, which share the vertices and the indices of the `Mesh`.
+    std::vector<MeshLod> lods;
+
+    /// Holds the index of the level of detail to draw.
+    std::size_t lod = 0u;
+
+    /// Holds the setup of the attributes of a deferred vertex array object, which is run once it's created.
+    std::function<void()> pending_setup;
+
+    /// Holds the state of the pool the `Mesh` is stored in, if any.
+    MeshPool::Storage* pool = nullptr;
+
+    /// Holds the index of the `Mesh` slot in the `pool`.
+    std::uint32_t pool_slot = 0u;
 };
 
 namespace detail {
@@ -90,44 +266,88 @@ bool set_buffer_data(GLenum const target, GLuint& vbo, T begin, T end, GLenum us
         }
     }
 
-    glBindBuffer(target, vbo);
+    detail::bind_buffer(target, vbo);
     glBufferData(target, num_items * sizeof(Item), &begin[0], usage);
 
     return true;
 }
 
-/// Enables and initializes an attribute with the given `index`.
-template <typename T>
-void enable_attribute(GLuint const index, GLboolean const normalized, GLvoid const* pointer)
-{
-    glEnableVertexAttribArray(index);
-    glVertexAttribPointer(index, component_count<T>, opengl_type<T>, normalized, sizeof(T), pointer);
-}
-
 } // namespace detail
 
 /// A class template for building instances of `Mesh` class.
 class Mesh::Builder final {
   public:
+    /// Makes the `Mesh` being built be stored in the given `pool`, which must outlive it. Call this before setting
+    /// vertices and indices. The vertices must be of the pool's layout.
+    Builder& with_pool(MeshPool& pool)
+    {
+        if (pool && !instance.vao_handle && !instance.pool && !deferred) {
+            instance.pool = pool.storage.get();
+            instance.pool_slot = instance.pool->create_slot();
+        }
+        else {
+            // TODO: report the error.
+        }
+        return *this;
+    }
+
+    /// Makes the `Mesh` being built create its vertex array object on first use rather than now. Vertex arrays are not
+    /// shared between contexts, so build meshes this way on a context, which shares objects with the renderer's one,
+    /// e.g. on a `BackgroundUploader`. Call this before setting vertices and indices. Pooled meshes can't be deferred.
+    Builder& with_deferred_vertex_array()
+    {
+        if (!instance.vao_handle && !instance.pool) {
+            deferred = true;
+        }
+        else {
+            // TODO: report the error.
+        }
+        return *this;
+    }
+
     /// Sets vertices of the `Mesh` being built.
     template <typename T> // T models RandomAccessIterator
     Builder& with_vertices(T begin, T end)
     {
-        if (lazy_init() && detail::set_buffer_data(GL_ARRAY_BUFFER, instance.vbo_handle[Vertices], begin, end)) {
-            using Vertex = typename std::iterator_traits<T>::value_type;
+        using Vertex = typename std::iterator_traits<T>::value_type;
 
-            if constexpr (has_position<Vertex>) {
-                detail::enable_attribute<decltype(Vertex::position)>(PositionAttribute, GL_FALSE,
-                                                                     offsetof(Vertex, position));
+        if (auto const pool = instance.pool) {
+            if (sizeof(Vertex) == pool->vertices.item_size && end != begin &&
+                pool->upload(pool->vertices, instance.pool_slot, &begin[0], end - begin)) {
+                instance.num_vertices = end - begin;
             }
-
-            if constexpr (has_color<Vertex>) {
-                detail::enable_attribute<decltype(Vertex::color)>(ColorAttribute, GL_FALSE, offsetof(Vertex, color));
+            else {
+                // TODO: report the error.
             }
+        }
+        else if (lazy_init() && detail::set_buffer_data(GL_ARRAY_BUFFER, instance.vbo_handle[Vertices], begin, end)) {
+            set_up_attributes(instance.vbo_handle[Vertices], [] { detail::enable_attributes<Vertex>(); });
+            instance.num_vertices = end - begin;
+        }
+        else {
+            // TODO: report the error.
+        }
+        return *this;
+    }
+
+    /// Sets vertices of the `Mesh` being built, quantized into a compact layout at upload: float colors become
+    /// normalized bytes, and other float attributes become half floats. Shaders read them as floats all the same.
+    /// The largest errors introduced by the quantization are stored into the given `error`, unless it's `nullptr`.
+    /// Pooled meshes can't be quantized, since their vertices must be of the pool's layout.
+    template <typename T> // T models RandomAccessIterator
+    Builder& with_quantized_vertices(T begin, T end, QuantizationError* const error = nullptr)
+    {
+        using Vertex = typename std::iterator_traits<T>::value_type;
 
-            if constexpr (has_texcoord<Vertex>) {
-                detail::enable_attribute<decltype(Vertex::texcoord)>(TexcoordAttribute, GL_FALSE,
-                                                                     offsetof(Vertex, texcoord));
+        std::vector<std::byte> data;
+        auto const quantization_error = detail::quantize_vertices(begin, end, data);
+
+        if (!instance.pool && lazy_init() &&
+            detail::set_buffer_data(GL_ARRAY_BUFFER, instance.vbo_handle[Vertices], data.begin(), data.end())) {
+            set_up_attributes(instance.vbo_handle[Vertices], [] { detail::enable_quantized_attributes<Vertex>(); });
+            instance.num_vertices = end - begin;
+            if (error) {
+                *error = quantization_error;
             }
         }
         else {
@@ -136,11 +356,56 @@ class Mesh::Builder final {
         return *this;
     }
 
-    /// Sets indices of the `Mesh` being built.
+    /// Sets quantized vertices with the given `container`.
+    template <typename T> // T models ContiguousContainer
+    Builder& with_quantized_vertices(T const& container, QuantizationError* const error = nullptr)
+    {
+        using std::begin, std::end;
+        return with_quantized_vertices(begin(container), end(container), error);
+    }
+
+    /// Makes the `Mesh` being built read vertices of type `Vertex` from the given `buffer`, which the caller keeps
+    /// alive and rewrites every frame. The vertices mapped by `StreamBuffer::map<Vertex>` are then drawn starting
+    /// from the `first()` vertex of the mapped range.
+    template <typename Vertex>
+    Builder& with_streaming_vertices(StreamBuffer const& buffer)
+    {
+        if (lazy_init() && buffer) {
+            set_up_attributes(buffer.get_handle(), [] { detail::enable_attributes<Vertex>(); });
+        }
+        else {
+            // TODO: report the error.
+        }
+        return *this;
+    }
+
+    /// Sets indices of the `Mesh` being built. OpenGL draws unsigned indices only, so indices of other types are
+    /// converted to 32 bits.
     template <typename T> // T models RandomAccessIterator
     Builder& with_indices(T begin, T end)
     {
-        if (lazy_init() && detail::set_buffer_data(GL_ELEMENT_ARRAY_BUFFER, instance.vbo_handle[Indices], begin, end)) {
+        using Index = typename std::iterator_traits<T>::value_type;
+
+        if constexpr (!std::is_same_v<Index, GLubyte> && !std::is_same_v<Index, GLushort> &&
+                      !std::is_same_v<Index, GLuint>) {
+            std::vector<GLuint> const indices(begin, end);
+            return with_indices(indices.begin(), indices.end());
+        }
+
+        if (auto const pool = instance.pool) {
+            // Pools store 32-bit indices only.
+            std::vector<GLuint> indices(begin, end);
+            if (!indices.empty() && pool->upload(pool->indices, instance.pool_slot, indices.data(), indices.size())) {
+                instance.num_indices = indices.size();
+            }
+            else {
+                // TODO: report the error.
+            }
+        }
+        else if (lazy_init() &&
+                 detail::set_buffer_data(get_index_target(), instance.vbo_handle[Indices], begin, end)) {
+            instance.num_indices = end - begin;
+            instance.index_type = opengl_type<Index>;
         }
         else {
             // TODO: report the error.
@@ -148,6 +413,112 @@ class Mesh::Builder final {
         return *this;
     }
 
+    /// Sets vertices and indices of the `Mesh` being built, after optimizing them with `optimize_mesh` and the given
+    /// `options`: triangles are reordered for the vertex cache and for less overdraw, vertices are reordered in the
+    /// order they are fetched, and indices are narrowed to 16 bits when there are few enough vertices. The report of
+    /// the optimization is stored into the given `report`, unless it's `nullptr`.
+    template <typename V, typename I> // V and I model ContiguousContainer
+    Builder& with_optimized_geometry(V const& vertices, I const& indices,
+                                     MeshOptimizationReport* const report = nullptr,
+                                     MeshOptimization const& options = {})
+    {
+        using std::begin, std::end;
+        using Vertex = typename std::iterator_traits<decltype(begin(vertices))>::value_type;
+
+        std::vector<Vertex> optimized_vertices(begin(vertices), end(vertices));
+        std::vector<std::uint32_t> optimized_indices(begin(indices), end(indices));
+        auto const optimization = optimize_mesh(optimized_vertices, optimized_indices, options);
+
+        with_vertices(optimized_vertices);
+        with_narrowed_indices(optimized_indices, sizeof(GLushort) == optimization.index_size);
+
+        if (report) {
+            *report = optimization;
+        }
+        return *this;
+    }
+
+    /// Sets vertices and indices of the `Mesh` being built along with its levels of detail, which are built by
+    /// `build_lod_chain` with the given `options`. The levels share the vertices and the indices, so they take a
+    /// single vertex buffer and a single index buffer. Indices are narrowed to 16 bits when there are few enough
+    /// vertices. Pick the level to draw with `Mesh::set_lod`.
+    template <typename V, typename I> // V and I model ContiguousContainer
+    Builder& with_lods(V const& vertices, I const& indices, LodOptions const& options = {})
+    {
+        using std::begin, std::end;
+        using Vertex = typename std::iterator_traits<decltype(begin(vertices))>::value_type;
+
+        std::vector<Vertex> lod_vertices(begin(vertices), end(vertices));
+        auto chain = build_lod_chain(lod_vertices, std::vector<std::uint32_t>(begin(indices), end(indices)), options);
+
+        with_vertices(lod_vertices);
+        with_narrowed_indices(chain.indices, lod_vertices.size() <= 65536u);
+        if (instance.num_indices) {
+            instance.lods = std::move(chain.levels);
+            instance.lod = 0u;
+        }
+        return *this;
+    }
+
+    /// Sets vertices and indices of the `Mesh` being built along with its levels of detail, which are stored in the
+    /// given mesh `file`. They are uploaded straight from the mapped file, so the file may be closed once the `Mesh` is
+    /// built. Pooled meshes can't be loaded from files, since their vertices must be of the pool's layout.
+    Builder& with_mesh_file(MeshFile const& file)
+    {
+        if (!file || instance.pool || !lazy_init()) {
+            // TODO: report the error.
+            return *this;
+        }
+
+        auto const& header = file.get_header();
+        auto const vertex_data = file.get_vertex_data();
+        if (detail::set_buffer_data(GL_ARRAY_BUFFER, instance.vbo_handle[Vertices], vertex_data,
+                                    vertex_data + header.vertices.size)) {
+            set_up_attributes(instance.vbo_handle[Vertices], [header] { detail::enable_attributes(header); });
+            instance.num_vertices = static_cast<std::size_t>(header.vertex_count);
+        }
+        else {
+            // TODO: report the error.
+        }
+
+        auto const index_data = file.get_index_data();
+        if (detail::set_buffer_data(get_index_target(), instance.vbo_handle[Indices], index_data,
+                                    index_data + header.indices.size)) {
+            instance.num_indices = static_cast<std::size_t>(header.index_count);
+            instance.index_type = sizeof(GLushort) == header.index_size ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            instance.lods = file.get_lods();
+            instance.lod = 0u;
+        }
+        return *this;
+    }
+
+    /// Sets per-instance attributes of the `Mesh` being built, which is then drawn once per instance. The attributes
+    /// are detected by their names, e.g. a `glm::mat4 transform` or a `glm::vec4 tint`. Pooled meshes can't be
+    /// instanced.
+    template <typename T> // T models RandomAccessIterator
+    Builder& with_instances(T begin, T end)
+    {
+        if (!instance.pool && lazy_init() &&
+            detail::set_buffer_data(GL_ARRAY_BUFFER, instance.vbo_handle[Instances], begin, end)) {
+            set_up_attributes(instance.vbo_handle[Instances], [] {
+                detail::enable_instance_attributes<typename std::iterator_traits<T>::value_type>();
+            });
+            instance.num_instances = end - begin;
+        }
+        else {
+            // TODO: report the error.
+        }
+        return *this;
+    }
+
+    /// Sets per-instance attributes with the given `container`.
+    template <typename T> // T models ContiguousContainer
+    Builder& with_instances(T const& container)
+    {
+        using std::begin, std::end;
+        return with_instances(begin(container), end(container));
+    }
+
     /// Sets vertices with the given `container`.
     template <typename T> // T models ContiguousContainer
     Builder& with_vertices(T const& container)
@@ -161,7 +532,7 @@ class Mesh::Builder final {
     Builder& with_indices(T const& container)
     {
         using std::begin, std::end;
-        return with_vertices(begin(container), end(container));
+        return with_indices(begin(container), end(container));
     }
 
     /// Sets vertices with the given initializer list.
@@ -180,6 +551,14 @@ class Mesh::Builder final {
         return with_indices(begin(indices), end(indices));
     }
 
+    /// Sets per-instance attributes with the given initializer list.
+    template <typename T>
+    Builder& with_instances(std::initializer_list<T> instances)
+    {
+        using std::begin, std::end;
+        return with_instances(begin(instances), end(instances));
+    }
+
     /// \returns The built `Mesh` instance.
     operator Mesh()
     {
@@ -187,9 +566,52 @@ class Mesh::Builder final {
     }
 
   private:
-    /// Creates `Mesh` VAO unless it has been already created.
+    /// Sets the given 32-bit `indices`, which are narrowed to 16 bits first if `narrow` is `true`. Pools store 32-bit
+    /// indices only.
+    void with_narrowed_indices(std::vector<std::uint32_t> const& indices, bool const narrow)
+    {
+        if (narrow && !instance.pool) {
+            with_indices(std::vector<GLushort>(indices.begin(), indices.end()));
+        }
+        else {
+            with_indices(indices);
+        }
+    }
+
+    /// \returns The target to upload indices to: the element array buffer binding belongs to the VAO, so indices of a
+    /// deferred one are uploaded through another target.
+    GLenum get_index_target() const
+    {
+        return deferred ? GL_COPY_WRITE_BUFFER : GL_ELEMENT_ARRAY_BUFFER;
+    }
+
+    /// Sets the attributes read from the given `vbo` up with the given `setup`, or defers that until the VAO is
+    /// created.
+    template <typename F> // F models void()
+    void set_up_attributes(GLuint const vbo, F setup)
+    {
+        if (!deferred) {
+            detail::bind_buffer(GL_ARRAY_BUFFER, vbo);
+            setup();
+            return;
+        }
+
+        instance.pending_setup = [previous = std::move(instance.pending_setup), vbo, setup] {
+            if (previous) {
+                previous();
+            }
+            detail::bind_buffer(GL_ARRAY_BUFFER, vbo);
+            setup();
+        };
+    }
+
+    /// Creates `Mesh` VAO unless it has been already created, or it's deferred.
     bool lazy_init()
     {
+        if (deferred) {
+            return true;
+        }
+
         auto& vao = instance.vao_handle;
         if (!vao) {
             glGenVertexArrays(1, &vao);
@@ -199,12 +621,15 @@ class Mesh::Builder final {
             }
         }
 
-        glBindVertexArray(vao);
+        detail::bind_vertex_array(vao);
         return true;
     }
 
     /// Holds the `Mesh` instance being built.
     Mesh instance;
+
+    /// Holds a boolean which specifies whether the VAO of the `Mesh` being built is deferred.
+    bool deferred = false;
 };
 
 } // namespace v1
@@ -0,0 +1,466 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <nest/opengl/state_cache.hpp>
+#include <nest/opengl/vertex_layout.hpp>
+
+namespace nest {
+inline namespace v1 {
+namespace detail {
+
+/// A class for allocating ranges of a linear space, e.g. of a buffer. Free ranges are kept in a list sorted by offset,
+/// allocations take the first range that fits, and freed ranges are merged with their free neighbours.
+class RangeAllocator final {
+  public:
+    /// Constructs an allocator of the [0, `capacity`) range.
+    explicit RangeAllocator(std::size_t const capacity = 0u)
+    {
+        reset(capacity, 0u);
+    }
+
+    /// \returns The offset of an allocated range of the given `size`, or nothing if no free range is large enough.
+    std::optional<std::size_t> allocate(std::size_t const size)
+    {
+        auto const it = std::find_if(begin(free_ranges), end(free_ranges),
+                                     [size](auto const& range) { return range.second >= size; });
+        if (end(free_ranges) == it) {
+            return std::nullopt;
+        }
+
+        auto const [offset, free_size] = *it;
+        free_ranges.erase(it);
+        if (free_size > size) {
+            free_ranges.emplace(offset + size, free_size - size);
+        }
+        free_size_total -= size;
+        return offset;
+    }
+
+    /// Frees the range of the given `size` at the given `offset`, which has been allocated before.
+    void free(std::size_t offset, std::size_t size)
+    {
+        if (!size) {
+            return;
+        }
+        free_size_total += size;
+
+        auto next = free_ranges.lower_bound(offset);
+        if (end(free_ranges) != next && offset + size == next->first) {
+            size += next->second;
+            next = free_ranges.erase(next);
+        }
+        if (begin(free_ranges) != next) {
+            if (auto previous = std::prev(next); previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                free_ranges.erase(previous);
+            }
+        }
+        free_ranges.emplace(offset, size);
+    }
+
+    /// Forgets all the allocations but the [0, `used`) range, which is considered allocated.
+    void reset(std::size_t const new_capacity, std::size_t const used)
+    {
+        capacity = new_capacity;
+        free_ranges.clear();
+        if (used < capacity) {
+            free_ranges.emplace(used, capacity - used);
+        }
+        free_size_total = capacity - std::min(used, capacity);
+    }
+
+    /// \returns The size of the allocated space.
+    std::size_t get_capacity() const
+    {
+        return capacity;
+    }
+
+    /// \returns The total size of the free ranges.
+    std::size_t get_free_size() const
+    {
+        return free_size_total;
+    }
+
+    /// \returns The number of free ranges. The larger it is, the more fragmented the space is.
+    std::size_t get_free_range_count() const
+    {
+        return free_ranges.size();
+    }
+
+  private:
+    /// Holds the size of the whole space.
+    std::size_t capacity = 0u;
+
+    /// Holds the total size of the free ranges.
+    std::size_t free_size_total = 0u;
+
+    /// Holds the sizes of the free ranges by their offsets.
+    std::map<std::size_t, std::size_t> free_ranges;
+};
+
+} // namespace detail
+
+/// A class for storing many meshes of the same vertex layout in a few shared buffers.
+///
+/// Every mesh built with `Mesh::Builder::with_pool` gets a range of the pool's vertex buffer, and a range of its index
+/// buffer. All the meshes share the pool's VAO, so drawing them one after another needs no VAO binds, and each draw is
+/// a single `glDrawElementsBaseVertex`. When a range doesn't fit, the pool is defragmented, or grown when there's not
+/// enough free space. Either way the ranges are moved on the GPU, and the meshes pick up their new offsets at the next
+/// draw. The pool must outlive its meshes.
+class MeshPool final {
+  public:
+    class Builder;
+
+    /// Holds the statistics of a `MeshPool`.
+    struct Statistics {
+        std::size_t mesh_count = 0u;
+        std::size_t vertex_capacity = 0u;
+        std::size_t used_vertices = 0u;
+        std::size_t index_capacity = 0u;
+        std::size_t used_indices = 0u;
+
+        /// Holds the number of free ranges of both buffers. The larger it is, the more fragmented the pool is.
+        std::size_t free_range_count = 0u;
+
+        std::size_t defragment_count = 0u;
+        std::size_t grow_count = 0u;
+    };
+
+    /// The location of a mesh in the pool.
+    struct Slot {
+        /// Holds the index of the first vertex of the mesh.
+        std::size_t first_vertex = 0u;
+        std::size_t vertex_count = 0u;
+
+        /// Holds the index of the first index of the mesh.
+        std::size_t first_index = 0u;
+        std::size_t index_count = 0u;
+
+        /// Holds a boolean which specifies whether the slot is used by a mesh.
+        bool used = false;
+    };
+
+    /// Constructs an empty `MeshPool`.
+    MeshPool() noexcept = default;
+
+    MeshPool(MeshPool const&) = delete;
+    MeshPool(MeshPool&& that) noexcept
+    {
+        swap(that);
+    }
+
+    ~MeshPool() noexcept = default;
+
+    MeshPool& operator=(MeshPool const&) = delete;
+    MeshPool& operator=(MeshPool&& that) noexcept
+    {
+        swap(that);
+        return *this;
+    }
+
+    void swap(MeshPool& that) noexcept
+    {
+        std::swap(storage, that.storage);
+    }
+
+    /// \returns `true` when this `MeshPool` is not empty, `false` otherwise.
+    explicit operator bool() const
+    {
+        return nullptr != storage;
+    }
+
+    /// Moves the meshes to the beginning of the buffers, so that the free space becomes a single range.
+    void defragment()
+    {
+        if (storage) {
+            storage->relocate(storage->vertices, storage->vertices.allocator.get_capacity());
+            storage->relocate(storage->indices, storage->indices.allocator.get_capacity());
+            ++storage->statistics.defragment_count;
+        }
+    }
+
+    /// \returns The statistics of the pool.
+    Statistics get_statistics() const
+    {
+        if (!storage) {
+            return {};
+        }
+
+        auto statistics = storage->statistics;
+        statistics.vertex_capacity = storage->vertices.allocator.get_capacity();
+        statistics.used_vertices = statistics.vertex_capacity - storage->vertices.allocator.get_free_size();
+        statistics.index_capacity = storage->indices.allocator.get_capacity();
+        statistics.used_indices = statistics.index_capacity - storage->indices.allocator.get_free_size();
+        statistics.free_range_count =
+            storage->vertices.allocator.get_free_range_count() + storage->indices.allocator.get_free_range_count();
+        return statistics;
+    }
+
+  private:
+    friend class Mesh;
+
+    /// A buffer, which ranges are allocated to meshes.
+    struct Arena {
+        /// Holds the OpenGL name of the buffer.
+        GLuint handle = 0u;
+
+        /// Holds the target the buffer is attached to the VAO with.
+        GLenum target = GL_ARRAY_BUFFER;
+
+        /// Holds the size of an item, i.e. of a vertex or an index, in bytes.
+        std::size_t item_size = 0u;
+
+        /// Holds the allocator of the buffer's items.
+        detail::RangeAllocator allocator;
+    };
+
+    /// The state of the pool, which stays put when the pool is moved, since meshes refer to it.
+    struct Storage {
+        Storage() = default;
+        Storage(Storage const&) = delete;
+        Storage& operator=(Storage const&) = delete;
+
+        ~Storage() noexcept
+        {
+            detail::delete_vertex_arrays(1, &vao_handle);
+            detail::delete_buffers(1, &vertices.handle);
+            detail::delete_buffers(1, &indices.handle);
+        }
+
+        /// \returns The index of a new, empty slot.
+        std::uint32_t create_slot()
+        {
+            ++statistics.mesh_count;
+            if (!free_slots.empty()) {
+                auto const slot = free_slots.back();
+                free_slots.pop_back();
+                slots[slot].used = true;
+                return slot;
+            }
+            slots.push_back({});
+            slots.back().used = true;
+            return static_cast<std::uint32_t>(slots.size() - 1u);
+        }
+
+        /// Frees the given `slot` along with its ranges.
+        void destroy_slot(std::uint32_t const slot)
+        {
+            auto& location = slots[slot];
+            vertices.allocator.free(location.first_vertex, location.vertex_count);
+            indices.allocator.free(location.first_index, location.index_count);
+            location = Slot{};
+            free_slots.push_back(slot);
+            --statistics.mesh_count;
+        }
+
+        /// Uploads `count` items of the given `arena` from the given `data` into the given `slot`, replacing the
+        /// items uploaded before.
+        /// \returns `true` on success, `false` otherwise.
+        bool upload(Arena& arena, std::uint32_t const slot, void const* const data, std::size_t const count)
+        {
+            auto& location = slots[slot];
+            auto [first, num_items] = &arena == &vertices ? std::tie(location.first_vertex, location.vertex_count)
+                                                           : std::tie(location.first_index, location.index_count);
+
+            arena.allocator.free(first, num_items);
+            first = 0u;
+            num_items = 0u;
+
+            auto offset = arena.allocator.allocate(count);
+            if (!offset) {
+                // Compacts the buffer, growing it if compacting won't free enough space.
+                auto const capacity = arena.allocator.get_capacity();
+                auto const used = capacity - arena.allocator.get_free_size();
+                if (used + count > capacity) {
+                    relocate(arena, std::max(2u * capacity, used + count));
+                    ++statistics.grow_count;
+                }
+                else {
+                    relocate(arena, capacity);
+                    ++statistics.defragment_count;
+                }
+                offset = arena.allocator.allocate(count);
+            }
+
+            if (!offset || !arena.handle) {
+                // TODO: report the error.
+                return false;
+            }
+
+            first = *offset;
+            num_items = count;
+
+            detail::bind_buffer(GL_COPY_WRITE_BUFFER, arena.handle);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(first * arena.item_size),
+                            static_cast<GLsizeiptr>(count * arena.item_size), data);
+            return true;
+        }
+
+        /// Moves the ranges of the given `arena` to the beginning of a new buffer of the given `capacity`, and
+        /// attaches the latter to the VAO.
+        void relocate(Arena& arena, std::size_t const capacity)
+        {
+            GLuint handle = 0u;
+            glGenBuffers(1, &handle);
+            if (!handle) {
+                // TODO: report the error.
+                return;
+            }
+
+            detail::bind_buffer(GL_COPY_WRITE_BUFFER, handle);
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity * arena.item_size), nullptr,
+                         GL_STATIC_DRAW);
+
+            // Copies the ranges in the order of their offsets, so the meshes keep their relative order.
+            auto const is_vertices = &arena == &vertices;
+            auto const first_item = [is_vertices](Slot& slot) -> std::size_t& {
+                return is_vertices ? slot.first_vertex : slot.first_index;
+            };
+            auto const item_count = [is_vertices](Slot const& slot) {
+                return is_vertices ? slot.vertex_count : slot.index_count;
+            };
+
+            std::vector<std::uint32_t> order;
+            for (std::uint32_t slot = 0u; slot < slots.size(); ++slot) {
+                if (slots[slot].used && item_count(slots[slot])) {
+                    order.push_back(slot);
+                }
+            }
+            std::sort(begin(order), end(order), [&](auto const a, auto const b) {
+                return first_item(slots[a]) < first_item(slots[b]);
+            });
+
+            if (arena.handle) {
+                detail::bind_buffer(GL_COPY_READ_BUFFER, arena.handle);
+            }
+
+            std::size_t used = 0u;
+            for (auto const slot : order) {
+                auto& first = first_item(slots[slot]);
+                auto const count = item_count(slots[slot]);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                    static_cast<GLintptr>(first * arena.item_size),
+                                    static_cast<GLintptr>(used * arena.item_size),
+                                    static_cast<GLsizeiptr>(count * arena.item_size));
+                first = used;
+                used += count;
+            }
+
+            // The GPU keeps the old buffer alive while it's still in use.
+            detail::delete_buffers(1, &arena.handle);
+            arena.handle = handle;
+            arena.allocator.reset(capacity, used);
+
+            detail::bind_vertex_array(vao_handle);
+            detail::bind_buffer(arena.target, arena.handle);
+            if (GL_ARRAY_BUFFER == arena.target) {
+                enable_attributes();
+            }
+        }
+
+        /// Holds the OpenGL name of the VAO shared by the meshes.
+        GLuint vao_handle = 0u;
+
+        /// Holds the buffer of vertices.
+        Arena vertices;
+
+        /// Holds the buffer of indices.
+        Arena indices;
+
+        /// Holds the function, which enables the vertex attributes of the pool's layout.
+        void (*enable_attributes)() = nullptr;
+
+        /// Holds the locations of the meshes.
+        std::vector<Slot> slots;
+
+        /// Holds the indices of the unused slots.
+        std::vector<std::uint32_t> free_slots;
+
+        /// Holds the statistics.
+        Statistics statistics;
+    };
+
+    /// Holds the state of the pool.
+    std::unique_ptr<Storage> storage;
+};
+
+/// A class for building instances of `MeshPool`.
+class MeshPool::Builder final {
+  public:
+    /// Specifies the type of vertices of the meshes stored in the pool.
+    template <typename Vertex>
+    Builder& with_layout()
+    {
+        vertex_size = sizeof(Vertex);
+        enable_attributes = detail::enable_attributes<Vertex>;
+        return *this;
+    }
+
+    /// Specifies the initial number of vertices and indices the pool can store. The pool grows when they run out.
+    Builder& with_capacity(std::size_t const num_vertices, std::size_t const num_indices)
+    {
+        vertex_capacity = num_vertices;
+        index_capacity = num_indices;
+        return *this;
+    }
+
+    /// \returns The built `MeshPool` instance.
+    operator MeshPool()
+    {
+        if (!enable_attributes) {
+            // TODO: report the error, the layout is not specified.
+            return {};
+        }
+
+        auto storage = std::make_unique<Storage>();
+
+        glGenVertexArrays(1, &storage->vao_handle);
+        if (!storage->vao_handle) {
+            // TODO: report the error.
+            return {};
+        }
+
+        storage->enable_attributes = enable_attributes;
+        storage->vertices.target = GL_ARRAY_BUFFER;
+        storage->vertices.item_size = vertex_size;
+        storage->indices.target = GL_ELEMENT_ARRAY_BUFFER;
+        storage->indices.item_size = sizeof(GLuint);
+
+        storage->relocate(storage->vertices, vertex_capacity);
+        storage->relocate(storage->indices, index_capacity);
+
+        MeshPool pool;
+        pool.storage = std::move(storage);
+        return pool;
+    }
+
+  private:
+    /// Holds the size of a vertex in bytes.
+    std::size_t vertex_size = 0u;
+
+    /// Holds the function, which enables the vertex attributes.
+    void (*enable_attributes)() = nullptr;
+
+    // clang-format off
+    /// Hold the initial capacity of the pool being built.
+    /// @{
+    std::size_t vertex_capacity = 65'536u;
+    std::size_t index_capacity  = 196'608u;
+    /// @}
+    // clang-format on
+};
+
+} // namespace v1
+} // namespace nest
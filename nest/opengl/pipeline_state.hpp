@@ -0,0 +1,351 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+#include <nest/opengl/program_cache.hpp>
+#include <nest/opengl/shader_program.hpp>
+#include <nest/opengl/state_cache.hpp>
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Represents the id of an interned `PipelineState`, see `PipelineRegistry`. It fits the program field of a `SortKey`.
+using PipelineId = std::uint16_t;
+
+namespace detail {
+
+/// \returns A key, which identifies the vertex layout of the given `Vertex` type: its size and the attributes it has.
+template <typename Vertex>
+constexpr std::uint32_t get_vertex_layout_key()
+{
+    // clang-format off
+    return static_cast<std::uint32_t>(sizeof(Vertex) << 8u)
+         | (has_position<Vertex>  ? 0x01u : 0u)
+         | (has_color<Vertex>     ? 0x02u : 0u)
+         | (has_texcoord<Vertex>  ? 0x04u : 0u)
+         | (has_transform<Vertex> ? 0x08u : 0u)
+         | (has_tint<Vertex>      ? 0x10u : 0u);
+    // clang-format on
+}
+
+} // namespace detail
+
+/// An immutable bundle of the state a draw needs: the shader program, the vertex layout, and the fixed-function state,
+/// i.e. blending, depth and stencil tests, face culling, and the viewport.
+///
+/// States are built with `PipelineState::Builder`, which starts from the OpenGL defaults: all the tests and blending
+/// disabled, depth and stencil writes enabled, and the viewport left as it is. `apply()` sets the state through the
+/// current `StateCache`, so only the parts which differ from the current state reach the driver.
+///
+/// The program is referenced by its handle, so it must outlive the state. The vertex layout only identifies the
+/// vertices the state is meant for: meshes keep their attributes in their own vertex array objects.
+class PipelineState final {
+  public:
+    class Builder;
+
+    /// Hashes states, e.g. for keeping them in an `std::unordered_map`.
+    struct Hash {
+        std::size_t operator()(PipelineState const& state) const noexcept
+        {
+            return static_cast<std::size_t>(state.get_hash());
+        }
+    };
+
+    /// \returns The handle of the shader program.
+    GLuint get_program() const noexcept
+    {
+        return program;
+    }
+
+    /// \returns The key of the vertex layout, or 0 if the state is not bound to any.
+    std::uint32_t get_vertex_layout() const noexcept
+    {
+        return vertex_layout;
+    }
+
+    /// \returns The hash of the state.
+    std::uint64_t get_hash() const noexcept
+    {
+        auto const fields = get_fields();
+        return detail::hash_bytes(std::string_view(reinterpret_cast<char const*>(fields.data()), sizeof(fields)));
+    }
+
+    bool operator==(PipelineState const& that) const noexcept
+    {
+        return get_fields() == that.get_fields();
+    }
+
+    bool operator!=(PipelineState const& that) const noexcept
+    {
+        return !(*this == that);
+    }
+
+    /// Sets the state through the current `StateCache`, which skips the calls not changing anything. The parameters of
+    /// disabled tests and blending are left as they are.
+    void apply() const
+    {
+        auto const cache = StateCache::current();
+        if (!cache) {
+            // TODO: report the error.
+            return;
+        }
+
+        cache->use_program(program);
+
+        cache->set_capability(GL_BLEND, blend);
+        if (blend) {
+            cache->blend_func(blend_source, blend_destination);
+        }
+
+        cache->set_capability(GL_DEPTH_TEST, depth_test);
+        if (depth_test) {
+            cache->depth_func(depth_function);
+        }
+        // The write masks apply to clearing as well, so they are set whether the tests are enabled or not.
+        cache->depth_mask(depth_write ? GL_TRUE : GL_FALSE);
+
+        cache->set_capability(GL_STENCIL_TEST, stencil_test);
+        if (stencil_test) {
+            cache->stencil_func(stencil_function, stencil_reference, stencil_mask);
+            cache->stencil_op(stencil_fail, stencil_depth_fail, stencil_pass);
+        }
+        cache->stencil_mask(stencil_write_mask);
+
+        cache->set_capability(GL_CULL_FACE, cull);
+        if (cull) {
+            cache->cull_face(cull_face);
+        }
+
+        if (0 != viewport[2] && 0 != viewport[3]) {
+            cache->viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        }
+    }
+
+  private:
+    /// \returns All the fields of the state, which identify it.
+    std::array<std::uint32_t, 22u> get_fields() const noexcept
+    {
+        // clang-format off
+        return {{
+            program,              vertex_layout,
+            blend,                blend_source,        blend_destination,
+            depth_test,           depth_write,         depth_function,
+            stencil_test,         stencil_function,    static_cast<std::uint32_t>(stencil_reference), stencil_mask,
+            stencil_fail,         stencil_depth_fail,  stencil_pass,        stencil_write_mask,
+            cull,                 cull_face,
+            static_cast<std::uint32_t>(viewport[0]),   static_cast<std::uint32_t>(viewport[1]),
+            static_cast<std::uint32_t>(viewport[2]),   static_cast<std::uint32_t>(viewport[3]),
+        }};
+        // clang-format on
+    }
+
+    /// Holds the handle of the shader program.
+    GLuint program = 0u;
+
+    /// Holds the key of the vertex layout, see `detail::get_vertex_layout_key`.
+    std::uint32_t vertex_layout = 0u;
+
+    /// Hold the blending state.
+    /// @{
+    bool blend = false;
+    GLenum blend_source = GL_ONE;
+    GLenum blend_destination = GL_ZERO;
+    /// @}
+
+    /// Hold the depth test state.
+    /// @{
+    bool depth_test = false;
+    bool depth_write = true;
+    GLenum depth_function = GL_LESS;
+    /// @}
+
+    /// Hold the stencil test state.
+    /// @{
+    bool stencil_test = false;
+    GLenum stencil_function = GL_ALWAYS;
+    GLint stencil_reference = 0;
+    GLuint stencil_mask = ~0u;
+    GLenum stencil_fail = GL_KEEP;
+    GLenum stencil_depth_fail = GL_KEEP;
+    GLenum stencil_pass = GL_KEEP;
+    GLuint stencil_write_mask = ~0u;
+    /// @}
+
+    /// Hold the face culling state.
+    /// @{
+    bool cull = false;
+    GLenum cull_face = GL_BACK;
+    /// @}
+
+    /// Holds the viewport's x, y, width, and height. An empty viewport is left as it is.
+    std::array<GLint, 4u> viewport = {0, 0, 0, 0};
+};
+
+/// A class for building instances of `PipelineState`.
+class PipelineState::Builder final {
+  public:
+    /// Sets the shader `program` the state draws with.
+    Builder& with_program(ShaderProgram const& program)
+    {
+        instance.program = program.get_handle();
+        return *this;
+    }
+
+    /// Sets the vertex layout of the given `Vertex` type, which the state draws.
+    template <typename Vertex>
+    Builder& with_vertex_layout()
+    {
+        instance.vertex_layout = detail::get_vertex_layout_key<Vertex>();
+        return *this;
+    }
+
+    /// Enables blending with the given `source` and `destination` factors, see `glBlendFunc`.
+    Builder& with_blending(GLenum const source, GLenum const destination)
+    {
+        instance.blend = true;
+        instance.blend_source = source;
+        instance.blend_destination = destination;
+        return *this;
+    }
+
+    /// Enables the depth test with the given comparison `function`, see `glDepthFunc`. The depth buffer is written
+    /// unless `write` is `false`.
+    Builder& with_depth_test(GLenum const function = GL_LESS, bool const write = true)
+    {
+        instance.depth_test = true;
+        instance.depth_function = function;
+        instance.depth_write = write;
+        return *this;
+    }
+
+    /// Enables the stencil test with the given comparison `function`, `reference` value and `mask`, see
+    /// `glStencilFunc`, and the given operations, see `glStencilOp`.
+    Builder& with_stencil_test(GLenum const function, GLint const reference, GLuint const mask = ~0u,
+                               GLenum const fail = GL_KEEP, GLenum const depth_fail = GL_KEEP,
+                               GLenum const pass = GL_KEEP)
+    {
+        instance.stencil_test = true;
+        instance.stencil_function = function;
+        instance.stencil_reference = reference;
+        instance.stencil_mask = mask;
+        instance.stencil_fail = fail;
+        instance.stencil_depth_fail = depth_fail;
+        instance.stencil_pass = pass;
+        return *this;
+    }
+
+    /// Sets the `mask` of the stencil bits, which are written, see `glStencilMask`.
+    Builder& with_stencil_write_mask(GLuint const mask)
+    {
+        instance.stencil_write_mask = mask;
+        return *this;
+    }
+
+    /// Enables culling of the given `face`, see `glCullFace`.
+    Builder& with_culling(GLenum const face = GL_BACK)
+    {
+        instance.cull = true;
+        instance.cull_face = face;
+        return *this;
+    }
+
+    /// Sets the viewport, see `glViewport`.
+    Builder& with_viewport(GLint const x, GLint const y, GLsizei const width, GLsizei const height)
+    {
+        instance.viewport = {x, y, width, height};
+        return *this;
+    }
+
+    /// \returns The built `PipelineState` instance.
+    operator PipelineState() const
+    {
+        return instance;
+    }
+
+  private:
+    /// Holds the `PipelineState` instance being built.
+    PipelineState instance;
+};
+
+/// A class for interning pipeline states, so that identical states share one id. Draw commands carry the id rather
+/// than the state, and may use it as the program of their `SortKey`, which groups together draws sharing all of their
+/// state.
+///
+/// The id 0 stands for the default state, see `PipelineState::Builder`. Interning is thread-safe, so commands may be
+/// recorded on several threads.
+class PipelineRegistry final {
+  public:
+    /// Holds the maximum number of states, including the default one.
+    static constexpr std::size_t MaxStateCount = std::size_t{1u} << (8u * sizeof(PipelineId));
+
+    /// Constructs a registry, which holds the default state only.
+    PipelineRegistry()
+    {
+        intern(PipelineState{});
+    }
+
+    PipelineRegistry(PipelineRegistry const&) = delete;
+    PipelineRegistry& operator=(PipelineRegistry const&) = delete;
+
+    /// \returns The id of the given `state`, which is the one of an identical state interned before, if any. Returns
+    /// the id of the default state if the registry is full.
+    PipelineId intern(PipelineState const& state)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto const it = ids.find(state); ids.end() != it) {
+            return it->second;
+        }
+        if (states.size() == MaxStateCount) {
+            // TODO: report the error.
+            return 0u;
+        }
+
+        auto const id = static_cast<PipelineId>(states.size());
+        states.push_back(state);
+        ids.emplace(state, id);
+        return id;
+    }
+
+    /// \returns The state of the given `id`, which must have been returned by `intern`.
+    PipelineState const& get(PipelineId const id) const
+    {
+        // The states are never moved, since a deque doesn't relocate its elements when growing at its end.
+        std::lock_guard<std::mutex> lock(mutex);
+        return states[id];
+    }
+
+    /// Sets the state of the given `id`. See `PipelineState::apply`.
+    void apply(PipelineId const id) const
+    {
+        get(id).apply();
+    }
+
+    /// \returns The number of interned states, including the default one.
+    std::size_t get_size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return states.size();
+    }
+
+  private:
+    /// Guards the states and their ids.
+    mutable std::mutex mutex;
+
+    /// Holds the interned states in the order of their ids.
+    std::deque<PipelineState> states;
+
+    /// Holds the ids of the interned states.
+    std::unordered_map<PipelineState, PipelineId, PipelineState::Hash> ids;
+};
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <GL/glew.h>
+
+namespace nest {
+inline namespace v1 {
+
+namespace detail {
+
+/// \returns The 64-bit FNV-1a hash of the given `bytes`, which continues the given `hash`.
+inline std::uint64_t hash_bytes(std::string_view const bytes, std::uint64_t hash = 14695981039346656037ull)
+{
+    for (auto const byte : bytes) {
+        hash = (hash ^ static_cast<unsigned char>(byte)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/// \returns The id of the calling process.
+inline unsigned long get_process_id()
+{
+#if defined(_WIN32)
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(getpid());
+#endif
+}
+
+/// \returns The given OpenGL string, or an empty string if there is no such string.
+inline std::string_view get_gl_string(GLenum const name)
+{
+    auto const string = reinterpret_cast<char const*>(glGetString(name));
+    return string ? std::string_view(string) : std::string_view();
+}
+
+} // namespace detail
+
+/// A class for caching linked shader programs on disk, so they are loaded with `glProgramBinary` rather than compiled
+/// on the next launch. See `ShaderProgram::Builder::with_cache`.
+///
+/// Entries are keyed by a hash of the sources of a program, which include its defines, and of the vendor, renderer,
+/// and version strings of the driver. An update of the driver makes all the entries stale, so they are removed when
+/// the cache is constructed. Entries are written to a temporary file first, which is then renamed, so a crash never
+/// leaves a torn entry behind. Binaries rejected by the driver are removed, and the program is compiled instead.
+///
+/// The cache may be used on several threads at once.
+class ProgramCache final {
+  public:
+    /// Holds the statistics of the cache.
+    struct Statistics {
+        /// Holds the number of programs loaded from the cache.
+        std::size_t hits = 0u;
+
+        /// Holds the number of programs, which were not found in the cache.
+        std::size_t misses = 0u;
+
+        /// Holds the number of entries, which were corrupted or rejected by the driver.
+        std::size_t rejections = 0u;
+
+        /// Holds the number of entries written.
+        std::size_t writes = 0u;
+    };
+
+    /// Constructs a cache of the entries in the given `directory`, which is created if it doesn't exist. A context must
+    /// be current on the calling thread. Removes the entries written by another driver.
+    explicit ProgramCache(std::filesystem::path directory) : directory(std::move(directory))
+    {
+        GLint num_formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+        supported = num_formats > 0;
+
+        std::ostringstream driver;
+        driver << detail::get_gl_string(GL_VENDOR) << "\n"
+               << detail::get_gl_string(GL_RENDERER) << "\n"
+               << detail::get_gl_string(GL_VERSION) << "\n"
+               << detail::get_gl_string(GL_SHADING_LANGUAGE_VERSION) << "\n";
+        driver_hash = detail::hash_bytes(driver.str());
+
+        std::error_code error;
+        std::filesystem::create_directories(this->directory, error);
+        if (error) {
+            // TODO: report the error.
+            supported = false;
+            return;
+        }
+
+        // The driver file names the driver, which wrote the entries.
+        auto const driver_path = this->directory / "driver";
+        std::ostringstream stored;
+        stored << std::ifstream(driver_path, std::ios::binary).rdbuf();
+        if (stored.str() != driver.str()) {
+            clear();
+            std::ofstream(driver_path, std::ios::binary) << driver.str();
+        }
+    }
+
+    ProgramCache(ProgramCache const&) = delete;
+    ProgramCache& operator=(ProgramCache const&) = delete;
+
+    /// \returns `true` when the driver can save program binaries, `false` otherwise. The cache does nothing otherwise.
+    bool is_supported() const
+    {
+        return supported;
+    }
+
+    /// \returns The key of a program of the given sources, which takes the driver into account.
+    std::uint64_t get_key(std::initializer_list<std::string_view> const sources) const
+    {
+        auto hash = driver_hash;
+        for (auto const& source : sources) {
+            // Hashes the sizes as well, so that moving text from one source into another changes the key.
+            auto const size = static_cast<std::uint64_t>(source.size());
+            hash = detail::hash_bytes(std::string_view(reinterpret_cast<char const*>(&size), sizeof(size)), hash);
+            hash = detail::hash_bytes(source, hash);
+        }
+        return hash;
+    }
+
+    /// Loads the entry of the given `key` into the given `program`, and checks that the driver accepted it.
+    /// \returns `true` when the `program` is linked, `false` if there is no such entry, or it was rejected. In the
+    /// latter case the entry is removed, and the `program` must be deleted.
+    bool load(std::uint64_t const key, GLuint const program)
+    {
+        if (!supported) {
+            return false;
+        }
+
+        auto const path = get_path(key);
+        std::ifstream file(path, std::ios::binary);
+        EntryHeader header = {};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            misses.fetch_add(1u);
+            return false;
+        }
+
+        // The size is checked against the file, so a truncated or corrupted entry can't make the binary huge.
+        std::error_code error;
+        auto const file_size = std::filesystem::file_size(path, error);
+        auto const valid = !error && 0 == std::memcmp(header.magic, EntryHeader::Magic, sizeof(header.magic)) &&
+                           key == header.key && header.size <= MaxBinarySize &&
+                           header.size == file_size - sizeof(header);
+
+        std::vector<char> binary;
+        if (valid) {
+            binary.resize(static_cast<std::size_t>(header.size));
+            file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+        }
+
+        GLint status = GL_FALSE;
+        if (!binary.empty() && file) {
+            glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+        }
+        if (GL_FALSE == status) {
+            rejections.fetch_add(1u);
+            file.close();
+
+            std::filesystem::remove(path, error);
+            return false;
+        }
+
+        hits.fetch_add(1u);
+        return true;
+    }
+
+    /// Stores the binary of the given linked `program` as the entry of the given `key`. The program must have been
+    /// linked with `GL_PROGRAM_BINARY_RETRIEVABLE_HINT` set.
+    void store(std::uint64_t const key, GLuint const program)
+    {
+        if (!supported) {
+            return;
+        }
+
+        GLint size = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+        if (size <= 0) {
+            // TODO: report the error.
+            return;
+        }
+
+        EntryHeader header = {};
+        std::memcpy(header.magic, EntryHeader::Magic, sizeof(header.magic));
+        header.key = key;
+
+        std::vector<char> binary(static_cast<std::size_t>(size));
+        GLsizei length = 0;
+        glGetProgramBinary(program, size, &length, &header.format, binary.data());
+        header.size = static_cast<std::uint64_t>(length);
+
+        // Every writer, be it another thread or another process sharing the directory, has a temporary file of its
+        // own, and the rename replaces the entry at once.
+        auto const path = get_path(key);
+        auto temporary = path;
+        temporary += "." + std::to_string(detail::get_process_id()) + "." +
+                     std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            file.write(binary.data(), length);
+            if (!file) {
+                // TODO: report the error.
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            // TODO: report the error.
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+        writes.fetch_add(1u);
+    }
+
+    /// Removes all the entries.
+    void clear()
+    {
+        std::error_code error;
+        for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            if (EntryExtension == it->path().extension() || ".tmp" == it->path().extension()) {
+                std::filesystem::remove(it->path(), error);
+            }
+        }
+    }
+
+    /// \returns The statistics of the cache.
+    Statistics get_statistics() const
+    {
+        return {hits.load(), misses.load(), rejections.load(), writes.load()};
+    }
+
+  private:
+    /// The header, which every entry begins with. It's followed by the binary of the program.
+    struct EntryHeader {
+        static constexpr char Magic[8] = {'N', 'E', 'S', 'T', 'P', 'B', 'I', 'N'};
+
+        char magic[8];
+        GLenum format;
+        std::uint64_t key;
+        std::uint64_t size;
+    };
+
+    /// Holds the maximum size of a binary in bytes. Larger entries are deemed corrupted.
+    static constexpr std::uint64_t MaxBinarySize = 64u * 1024u * 1024u;
+
+    /// Holds the extension of the files of entries.
+    static constexpr char const* EntryExtension = ".bin";
+
+    /// \returns The path of the entry of the given `key`.
+    std::filesystem::path get_path(std::uint64_t const key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(key), EntryExtension);
+        return directory / name;
+    }
+
+    /// Holds the directory of the entries.
+    std::filesystem::path directory;
+
+    /// Holds the hash of the strings, which identify the driver.
+    std::uint64_t driver_hash = 0u;
+
+    /// Holds a boolean which specifies whether the driver can save program binaries.
+    bool supported = false;
+
+    /// Hold the statistics of the cache.
+    /// @{
+    std::atomic<std::size_t> hits{0u};
+    std::atomic<std::size_t> misses{0u};
+    std::atomic<std::size_t> rejections{0u};
+    std::atomic<std::size_t> writes{0u};
+    /// @}
+};
+
+} // namespace v1
+} // namespace nest
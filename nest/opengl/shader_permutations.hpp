@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nest/opengl/program_cache.hpp>
+#include <nest/opengl/shader_program.hpp>
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for managing the variants of a shader program, which share the sources, and differ in the features they
+/// enable, e.g. color or texture coordinates input, or skinning.
+///
+/// Features are declared keywords. A variant defines the keywords of its features as macros, so the sources select the
+/// code of a feature with `#ifdef`. Variants are identified by a mask of their features, which has a bit per keyword in
+/// the order of declaration. A variant is compiled the first time it's used, or ahead of time from a manifest of the
+/// variants used by a previous run, so the cross-product of the features is never compiled.
+class ShaderPermutations final {
+  public:
+    class Builder;
+
+    /// Represents a mask of the features of a variant.
+    using Mask = std::uint32_t;
+
+    /// Holds the maximum number of features.
+    static constexpr std::size_t MaxFeatureCount = 32u;
+
+    /// Hold the keywords, which are enabled for a `Vertex` type having the corresponding attribute. See `get_mask`.
+    /// @{
+    static constexpr std::string_view ColorFeature = "HAS_COLOR";
+    static constexpr std::string_view TexcoordFeature = "HAS_TEXCOORD";
+    /// @}
+
+    ShaderPermutations() = default;
+
+    ShaderPermutations(ShaderPermutations const&) = delete;
+    ShaderPermutations(ShaderPermutations&&) = default;
+
+    ShaderPermutations& operator=(ShaderPermutations const&) = delete;
+    ShaderPermutations& operator=(ShaderPermutations&&) = default;
+
+    /// \returns The mask of the given `features`. Keywords, which were not declared, are ignored.
+    Mask get_mask(std::initializer_list<std::string_view> const features) const
+    {
+        Mask mask = 0u;
+        for (auto const& feature : features) {
+            mask |= get_bit(feature);
+        }
+        return mask;
+    }
+
+    /// \returns The mask of the features offered by the attributes of the given `Vertex` type: `ColorFeature` when it
+    /// has a color, and `TexcoordFeature` when it has texture coordinates, if they were declared.
+    template <typename Vertex>
+    Mask get_mask() const
+    {
+        Mask mask = 0u;
+        if constexpr (has_color<Vertex>) {
+            mask |= get_bit(ColorFeature);
+        }
+        if constexpr (has_texcoord<Vertex>) {
+            mask |= get_bit(TexcoordFeature);
+        }
+        return mask;
+    }
+
+    /// \returns The variant of the given features `mask`, which is compiled unless it was used before. Waits for the
+    /// variant if it's being compiled ahead of time. The returned variant is empty if it failed to compile or link.
+    ShaderProgram& get(Mask mask)
+    {
+        mask &= get_valid_mask();
+        if (auto const it = variants.find(mask); variants.end() != it) {
+            return it->second;
+        }
+
+        ShaderProgram variant;
+        if (auto const it = pending.find(mask); pending.end() != it) {
+            variant = it->second.get();
+            pending.erase(it);
+        }
+        else {
+            variant = make_builder(mask);
+        }
+        return variants.emplace(mask, std::move(variant)).first->second;
+    }
+
+    /// \returns The variant of the features offered by the given `Vertex` type. See `get_mask`.
+    template <typename Vertex>
+    ShaderProgram& get()
+    {
+        return get(get_mask<Vertex>());
+    }
+
+    /// Submits the variants listed in the given `manifest` for compilation without waiting for them, see
+    /// `ShaderProgram::Builder::build_async`. Every line lists the keywords of a variant separated by spaces, `-`
+    /// stands for the variant without features. Unknown keywords are ignored.
+    /// \returns The number of submitted variants, which excludes the ones compiled or submitted before.
+    std::size_t prepare(std::string_view const manifest)
+    {
+        std::size_t count = 0u;
+        for (std::size_t begin = 0u; begin < manifest.size();) {
+            auto end = manifest.find('\n', begin);
+            end = std::string_view::npos == end ? manifest.size() : end;
+            auto const line = manifest.substr(begin, end - begin);
+            begin = end + 1u;
+
+            Mask mask = 0u;
+            auto has_keywords = false;
+            for (std::size_t word = 0u; word < line.size();) {
+                auto const word_end = std::min(line.find_first_of(" \t\r", word), line.size());
+                if (word_end != word) {
+                    auto const keyword = line.substr(word, word_end - word);
+                    mask |= "-" == keyword ? 0u : get_bit(keyword);
+                    has_keywords = true;
+                }
+                word = word_end + 1u;
+            }
+
+            if (has_keywords && !variants.count(mask) && !pending.count(mask)) {
+                pending.emplace(mask, make_builder(mask).build_async());
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    /// \returns The manifest of the variants used or submitted so far, which `prepare` reads. Save it on exit, so that
+    /// the next run compiles the variants ahead of time.
+    std::string get_manifest() const
+    {
+        std::vector<Mask> masks;
+        for (auto const& variant : variants) {
+            masks.push_back(variant.first);
+        }
+        for (auto const& variant : pending) {
+            masks.push_back(variant.first);
+        }
+        std::sort(masks.begin(), masks.end());
+
+        std::string manifest;
+        for (auto const mask : masks) {
+            std::string line;
+            for (std::size_t i = 0u; i < features.size(); ++i) {
+                if (mask & (Mask{1u} << i)) {
+                    line.append(line.empty() ? "" : " ").append(features[i]);
+                }
+            }
+            manifest.append(line.empty() ? "-" : line).append("\n");
+        }
+        return manifest;
+    }
+
+    /// \returns The number of variants used or submitted so far.
+    std::size_t get_variant_count() const
+    {
+        return variants.size() + pending.size();
+    }
+
+  private:
+    /// \returns The bit of the given `feature` keyword in a mask, or 0 if it was not declared.
+    Mask get_bit(std::string_view const feature) const
+    {
+        auto const it = std::find(features.begin(), features.end(), feature);
+        return features.end() == it ? 0u : Mask{1u} << static_cast<std::size_t>(it - features.begin());
+    }
+
+    /// \returns The mask of all the declared features.
+    Mask get_valid_mask() const
+    {
+        return features.size() < MaxFeatureCount ? (Mask{1u} << features.size()) - 1u : ~Mask{0u};
+    }
+
+    /// \returns A builder of the variant of the given features `mask`.
+    ShaderProgram::Builder make_builder(Mask const mask) const
+    {
+        ShaderProgram::Builder builder;
+        builder.with_vertex_shader(vertex_source).with_fragment_shader(fragment_source);
+        for (std::size_t i = 0u; i < features.size(); ++i) {
+            if (mask & (Mask{1u} << i)) {
+                builder.with_define(features[i]);
+            }
+        }
+        if (cache) {
+            builder.with_cache(*cache);
+        }
+        return builder;
+    }
+
+    /// Hold the sources of the shaders.
+    /// @{
+    std::string vertex_source;
+    std::string fragment_source;
+    /// @}
+
+    /// Holds the declared feature keywords, the one of the lowest bit first.
+    std::vector<std::string> features;
+
+    /// Holds the cache of programs, or `nullptr`.
+    ProgramCache* cache = nullptr;
+
+    /// Holds the compiled variants.
+    std::unordered_map<Mask, ShaderProgram> variants;
+
+    /// Holds the variants being compiled ahead of time.
+    std::unordered_map<Mask, PendingShaderProgram> pending;
+};
+
+/// A class for building instances of `ShaderPermutations`. Building compiles no variants.
+class ShaderPermutations::Builder final {
+  public:
+    /// Sets the `source` of the vertex shader of every variant.
+    Builder& with_vertex_shader(std::string_view const& source)
+    {
+        instance.vertex_source = source;
+        return *this;
+    }
+
+    /// Sets the `source` of the fragment shader of every variant.
+    Builder& with_fragment_shader(std::string_view const& source)
+    {
+        instance.fragment_source = source;
+        return *this;
+    }
+
+    /// Declares a feature of the given `keyword`, which gets the next bit of masks.
+    Builder& with_feature(std::string_view const& keyword)
+    {
+        if (instance.features.size() < MaxFeatureCount) {
+            instance.features.emplace_back(keyword);
+        }
+        else {
+            // TODO: report the error.
+        }
+        return *this;
+    }
+
+    /// Loads the variants from the given `cache`, and stores them there. The cache must outlive the instance.
+    Builder& with_cache(ProgramCache& cache)
+    {
+        instance.cache = &cache;
+        return *this;
+    }
+
+    /// \returns The built `ShaderPermutations` instance.
+    operator ShaderPermutations()
+    {
+        return std::move(instance);
+    }
+
+  private:
+    /// Holds the `ShaderPermutations` instance being built.
+    ShaderPermutations instance;
+};
+
+} // namespace v1
+} // namespace nest
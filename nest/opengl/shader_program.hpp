@@ -1,13 +1,185 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <nest/opengl/program_cache.hpp>
+#include <nest/opengl/state_cache.hpp>
+#include <nest/opengl/std140.hpp>
 
 namespace nest {
 inline namespace v1 {
 
+/// Holds the OpenGL type of a uniform of the given type `T`, or 0 if uniforms can't be of this type.
+/// @{
+// clang-format off
+template<typename T> static constexpr GLenum uniform_type = 0u;
+
+template<>           constexpr GLenum uniform_type<GLfloat>    = GL_FLOAT;
+template<>           constexpr GLenum uniform_type<GLint>      = GL_INT;
+template<>           constexpr GLenum uniform_type<GLuint>     = GL_UNSIGNED_INT;
+template<>           constexpr GLenum uniform_type<glm::vec2>  = GL_FLOAT_VEC2;
+template<>           constexpr GLenum uniform_type<glm::vec3>  = GL_FLOAT_VEC3;
+template<>           constexpr GLenum uniform_type<glm::vec4>  = GL_FLOAT_VEC4;
+template<>           constexpr GLenum uniform_type<glm::ivec2> = GL_INT_VEC2;
+template<>           constexpr GLenum uniform_type<glm::ivec3> = GL_INT_VEC3;
+template<>           constexpr GLenum uniform_type<glm::ivec4> = GL_INT_VEC4;
+template<>           constexpr GLenum uniform_type<glm::uvec2> = GL_UNSIGNED_INT_VEC2;
+template<>           constexpr GLenum uniform_type<glm::uvec3> = GL_UNSIGNED_INT_VEC3;
+template<>           constexpr GLenum uniform_type<glm::uvec4> = GL_UNSIGNED_INT_VEC4;
+template<>           constexpr GLenum uniform_type<glm::mat3>  = GL_FLOAT_MAT3;
+template<>           constexpr GLenum uniform_type<glm::mat4>  = GL_FLOAT_MAT4;
+// clang-format on
+/// @}
+
+namespace detail {
+
+/// Sets `count` values of the uniform at the given `location` of the given `program`, which needn't be in use.
+template <typename T>
+void set_uniform(GLuint const program, GLint const location, GLsizei const count, T const* const values)
+{
+    auto const floats = reinterpret_cast<GLfloat const*>(values);
+    auto const ints = reinterpret_cast<GLint const*>(values);
+    auto const uints = reinterpret_cast<GLuint const*>(values);
+
+    if constexpr (std::is_same_v<T, GLfloat>) {
+        glProgramUniform1fv(program, location, count, floats);
+    }
+    else if constexpr (std::is_same_v<T, glm::vec2>) {
+        glProgramUniform2fv(program, location, count, floats);
+    }
+    else if constexpr (std::is_same_v<T, glm::vec3>) {
+        glProgramUniform3fv(program, location, count, floats);
+    }
+    else if constexpr (std::is_same_v<T, glm::vec4>) {
+        glProgramUniform4fv(program, location, count, floats);
+    }
+    else if constexpr (std::is_same_v<T, GLint>) {
+        glProgramUniform1iv(program, location, count, ints);
+    }
+    else if constexpr (std::is_same_v<T, glm::ivec2>) {
+        glProgramUniform2iv(program, location, count, ints);
+    }
+    else if constexpr (std::is_same_v<T, glm::ivec3>) {
+        glProgramUniform3iv(program, location, count, ints);
+    }
+    else if constexpr (std::is_same_v<T, glm::ivec4>) {
+        glProgramUniform4iv(program, location, count, ints);
+    }
+    else if constexpr (std::is_same_v<T, GLuint>) {
+        glProgramUniform1uiv(program, location, count, uints);
+    }
+    else if constexpr (std::is_same_v<T, glm::uvec2>) {
+        glProgramUniform2uiv(program, location, count, uints);
+    }
+    else if constexpr (std::is_same_v<T, glm::uvec3>) {
+        glProgramUniform3uiv(program, location, count, uints);
+    }
+    else if constexpr (std::is_same_v<T, glm::uvec4>) {
+        glProgramUniform4uiv(program, location, count, uints);
+    }
+    else if constexpr (std::is_same_v<T, glm::mat3>) {
+        glProgramUniformMatrix3fv(program, location, count, GL_FALSE, floats);
+    }
+    else if constexpr (std::is_same_v<T, glm::mat4>) {
+        glProgramUniformMatrix4fv(program, location, count, GL_FALSE, floats);
+    }
+}
+
+/// \returns `true` when the given `type` of a uniform is a sampler, which is set with a `GLint`, `false` otherwise.
+inline bool is_sampler(GLenum const type)
+{
+    switch (type) {
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// \returns The given `name` of a uniform without the `[0]` suffix of arrays.
+inline std::string_view trim_array_suffix(std::string_view const name)
+{
+    constexpr std::string_view suffix = "[0]";
+    if (name.size() > suffix.size() && suffix == name.substr(name.size() - suffix.size())) {
+        return name.substr(0u, name.size() - suffix.size());
+    }
+    return name;
+}
+
+/// Describes an active uniform of a shader program, which is not a member of a uniform block.
+struct ActiveUniform final {
+    /// Holds the name of the uniform, arrays are named without the `[0]` suffix.
+    std::string name;
+
+    /// Holds the location of the uniform.
+    GLint location;
+
+    /// Holds the OpenGL type of the uniform.
+    GLenum type;
+};
+
+} // namespace detail
+
+/// A handle of a uniform of the given type `T` of a `ShaderProgram`. See `ShaderProgram::get_uniform`. Handles are
+/// resolved once, and set values without looking the uniform up by its name.
+template <typename T>
+class Uniform final {
+  public:
+    /// Constructs an empty `Uniform`, which refers to no uniform.
+    Uniform() noexcept = default;
+
+    /// \returns `true` when this `Uniform` refers to a uniform, `false` otherwise.
+    explicit operator bool() const
+    {
+        return -1 != location;
+    }
+
+    /// Sets the uniform to the given `value`. The program needn't be in use.
+    void set(T const& value) const
+    {
+        set(&value, 1u);
+    }
+
+    /// Sets the first `count` elements of the uniform array to the given `values`. The program needn't be in use.
+    void set(T const* const values, std::size_t const count) const
+    {
+        if (-1 != location) {
+            detail::set_uniform(program, location, static_cast<GLsizei>(count), values);
+        }
+    }
+
+    /// \returns The location of the uniform, or -1 if this `Uniform` is empty.
+    GLint get_location() const
+    {
+        return location;
+    }
+
+  private:
+    friend class ShaderProgram;
+
+    /// Holds the OpenGL name of the shader program.
+    GLuint program = 0u;
+
+    /// Holds the location of the uniform.
+    GLint location = -1;
+};
+
 /// A class for managing an OpenGL shader program.
 class ShaderProgram final {
   public:
@@ -24,7 +196,7 @@ class ShaderProgram final {
     ~ShaderProgram() noexcept
     {
         // A value of 0 will be silently ignored.
-        glDeleteProgram(handle);
+        detail::delete_program(handle);
     }
 
     ShaderProgram& operator=(ShaderProgram const&) = delete;
@@ -37,6 +209,7 @@ class ShaderProgram final {
     void swap(ShaderProgram& that) noexcept
     {
         std::swap(handle, that.handle);
+        std::swap(uniforms, that.uniforms);
     }
 
     /// Checks whether the shader program is valid.
@@ -45,60 +218,142 @@ class ShaderProgram final {
         return 0u != handle;
     }
 
+    /// \returns The OpenGL name of the shader program, e.g. for building a `SortKey`.
+    GLuint get_handle() const
+    {
+        return handle;
+    }
+
     /// Makes the shader program be the one that will be used for drawing.
     void enable()
     {
         if (handle) {
-            glUseProgram(handle);
+            detail::use_program(handle);
         }
     }
 
-  private:
-    GLuint handle = 0u;
-};
+    /// \returns A handle of the uniform of the given `name` and type `T`, which is empty if the program has no such
+    /// active uniform, or it's of another type. Samplers are of the `GLint` type. Arrays are named with or without the
+    /// `[0]` suffix. Members of uniform blocks are not found, see `bind_uniform_block`.
+    template <typename T>
+    Uniform<T> get_uniform(std::string_view const name) const
+    {
+        static_assert(0u != uniform_type<T>, "Uniforms can't be of this type.");
 
-namespace detail {
+        Uniform<T> uniform;
+        auto const trimmed = detail::trim_array_suffix(name);
+        auto const it = std::find_if(uniforms.begin(), uniforms.end(),
+                                     [trimmed](detail::ActiveUniform const& active) { return trimmed == active.name; });
+        if (uniforms.end() == it) {
+            return uniform;
+        }
+        if (uniform_type<T> != it->type && !(std::is_same_v<T, GLint> && detail::is_sampler(it->type))) {
+            // TODO: report the error.
+            return uniform;
+        }
 
-/// \returns A handle to the shader of the given `type`, compiled with the given `source` code, or `nullptr` in case of
-/// compilation error.
-GLuint compile_shader(GLenum type, std::string_view const& source)
-{
-    auto handle = glCreateShader(type);
-    if (!handle) {
-        // TODO: report an error.
+        uniform.program = handle;
+        uniform.location = it->location;
+        return uniform;
     }
-    else {
-        // clang-format off
-        GLchar const* source_data[] = { source.data() };
-        GLint  const  source_size[] = { static_cast<GLint>(source.size()) };
-        // clang-format on
-        glShaderSource(handle, 1, source_data, source_size);
-        glCompileShader(handle);
 
-        GLint status = GL_FALSE;
-        glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
-        if (GL_FALSE == status) {
+    /// Binds the uniform block of the given `name` to the uniform buffer binding point of the given `index`, e.g. the
+    /// one a `UniformRing` range is bound to.
+    /// \returns `true` on success, `false` if the program has no such active uniform block.
+    bool bind_uniform_block(std::string_view const name, GLuint const index) const
+    {
+        return GL_INVALID_INDEX != bind_uniform_block(name, index, 0u);
+    }
+
+    /// Binds the uniform block of the given `name` to the uniform buffer binding point of the given `index`, and checks
+    /// that the block's size matches the std140 layout of the given `Block` type.
+    /// \returns `true` on success, `false` if the program has no such active uniform block, or its size differs.
+    template <typename Block>
+    bool bind_uniform_block(std::string_view const name, GLuint const index) const
+    {
+        if (GL_INVALID_INDEX == bind_uniform_block(name, index, Std140Layout<Block>::size)) {
+            // TODO: report the error.
+            return false;
+        }
+        return true;
+    }
+
+  private:
+    friend class PendingShaderProgram;
+
+    /// Looks up the locations and types of the active uniforms of the linked program.
+    void resolve_uniforms()
+    {
+        GLint count = 0;
+        GLint max_length = 0;
+        glGetProgramiv(handle, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+        std::vector<GLchar> name(static_cast<std::size_t>(std::max(max_length, 1)));
+        uniforms.clear();
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0u;
+            glGetActiveUniform(handle, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type,
+                               name.data());
 
-            std::array<char, 1024u> buffer;
-            glGetShaderInfoLog(handle, buffer.size(), nullptr, buffer.data());
+            // Members of uniform blocks have no location.
+            auto const location = glGetUniformLocation(handle, name.data());
+            if (-1 != location) {
+                auto const trimmed = detail::trim_array_suffix({name.data(), static_cast<std::size_t>(length)});
+                uniforms.push_back({std::string(trimmed), location, type});
+            }
+        }
+    }
 
-            // TODO: report an error.
+    /// Binds the uniform block of the given `name` to the binding point of the given `index`, unless the block's size
+    /// rounded up to 16 bytes differs from the given `size`, which is ignored if it's 0.
+    /// \returns The index of the block, or `GL_INVALID_INDEX` on failure.
+    GLuint bind_uniform_block(std::string_view const name, GLuint const index, std::size_t const size) const
+    {
+        auto const block = glGetUniformBlockIndex(handle, std::string(name).c_str());
+        if (GL_INVALID_INDEX == block) {
+            return GL_INVALID_INDEX;
+        }
 
-            glDeleteShader(handle);
-            handle = 0u;
+        if (size) {
+            GLint block_size = 0;
+            glGetActiveUniformBlockiv(handle, block, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+            if (detail::align_offset(static_cast<std::size_t>(block_size), 16u) != size) {
+                return GL_INVALID_INDEX;
+            }
         }
+
+        glUniformBlockBinding(handle, block, index);
+        return block;
     }
-    return handle;
-}
+
+    GLuint handle = 0u;
+
+    /// Holds the active uniforms, which are not members of uniform blocks.
+    std::vector<detail::ActiveUniform> uniforms;
+};
+
+namespace detail {
 
 /// Compiles and attaches a shader of the given `type` with the given `source` code to a shader program with the given
-/// `program_handle`.
-void compile_and_attach(GLuint program_handle, GLenum type, std::string_view const& source)
+/// `program_handle`. The compilation is not waited for, so the driver may run it in the background. Compilation errors
+/// surface as a link failure of the program.
+inline void compile_and_attach(GLuint program_handle, GLenum type, std::string_view const& source)
 {
     if (source.empty())
         return;
 
-    if (auto shader_handle = compile_shader(type, source.data()); shader_handle) {
+    if (auto shader_handle = glCreateShader(type); shader_handle) {
+        // clang-format off
+        GLchar const* source_data[] = { source.data() };
+        GLint  const  source_size[] = { static_cast<GLint>(source.size()) };
+        // clang-format on
+        glShaderSource(shader_handle, 1, source_data, source_size);
+        glCompileShader(shader_handle);
+
+        // The shader is deleted along with the program.
         glAttachShader(program_handle, shader_handle);
         glDeleteShader(shader_handle);
     }
@@ -107,37 +362,87 @@ void compile_and_attach(GLuint program_handle, GLenum type, std::string_view con
     }
 }
 
+/// \returns `true` when the driver compiles and links shader programs in the background, `false` otherwise.
+inline bool has_parallel_shader_compile()
+{
+    return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+/// \returns The given shader `source` with the given `defines` inserted right after its `#version` directive, or at
+/// its beginning if there is none. An empty `source` stays empty.
+inline std::string insert_defines(std::string const& source, std::string const& defines)
+{
+    if (source.empty() || defines.empty()) {
+        return source;
+    }
+
+    std::size_t position = 0u;
+    if (auto const version = source.find("#version"); std::string::npos != version) {
+        auto const end_of_line = source.find('\n', version);
+        position = std::string::npos == end_of_line ? source.size() : end_of_line + 1u;
+    }
+
+    auto result = source.substr(0u, position);
+    if (!result.empty() && '\n' != result.back()) {
+        result += '\n';
+    }
+    return result.append(defines).append(source, position, std::string::npos);
+}
+
 } // namespace detail
 
-/// A class for building instances of `ShaderProgram`.
-class ShaderProgram::Builder final {
+/// A handle of a `ShaderProgram` being compiled and linked by the driver. See `ShaderProgram::Builder::build_async`.
+///
+/// With `KHR_parallel_shader_compile` the driver compiles on threads of its own, and `is_ready` tells without waiting
+/// whether the program can be taken. Draw with a fallback program meanwhile. Without the extension `is_ready` is always
+/// `true`, and `get` waits for the driver.
+class PendingShaderProgram final {
   public:
-    /// Compiles a vertex shader with the given `source`. The shader will be linked into the `ShaderProgram` under
-    /// construction.
-    Builder& with_vertex_shader(std::string_view const& source)
+    PendingShaderProgram() noexcept = default;
+
+    PendingShaderProgram(PendingShaderProgram const&) = delete;
+    PendingShaderProgram(PendingShaderProgram&& that)
     {
-        if (lazy_init()) {
-            detail::compile_and_attach(instance.handle, GL_VERTEX_SHADER, source);
-        }
-        return *this;
+        swap(that);
     }
 
-    /// Compiles a fragment shader with the given `source`. The shader will be linked into the `ShaderProgram` under
-    /// construction.
-    Builder& with_fragment_shader(std::string_view const& source)
+    PendingShaderProgram& operator=(PendingShaderProgram const&) = delete;
+    PendingShaderProgram& operator=(PendingShaderProgram&& that)
     {
-        if (lazy_init()) {
-            detail::compile_and_attach(instance.handle, GL_FRAGMENT_SHADER, source);
-        }
+        swap(that);
         return *this;
     }
 
-    /// \returns The built `ShaderProgram` instance.
-    operator ShaderProgram()
+    void swap(PendingShaderProgram& that) noexcept
     {
-        if (lazy_init()) {
-            glLinkProgram(instance.handle);
+        instance.swap(that.instance);
+        std::swap(cache, that.cache);
+        std::swap(key, that.key);
+    }
 
+    /// Checks whether there is a program to take.
+    explicit operator bool() const
+    {
+        return static_cast<bool>(instance);
+    }
+
+    /// \returns `true` when `get` won't wait for the driver, `false` otherwise.
+    bool is_ready() const
+    {
+        if (!instance || !detail::has_parallel_shader_compile()) {
+            return true;
+        }
+
+        GLint status = GL_FALSE;
+        glGetProgramiv(instance.handle, GL_COMPLETION_STATUS_KHR, &status);
+        return GL_FALSE != status;
+    }
+
+    /// Takes the built program, waiting for the driver unless `is_ready()`. Leaves this handle empty.
+    /// \returns The built `ShaderProgram` instance, which is empty if the program failed to compile or link.
+    ShaderProgram get()
+    {
+        if (instance) {
             GLint status = GL_FALSE;
             glGetProgramiv(instance.handle, GL_LINK_STATUS, &status);
             if (GL_FALSE == status) {
@@ -147,13 +452,110 @@ class ShaderProgram::Builder final {
 
                 // TODO: report the error.
 
-                glDeleteProgram(instance.handle);
+                detail::delete_program(instance.handle);
                 instance.handle = 0u;
             }
+            else {
+                if (cache) {
+                    cache->store(key, instance.handle);
+                }
+                instance.resolve_uniforms();
+            }
         }
+        cache = nullptr;
         return std::move(instance);
     }
 
+  private:
+    friend class ShaderProgram::Builder;
+
+    /// Holds the `ShaderProgram` instance being built.
+    ShaderProgram instance;
+
+    /// Holds the cache, which the program is stored into once it's linked, or `nullptr`.
+    ProgramCache* cache = nullptr;
+
+    /// Holds the key of the program in the `cache`.
+    std::uint64_t key = 0u;
+};
+
+/// A class for building instances of `ShaderProgram`.
+///
+/// The shaders are compiled, and the program is linked when it's built. With a `ProgramCache` a program linked on a
+/// previous launch is loaded from its binary instead.
+class ShaderProgram::Builder final {
+  public:
+    /// Sets the `source` of the vertex shader, which will be linked into the `ShaderProgram` under construction.
+    Builder& with_vertex_shader(std::string_view const& source)
+    {
+        vertex_source = source;
+        return *this;
+    }
+
+    /// Sets the `source` of the fragment shader, which will be linked into the `ShaderProgram` under construction.
+    Builder& with_fragment_shader(std::string_view const& source)
+    {
+        fragment_source = source;
+        return *this;
+    }
+
+    /// Defines the macro of the given `name` with the given `value` in every shader, right after its `#version`
+    /// directive.
+    Builder& with_define(std::string_view const& name, std::string_view const& value = {})
+    {
+        defines.append("#define ").append(name).append(" ").append(value).append("\n");
+        return *this;
+    }
+
+    /// Loads the `ShaderProgram` under construction from the given `cache`, and stores it there if it's not found. The
+    /// cache must outlive the builder.
+    Builder& with_cache(ProgramCache& cache)
+    {
+        this->cache = &cache;
+        return *this;
+    }
+
+    /// Submits the compilation and the link of the `ShaderProgram` under construction to the driver without waiting for
+    /// either of them. Submit a batch of programs first, and poll them later, so the driver compiles them in parallel.
+    /// \returns A handle of the program being built.
+    PendingShaderProgram build_async()
+    {
+        auto const vertex = detail::insert_defines(vertex_source, defines);
+        auto const fragment = detail::insert_defines(fragment_source, defines);
+
+        PendingShaderProgram pending;
+        auto const cached = cache && cache->is_supported();
+        auto const key = cached ? cache->get_key({vertex, fragment}) : 0u;
+        if (cached && lazy_init()) {
+            if (cache->load(key, instance.handle)) {
+                pending.instance = std::move(instance);
+                return pending;
+            }
+            // Compiles the program anew, as a rejected binary leaves the program in an unspecified state.
+            detail::delete_program(instance.handle);
+            instance.handle = 0u;
+        }
+
+        if (lazy_init()) {
+            detail::compile_and_attach(instance.handle, GL_VERTEX_SHADER, vertex);
+            detail::compile_and_attach(instance.handle, GL_FRAGMENT_SHADER, fragment);
+            if (cached) {
+                glProgramParameteri(instance.handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                pending.cache = cache;
+                pending.key = key;
+            }
+            glLinkProgram(instance.handle);
+            pending.instance = std::move(instance);
+        }
+        return pending;
+    }
+
+    /// \returns The built `ShaderProgram` instance.
+    operator ShaderProgram()
+    {
+        return build_async().get();
+    }
+
   private:
     /// Creates the shader program object unless it has been created already.
     bool lazy_init()
@@ -172,6 +574,18 @@ class ShaderProgram::Builder final {
 
     /// Holds the `ShaderProgram` instance being built.
     ShaderProgram instance;
+
+    /// Hold the sources of the shaders.
+    /// @{
+    std::string vertex_source;
+    std::string fragment_source;
+    /// @}
+
+    /// Holds the `#define` directives inserted into every shader.
+    std::string defines;
+
+    /// Holds the cache of programs, or `nullptr`.
+    ProgramCache* cache = nullptr;
 };
 
 } // namespace v1
@@ -0,0 +1,613 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include <nest/config.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for eliminating redundant OpenGL state changes. It remembers the state it has set, and skips the calls which
+/// wouldn't change anything. Every `OpenGL` context owns one, and makes it current along with the context.
+///
+/// The cache starts with all the state unknown, so the first call of every kind always reaches the driver. Call
+/// `invalidate()` after code, which doesn't go through the cache, has changed the state.
+///
+/// In validation mode the cache checks itself against `glGet*` after every call. It is meant for debugging, since the
+/// queries stall the pipeline.
+class StateCache final {
+  public:
+    /// Holds the numbers of calls the cache has passed to the driver, and has skipped.
+    struct Counters {
+        std::size_t issued = 0u;
+        std::size_t skipped = 0u;
+
+        /// Holds the number of times the cached state turned out to differ from the actual one. Only counted in
+        /// validation mode.
+        std::size_t mismatched = 0u;
+    };
+
+    /// Holds the number of texture units tracked by the cache. Binding textures to higher units is not cached.
+    static constexpr GLuint TextureUnitCount = 16u;
+
+    /// Holds the number of uniform buffer binding points tracked by the cache. Binding to higher ones is not cached.
+    static constexpr GLuint UniformBufferBindingCount = 16u;
+
+    /// Constructs a cache, which knows nothing about the current state.
+    StateCache() noexcept
+    {
+        invalidate();
+    }
+
+    StateCache(StateCache const&) = delete;
+    StateCache& operator=(StateCache const&) = delete;
+
+    /// \returns The cache of the context, which is current on the calling thread, or `nullptr` if there isn't any.
+    static StateCache* current() noexcept
+    {
+        return current_cache();
+    }
+
+    /// Makes the given `cache` be the current one on the calling thread.
+    static void make_current(StateCache* const cache) noexcept
+    {
+        current_cache() = cache;
+    }
+
+    /// Forgets all the cached state.
+    void invalidate() noexcept
+    {
+        program = Unknown;
+        vertex_array = Unknown;
+        buffers.fill(Unknown);
+        uniform_buffers.fill({Unknown, 0, 0});
+        active_texture_unit = Unknown;
+        for (auto& unit : textures) {
+            unit.fill(Unknown);
+        }
+        capabilities.fill(UnknownCapability);
+        blend_factors = {Unknown, Unknown};
+        depth_function = Unknown;
+        depth_write_mask = Unknown;
+        cull_face_mode = Unknown;
+        stencil_function = {Unknown, Unknown, Unknown};
+        stencil_operations = {Unknown, Unknown, Unknown};
+        stencil_write_mask = Unknown;
+        viewport_rect = {-1, -1, -1, -1};
+    }
+
+    /// Enables or disables validation of the cache against the actual OpenGL state.
+    void set_validation(bool const enabled) noexcept
+    {
+        validation = enabled;
+    }
+
+    /// Is an equivalent of `glUseProgram`.
+    void use_program(GLuint const handle)
+    {
+        if (update(program, handle)) {
+            glUseProgram(handle);
+        }
+        validate(GL_CURRENT_PROGRAM, program);
+    }
+
+    /// Is an equivalent of `glBindVertexArray`.
+    void bind_vertex_array(GLuint const handle)
+    {
+        if (update(vertex_array, handle)) {
+            glBindVertexArray(handle);
+
+            // The element array buffer binding is a part of vertex array state.
+            buffers[buffer_slot(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+        }
+        validate(GL_VERTEX_ARRAY_BINDING, vertex_array);
+    }
+
+    /// Is an equivalent of `glBindBuffer`.
+    void bind_buffer(GLenum const target, GLuint const handle)
+    {
+        auto const slot = buffer_slot(target);
+        if (slot == BufferTargets.size()) {
+            ++counters.issued;
+            glBindBuffer(target, handle);
+            return;
+        }
+
+        if (update(buffers[slot], handle)) {
+            glBindBuffer(target, handle);
+        }
+        validate(BufferTargets[slot].binding, buffers[slot]);
+    }
+
+    /// Is an equivalent of `glBindBufferRange` for the `GL_UNIFORM_BUFFER` target, which binds the range of the given
+    /// `size` at the given `offset` of a buffer to the binding point of the given `index`.
+    void bind_uniform_buffer(GLuint const index, GLuint const handle, GLintptr const offset, GLsizeiptr const size)
+    {
+        // The call binds the buffer to the generic binding point as well, so the latter is only updated when the call
+        // is issued.
+        auto const generic_slot = buffer_slot(GL_UNIFORM_BUFFER);
+
+        if (index >= UniformBufferBindingCount) {
+            ++counters.issued;
+            glBindBufferRange(GL_UNIFORM_BUFFER, index, handle, offset, size);
+            buffers[generic_slot] = handle;
+            return;
+        }
+
+        if (update(uniform_buffers[index], {handle, offset, size})) {
+            glBindBufferRange(GL_UNIFORM_BUFFER, index, handle, offset, size);
+            buffers[generic_slot] = handle;
+        }
+        if (Unknown != buffers[generic_slot]) {
+            validate(GL_UNIFORM_BUFFER_BINDING, buffers[generic_slot]);
+        }
+        if (validation) {
+            GLint actual = 0;
+            glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, index, &actual);
+            check(static_cast<GLuint>(actual) == uniform_buffers[index].handle);
+        }
+    }
+
+    /// Binds the given texture to the given `target` of the given texture `unit`. Leaves the `unit` active.
+    void bind_texture(GLuint const unit, GLenum const target, GLuint const handle)
+    {
+        auto const slot = texture_slot(target);
+        if (unit >= TextureUnitCount || slot == TextureTargets.size()) {
+            counters.issued += 2u;
+            active_texture_unit = unit;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(target, handle);
+            return;
+        }
+
+        if (update(active_texture_unit, unit)) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+        }
+        if (update(textures[unit][slot], handle)) {
+            glBindTexture(target, handle);
+        }
+        validate(TextureTargets[slot].binding, textures[unit][slot]);
+    }
+
+    /// Is an equivalent of `glEnable` and `glDisable` for the capabilities the cache tracks: `GL_BLEND`,
+    /// `GL_CULL_FACE`, `GL_DEPTH_TEST`, `GL_SCISSOR_TEST` and `GL_STENCIL_TEST`.
+    void set_capability(GLenum const capability, bool const enabled)
+    {
+        auto const slot = capability_slot(capability);
+        if (slot == Capabilities.size()) {
+            ++counters.issued;
+            enabled ? glEnable(capability) : glDisable(capability);
+            return;
+        }
+
+        if (update(capabilities[slot], static_cast<std::int8_t>(enabled))) {
+            enabled ? glEnable(capability) : glDisable(capability);
+        }
+        if (validation) {
+            check(static_cast<GLboolean>(capabilities[slot]) == glIsEnabled(capability));
+        }
+    }
+
+    /// Is an equivalent of `glBlendFunc`.
+    void blend_func(GLenum const source, GLenum const destination)
+    {
+        if (update(blend_factors, std::array<GLuint, 2u>{source, destination})) {
+            glBlendFunc(source, destination);
+        }
+        validate(GL_BLEND_SRC_RGB, blend_factors[0]);
+        validate(GL_BLEND_DST_RGB, blend_factors[1]);
+    }
+
+    /// Is an equivalent of `glDepthFunc`.
+    void depth_func(GLenum const function)
+    {
+        if (update(depth_function, function)) {
+            glDepthFunc(function);
+        }
+        validate(GL_DEPTH_FUNC, depth_function);
+    }
+
+    /// Is an equivalent of `glDepthMask`.
+    void depth_mask(GLboolean const enabled)
+    {
+        if (update(depth_write_mask, static_cast<GLuint>(enabled))) {
+            glDepthMask(enabled);
+        }
+        validate(GL_DEPTH_WRITEMASK, depth_write_mask);
+    }
+
+    /// Is an equivalent of `glCullFace`.
+    void cull_face(GLenum const mode)
+    {
+        if (update(cull_face_mode, mode)) {
+            glCullFace(mode);
+        }
+        validate(GL_CULL_FACE_MODE, cull_face_mode);
+    }
+
+    /// Is an equivalent of `glStencilFunc`.
+    void stencil_func(GLenum const function, GLint const reference, GLuint const mask)
+    {
+        if (update(stencil_function, std::array<GLuint, 3u>{function, static_cast<GLuint>(reference), mask})) {
+            glStencilFunc(function, reference, mask);
+        }
+        validate(GL_STENCIL_FUNC, stencil_function[0]);
+        validate(GL_STENCIL_REF, stencil_function[1]);
+        validate_stencil_mask(GL_STENCIL_VALUE_MASK, stencil_function[2]);
+    }
+
+    /// Is an equivalent of `glStencilOp`.
+    void stencil_op(GLenum const fail, GLenum const depth_fail, GLenum const pass)
+    {
+        if (update(stencil_operations, std::array<GLuint, 3u>{fail, depth_fail, pass})) {
+            glStencilOp(fail, depth_fail, pass);
+        }
+        validate(GL_STENCIL_FAIL, stencil_operations[0]);
+        validate(GL_STENCIL_PASS_DEPTH_FAIL, stencil_operations[1]);
+        validate(GL_STENCIL_PASS_DEPTH_PASS, stencil_operations[2]);
+    }
+
+    /// Is an equivalent of `glStencilMask`.
+    void stencil_mask(GLuint const mask)
+    {
+        if (update(stencil_write_mask, mask)) {
+            glStencilMask(mask);
+        }
+        validate_stencil_mask(GL_STENCIL_WRITEMASK, stencil_write_mask);
+    }
+
+    /// Is an equivalent of `glViewport`.
+    void viewport(GLint const x, GLint const y, GLsizei const width, GLsizei const height)
+    {
+        if (update(viewport_rect, std::array<GLint, 4u>{x, y, width, height})) {
+            glViewport(x, y, width, height);
+        }
+        if (validation) {
+            std::array<GLint, 4u> actual = {};
+            glGetIntegerv(GL_VIEWPORT, actual.data());
+            check(actual == viewport_rect);
+        }
+    }
+
+    /// Forgets the shader program with the given `handle`, which is about to be deleted. Its name may be reused.
+    void forget_program(GLuint const handle) noexcept
+    {
+        forget(program, handle);
+    }
+
+    /// Forgets the vertex array object with the given `handle`, which is about to be deleted.
+    void forget_vertex_array(GLuint const handle) noexcept
+    {
+        if (vertex_array == handle) {
+            vertex_array = Unknown;
+            buffers[buffer_slot(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+        }
+    }
+
+    /// Forgets the buffer object with the given `handle`, which is about to be deleted.
+    void forget_buffer(GLuint const handle) noexcept
+    {
+        for (auto& buffer : buffers) {
+            forget(buffer, handle);
+        }
+        for (auto& range : uniform_buffers) {
+            forget(range.handle, handle);
+        }
+    }
+
+    /// Forgets the texture object with the given `handle`, which is about to be deleted.
+    void forget_texture(GLuint const handle) noexcept
+    {
+        for (auto& unit : textures) {
+            for (auto& texture : unit) {
+                forget(texture, handle);
+            }
+        }
+    }
+
+    /// \returns The counters accumulated since the last `end_frame()`.
+    Counters get_counters() const noexcept
+    {
+        return counters;
+    }
+
+    /// \returns The counters of the last finished frame.
+    Counters get_frame_counters() const noexcept
+    {
+        return frame_counters;
+    }
+
+    /// Finishes counting calls of the current frame. Is called by `OpenGL::swap_buffers()`.
+    void end_frame() noexcept
+    {
+        frame_counters = counters;
+        counters = Counters{};
+    }
+
+  private:
+    /// Holds a value, which is never a valid name or enum, and thus means that the state is unknown.
+    static constexpr GLuint Unknown = ~0u;
+
+    /// Holds a value of a capability, which is neither enabled nor disabled.
+    static constexpr std::int8_t UnknownCapability = -1;
+
+    /// A buffer or texture target along with the query, which returns the object bound to it.
+    struct Target {
+        GLenum target;
+        GLenum binding;
+    };
+
+    // clang-format off
+    /// Holds the buffer targets tracked by the cache.
+    static constexpr std::array<Target, 8u> BufferTargets = {{
+        {GL_ARRAY_BUFFER,         GL_ARRAY_BUFFER_BINDING},
+        {GL_ELEMENT_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER_BINDING},
+        {GL_UNIFORM_BUFFER,       GL_UNIFORM_BUFFER_BINDING},
+        {GL_COPY_READ_BUFFER,     GL_COPY_READ_BUFFER_BINDING},
+        {GL_COPY_WRITE_BUFFER,    GL_COPY_WRITE_BUFFER_BINDING},
+        {GL_PIXEL_PACK_BUFFER,    GL_PIXEL_PACK_BUFFER_BINDING},
+        {GL_PIXEL_UNPACK_BUFFER,  GL_PIXEL_UNPACK_BUFFER_BINDING},
+        {GL_DRAW_INDIRECT_BUFFER, GL_DRAW_INDIRECT_BUFFER_BINDING},
+    }};
+
+    /// A range of a buffer bound to an indexed binding point.
+    struct BufferRange {
+        GLuint handle;
+        GLintptr offset;
+        GLsizeiptr size;
+
+        bool operator==(BufferRange const& that) const noexcept
+        {
+            return handle == that.handle && offset == that.offset && size == that.size;
+        }
+    };
+
+    /// Holds the texture targets tracked by the cache.
+    static constexpr std::array<Target, 4u> TextureTargets = {{
+        {GL_TEXTURE_2D,       GL_TEXTURE_BINDING_2D},
+        {GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BINDING_2D_ARRAY},
+        {GL_TEXTURE_3D,       GL_TEXTURE_BINDING_3D},
+        {GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BINDING_CUBE_MAP},
+    }};
+
+    /// Holds the capabilities tracked by the cache.
+    static constexpr std::array<GLenum, 5u> Capabilities = {{
+        GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+    }};
+    // clang-format on
+
+    /// \returns The index of the given buffer `target` in `BufferTargets`, or the size of the latter if the target is
+    /// not tracked.
+    static std::size_t buffer_slot(GLenum const target) noexcept
+    {
+        std::size_t slot = 0u;
+        while (slot < BufferTargets.size() && BufferTargets[slot].target != target) {
+            ++slot;
+        }
+        return slot;
+    }
+
+    /// \returns The index of the given texture `target` in `TextureTargets`, or the size of the latter if the target is
+    /// not tracked.
+    static std::size_t texture_slot(GLenum const target) noexcept
+    {
+        std::size_t slot = 0u;
+        while (slot < TextureTargets.size() && TextureTargets[slot].target != target) {
+            ++slot;
+        }
+        return slot;
+    }
+
+    /// \returns The index of the given `capability` in `Capabilities`, or the size of the latter if the capability is
+    /// not tracked.
+    static std::size_t capability_slot(GLenum const capability) noexcept
+    {
+        std::size_t slot = 0u;
+        while (slot < Capabilities.size() && Capabilities[slot] != capability) {
+            ++slot;
+        }
+        return slot;
+    }
+
+    /// Holds a pointer to the cache of the context, which is current on the calling thread.
+    static StateCache*& current_cache() noexcept
+    {
+        static thread_local StateCache* cache = nullptr;
+        return cache;
+    }
+
+    /// Stores the given `value` in the `cached` state.
+    /// \returns `true` when the call setting the state has to be issued, `false` when it may be skipped.
+    template <typename T>
+    bool update(T& cached, T const& value) noexcept
+    {
+        if (cached == value) {
+            ++counters.skipped;
+            return false;
+        }
+        cached = value;
+        ++counters.issued;
+        return true;
+    }
+
+    /// Marks the `cached` state as unknown if it holds the given `handle`.
+    static void forget(GLuint& cached, GLuint const handle) noexcept
+    {
+        if (cached == handle) {
+            cached = Unknown;
+        }
+    }
+
+    /// Checks the `expected` value against the actual value of the state returned by the given `query`.
+    void validate(GLenum const query, GLuint const expected)
+    {
+        if (validation) {
+            GLint actual = 0;
+            glGetIntegerv(query, &actual);
+            check(static_cast<GLuint>(actual) == expected);
+        }
+    }
+
+    /// Checks the `expected` stencil mask against the actual one returned by the given `query`. Drivers may cut masks
+    /// down to the bits of the stencil buffer, so only the lower 8 bits, the usual size of the buffer, are checked.
+    void validate_stencil_mask(GLenum const query, GLuint const expected)
+    {
+        if (validation) {
+            GLint actual = 0;
+            glGetIntegerv(query, &actual);
+            check(0u == ((static_cast<GLuint>(actual) ^ expected) & 0xFFu));
+        }
+    }
+
+    /// Counts a mismatch between the cached and the actual state unless `matches` is `true`.
+    void check(bool const matches) noexcept
+    {
+        if (!matches) {
+            ++counters.mismatched;
+            // TODO: report the error.
+            assert(false && "The cached OpenGL state differs from the actual one.");
+        }
+    }
+
+    /// Holds the current shader program.
+    GLuint program;
+
+    /// Holds the current vertex array object.
+    GLuint vertex_array;
+
+    /// Holds the buffers bound to the targets in `BufferTargets`.
+    std::array<GLuint, BufferTargets.size()> buffers;
+
+    /// Holds the buffer ranges bound to the uniform buffer binding points.
+    std::array<BufferRange, UniformBufferBindingCount> uniform_buffers;
+
+    /// Holds the active texture unit.
+    GLuint active_texture_unit;
+
+    /// Holds the textures bound to the targets in `TextureTargets` for every texture unit.
+    std::array<std::array<GLuint, TextureTargets.size()>, TextureUnitCount> textures;
+
+    /// Holds the states of the capabilities in `Capabilities`: 0 is disabled, 1 is enabled.
+    std::array<std::int8_t, Capabilities.size()> capabilities;
+
+    /// Holds the source and destination blend factors.
+    std::array<GLuint, 2u> blend_factors;
+
+    /// Holds the depth comparison function.
+    GLuint depth_function;
+
+    /// Holds the depth write mask.
+    GLuint depth_write_mask;
+
+    /// Holds the culled face.
+    GLuint cull_face_mode;
+
+    /// Holds the stencil comparison function, reference value, and mask.
+    std::array<GLuint, 3u> stencil_function;
+
+    /// Holds the stencil operations on stencil test failure, depth test failure, and depth test pass.
+    std::array<GLuint, 3u> stencil_operations;
+
+    /// Holds the stencil write mask.
+    GLuint stencil_write_mask;
+
+    /// Holds the viewport's x, y, width, and height.
+    std::array<GLint, 4u> viewport_rect;
+
+    /// Holds a boolean which specifies whether the cache checks itself against the actual state.
+    bool validation = NEST_VALIDATE_OPENGL_STATE;
+
+    /// Holds the counters of the current frame.
+    Counters counters;
+
+    /// Holds the counters of the last finished frame.
+    Counters frame_counters;
+};
+
+namespace detail {
+
+/// Is an equivalent of `glUseProgram`, which goes through the current `StateCache` if there is any.
+inline void use_program(GLuint const handle)
+{
+    if (auto const cache = StateCache::current()) {
+        cache->use_program(handle);
+    }
+    else {
+        glUseProgram(handle);
+    }
+}
+
+/// Is an equivalent of `glBindVertexArray`, which goes through the current `StateCache` if there is any.
+inline void bind_vertex_array(GLuint const handle)
+{
+    if (auto const cache = StateCache::current()) {
+        cache->bind_vertex_array(handle);
+    }
+    else {
+        glBindVertexArray(handle);
+    }
+}
+
+/// Is an equivalent of `glBindBuffer`, which goes through the current `StateCache` if there is any.
+inline void bind_buffer(GLenum const target, GLuint const handle)
+{
+    if (auto const cache = StateCache::current()) {
+        cache->bind_buffer(target, handle);
+    }
+    else {
+        glBindBuffer(target, handle);
+    }
+}
+
+/// Is an equivalent of `glBindBufferRange` for the `GL_UNIFORM_BUFFER` target, which goes through the current
+/// `StateCache` if there is any.
+inline void bind_uniform_buffer(GLuint const index, GLuint const handle, GLintptr const offset, GLsizeiptr const size)
+{
+    if (auto const cache = StateCache::current()) {
+        cache->bind_uniform_buffer(index, handle, offset, size);
+    }
+    else {
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, handle, offset, size);
+    }
+}
+
+/// Is an equivalent of `glDeleteProgram`, which keeps the current `StateCache` up to date.
+inline void delete_program(GLuint const handle)
+{
+    if (auto const cache = StateCache::current()) {
+        cache->forget_program(handle);
+    }
+    glDeleteProgram(handle);
+}
+
+/// Is an equivalent of `glDeleteVertexArrays`, which keeps the current `StateCache` up to date.
+inline void delete_vertex_arrays(GLsizei const count, GLuint const* const handles)
+{
+    if (auto const cache = StateCache::current()) {
+        for (GLsizei i = 0; i < count; ++i) {
+            cache->forget_vertex_array(handles[i]);
+        }
+    }
+    glDeleteVertexArrays(count, handles);
+}
+
+/// Is an equivalent of `glDeleteBuffers`, which keeps the current `StateCache` up to date.
+inline void delete_buffers(GLsizei const count, GLuint const* const handles)
+{
+    if (auto const cache = StateCache::current()) {
+        for (GLsizei i = 0; i < count; ++i) {
+            cache->forget_buffer(handles[i]);
+        }
+    }
+    glDeleteBuffers(count, handles);
+}
+
+} // namespace detail
+
+} // namespace v1
+} // namespace nest
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Holds a numeric value which represents the base alignment of a member of the given type `T` in a uniform block of
+/// the std140 layout, or 0 if the type can't be a member.
+/// @{
+// clang-format off
+template<typename T> static constexpr std::size_t std140_alignment = 0u;
+
+template<>           constexpr std::size_t std140_alignment<float>      = 4u;
+template<>           constexpr std::size_t std140_alignment<int>        = 4u;
+template<>           constexpr std::size_t std140_alignment<unsigned>   = 4u;
+template<>           constexpr std::size_t std140_alignment<glm::vec2>  = 8u;
+template<>           constexpr std::size_t std140_alignment<glm::ivec2> = 8u;
+template<>           constexpr std::size_t std140_alignment<glm::uvec2> = 8u;
+template<>           constexpr std::size_t std140_alignment<glm::vec3>  = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::ivec3> = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::uvec3> = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::vec4>  = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::ivec4> = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::uvec4> = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::mat3>  = 16u;
+template<>           constexpr std::size_t std140_alignment<glm::mat4>  = 16u;
+// clang-format on
+/// @}
+
+/// Holds a numeric value which represents the number of bytes a member of the given type `T` takes in a uniform block
+/// of the std140 layout. The columns of matrices are padded to 16 bytes.
+/// @{
+// clang-format off
+template<typename T> static constexpr std::size_t std140_size = sizeof(T);
+
+template<>           constexpr std::size_t std140_size<glm::mat3> = 48u;
+// clang-format on
+/// @}
+
+template <typename Block>
+struct Std140Layout;
+
+namespace detail {
+
+/// A value which converts to any type, and thus initializes any member of an aggregate.
+struct AnyMember final {
+    template <typename T>
+    operator T() const;
+};
+
+/// An `AnyMember` for every index of a pack.
+template <std::size_t>
+using AnyMemberAt = AnyMember;
+
+/// Holds a boolean value which specifies whether the given aggregate type `T` can be initialized with as many values
+/// as there are `Indices`.
+/// @{
+template <typename T, typename Indices, typename = void>
+static constexpr bool is_initializable = false;
+
+template <typename T, std::size_t... Indices>
+constexpr bool
+    is_initializable<T, std::index_sequence<Indices...>, std::void_t<decltype(T{AnyMemberAt<Indices>{}...})>> = true;
+/// @}
+
+/// Holds the maximum number of members of a uniform block.
+static constexpr std::size_t MaxBlockMemberCount = 16u;
+
+/// \returns The number of members of the given aggregate type `T`, which has no array members, counting from `N`.
+template <typename T, std::size_t N = 0u>
+constexpr std::size_t count_members()
+{
+    if constexpr (N < MaxBlockMemberCount && is_initializable<T, std::make_index_sequence<N + 1u>>) {
+        return count_members<T, N + 1u>();
+    }
+    else {
+        return N;
+    }
+}
+
+/// \returns A tuple of references to the members of the given aggregate `value`.
+template <typename T>
+auto tie_members(T& value)
+{
+    constexpr auto count = count_members<std::remove_const_t<T>>();
+    static_assert(0u < count, "A uniform block must be an aggregate of at most 16 members, none of them arrays.");
+
+    if constexpr (1u == count) {
+        auto& [m0] = value;
+        return std::tie(m0);
+    }
+    else if constexpr (2u == count) {
+        auto& [m0, m1] = value;
+        return std::tie(m0, m1);
+    }
+    else if constexpr (3u == count) {
+        auto& [m0, m1, m2] = value;
+        return std::tie(m0, m1, m2);
+    }
+    else if constexpr (4u == count) {
+        auto& [m0, m1, m2, m3] = value;
+        return std::tie(m0, m1, m2, m3);
+    }
+    else if constexpr (5u == count) {
+        auto& [m0, m1, m2, m3, m4] = value;
+        return std::tie(m0, m1, m2, m3, m4);
+    }
+    else if constexpr (6u == count) {
+        auto& [m0, m1, m2, m3, m4, m5] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5);
+    }
+    else if constexpr (7u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6);
+    }
+    else if constexpr (8u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7);
+    }
+    else if constexpr (9u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8);
+    }
+    else if constexpr (10u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9);
+    }
+    else if constexpr (11u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10);
+    }
+    else if constexpr (12u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11);
+    }
+    else if constexpr (13u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12);
+    }
+    else if constexpr (14u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13);
+    }
+    else if constexpr (15u == count) {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14);
+    }
+    else {
+        auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15] = value;
+        return std::tie(m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15);
+    }
+}
+
+/// \returns The given `offset` rounded up to a multiple of the given `alignment`.
+constexpr std::size_t align_offset(std::size_t const offset, std::size_t const alignment)
+{
+    return (offset + alignment - 1u) / alignment * alignment;
+}
+
+/// \returns The std140 offsets of the given members, followed by the size of the block.
+template <typename... Members>
+constexpr std::array<std::size_t, sizeof...(Members) + 1u> get_std140_offsets(std::tuple<Members&...> const*)
+{
+    static_assert(((0u != std140_alignment<std::remove_const_t<Members>>)&&...),
+                  "The members of a uniform block must be 32-bit scalars or vectors, or float matrices.");
+
+    std::array<std::size_t, sizeof...(Members) + 1u> offsets = {};
+    std::size_t offset = 0u;
+    std::size_t index = 0u;
+    ((offset = align_offset(offset, std140_alignment<std::remove_const_t<Members>>), offsets[index++] = offset,
+      offset += std140_size<std::remove_const_t<Members>>),
+     ...);
+
+    // The size of a block is padded to the alignment of a `vec4`.
+    offsets[index] = align_offset(offset, 16u);
+    return offsets;
+}
+
+/// Copies the given `member` of a uniform block to the given `destination` in the std140 layout.
+template <typename T>
+void write_std140_member(T const& member, std::byte* const destination)
+{
+    if constexpr (std::is_same_v<T, glm::mat3>) {
+        for (int column = 0; column < 3; ++column) {
+            std::memcpy(destination + 16 * column, &member[column], sizeof(member[column]));
+        }
+    }
+    else {
+        std::memcpy(destination, &member, sizeof(member));
+    }
+}
+
+/// Copies the given `members` of a uniform block of the given `Block` type to the given `destination` in the std140
+/// layout.
+template <typename Block, typename Members, std::size_t... Indices>
+void write_std140_members(Members const& members, std::byte* const destination, std::index_sequence<Indices...>)
+{
+    (write_std140_member(std::get<Indices>(members), destination + Std140Layout<Block>::get_offset(Indices)), ...);
+}
+
+} // namespace detail
+
+/// Describes the std140 layout of the given `Block` type, which mirrors a uniform block of a shader. The layout is
+/// worked out at compile time from the types of the members of the block, so it needn't match the layout of the C++
+/// type: e.g. a `glm::vec3` followed by a `float` share 16 bytes in either, but a `glm::vec2` following a `float` is
+/// aligned to 8 bytes only in the std140 one. `write_std140` copies the members to their std140 offsets.
+///
+/// A block must be an aggregate of at most 16 members, which are 32-bit scalars or vectors, or float matrices. Arrays
+/// are not supported.
+template <typename Block>
+struct Std140Layout final {
+  private:
+    using Members = decltype(detail::tie_members(std::declval<Block&>()));
+
+    static constexpr auto offsets_and_size = detail::get_std140_offsets(static_cast<Members const*>(nullptr));
+
+  public:
+    /// Holds the number of members of the block.
+    static constexpr std::size_t member_count = std::tuple_size_v<Members>;
+
+    /// Holds the size of the block in bytes.
+    static constexpr std::size_t size = offsets_and_size[member_count];
+
+    /// \returns The offset of the member of the given `index` in bytes.
+    static constexpr std::size_t get_offset(std::size_t const index)
+    {
+        return offsets_and_size[index];
+    }
+};
+
+/// Writes the given `block` to the given `destination` in the std140 layout. The destination must hold at least
+/// `Std140Layout<Block>::size` bytes. The padding between the members is left as it is.
+template <typename Block>
+void write_std140(Block const& block, void* const destination)
+{
+    detail::write_std140_members<Block>(detail::tie_members(block), static_cast<std::byte*>(destination),
+                                        std::make_index_sequence<Std140Layout<Block>::member_count>());
+}
+
+} // namespace v1
+} // namespace nest
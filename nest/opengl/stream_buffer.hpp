@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+#include <GL/glew.h>
+
+#include <nest/opengl/fence.hpp>
+#include <nest/opengl/state_cache.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for managing an OpenGL buffer, which is rewritten every frame, e.g. with dynamic geometry.
+///
+/// The buffer is used as a ring: every frame writes after the data of the previous ones, and wraps around at the end.
+/// The data is written straight into the buffer's memory, which stays mapped for the buffer's lifetime when
+/// `ARB_buffer_storage` is available. The range written by every frame is then guarded with a fence, and the CPU only
+/// waits for the GPU when it's about to overwrite a range the GPU may still read from. Without `ARB_buffer_storage`
+/// every write is mapped unsynchronized, and the buffer is orphaned when the ring wraps around, so the driver hands out
+/// fresh storage instead of waiting.
+class StreamBuffer final {
+  public:
+    /// Enumerates the ways to write into the buffer without waiting for the GPU.
+    enum class Strategy { PersistentMapping, Orphaning };
+
+    /// Holds the counters of the uploads made through a `StreamBuffer`.
+    struct Counters {
+        /// Holds the number of bytes written.
+        std::size_t uploaded_bytes = 0u;
+
+        /// Holds the number of times the CPU had to wait for the GPU to finish reading a range.
+        std::size_t wait_count = 0u;
+
+        /// Holds the total time the CPU spent waiting for the GPU.
+        std::chrono::nanoseconds wait_time{};
+
+        /// Holds the number of times the buffer's storage was orphaned.
+        std::size_t orphan_count = 0u;
+    };
+
+    /// A range of the buffer mapped for writing `count` items of type `T`.
+    template <typename T>
+    struct Range {
+        /// Holds a pointer to the first item to write, or `nullptr` if the range couldn't be mapped.
+        T* data = nullptr;
+
+        /// Holds the number of items in the range.
+        std::size_t count = 0u;
+
+        /// Holds the offset of the range in bytes from the beginning of the buffer.
+        GLintptr offset = 0;
+
+        /// \returns The index of the first item in the range, e.g. the `first` argument of `glDrawArrays`, or the
+        /// `basevertex` argument of `glDrawElementsBaseVertex`.
+        GLint first() const
+        {
+            return static_cast<GLint>(offset / static_cast<GLintptr>(sizeof(T)));
+        }
+
+        /// \returns `true` when the range is mapped, `false` otherwise.
+        explicit operator bool() const
+        {
+            return nullptr != data;
+        }
+    };
+
+    /// \returns The strategy used on the current context by default.
+    static Strategy default_strategy()
+    {
+        return GLEW_ARB_buffer_storage ? Strategy::PersistentMapping : Strategy::Orphaning;
+    }
+
+    /// Constructs an empty `StreamBuffer`.
+    StreamBuffer() noexcept = default;
+
+    /// Constructs a buffer of the given `capacity` in bytes, which must be large enough to hold the data of several
+    /// frames in flight, otherwise the CPU will wait for the GPU. The context must be current.
+    explicit StreamBuffer(std::size_t const capacity, Strategy const strategy = default_strategy())
+        : strategy(strategy), capacity(capacity)
+    {
+        glGenBuffers(1, &handle);
+        if (!handle) {
+            // TODO: report the error.
+            return;
+        }
+
+        detail::bind_buffer(GL_COPY_WRITE_BUFFER, handle);
+
+        auto const size = static_cast<GLsizeiptr>(capacity);
+        if (Strategy::PersistentMapping == strategy) {
+            constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+            memory = static_cast<std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+            if (!memory) {
+                // TODO: report the error.
+            }
+        }
+        else {
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    StreamBuffer(StreamBuffer const&) = delete;
+    StreamBuffer(StreamBuffer&& that) noexcept
+    {
+        swap(that);
+    }
+
+    ~StreamBuffer() noexcept
+    {
+        // Deleting a buffer unmaps it as well. A value of 0 will be silently ignored.
+        detail::delete_buffers(1, &handle);
+    }
+
+    StreamBuffer& operator=(StreamBuffer const&) = delete;
+    StreamBuffer& operator=(StreamBuffer&& that) noexcept
+    {
+        swap(that);
+        return *this;
+    }
+
+    void swap(StreamBuffer& that) noexcept
+    {
+        // clang-format off
+        std::swap(handle,         that.handle);
+        std::swap(strategy,       that.strategy);
+        std::swap(capacity,       that.capacity);
+        std::swap(memory,         that.memory);
+        std::swap(head,           that.head);
+        std::swap(frame_start,    that.frame_start);
+        std::swap(mapped,         that.mapped);
+        std::swap(pending,        that.pending);
+        std::swap(counters,       that.counters);
+        std::swap(frame_counters, that.frame_counters);
+        std::swap(last_frame,     that.last_frame);
+        // clang-format on
+    }
+
+    /// \returns `true` when this `StreamBuffer` is not empty, `false` otherwise.
+    explicit operator bool() const
+    {
+        return 0u != handle;
+    }
+
+    /// \returns The OpenGL name of the buffer, e.g. for binding it as a vertex buffer.
+    GLuint get_handle() const
+    {
+        return handle;
+    }
+
+    /// \returns The strategy used for writing into the buffer.
+    Strategy get_strategy() const
+    {
+        return strategy;
+    }
+
+    /// Maps a range of the buffer for writing `count` items of type `T`. The range is aligned to the given `alignment`
+    /// in bytes, which defaults to the size of `T`, so that its `first()` item can be addressed by index. Write the
+    /// items straight into the range, then call `unmap()` before drawing from it. The context must be current.
+    /// \returns The mapped range, which is empty if `count` items don't fit into the buffer.
+    template <typename T>
+    Range<T> map(std::size_t const count, std::size_t const alignment = sizeof(T))
+    {
+        auto const size = count * sizeof(T);
+        auto offset = (head + alignment - 1u) / alignment * alignment;
+        if (!handle || mapped || size > capacity) {
+            // TODO: report the error.
+            return {};
+        }
+
+        if (offset + size > capacity) {
+            if (!wrap_around(size)) {
+                return {};
+            }
+            offset = 0u;
+        }
+
+        if (Strategy::PersistentMapping == strategy && offset < frame_start && offset + size > frame_start) {
+            // The current frame has wrapped around, and would overwrite its own data.
+            // TODO: report the error.
+            return {};
+        }
+
+        std::byte* data = nullptr;
+        if (Strategy::PersistentMapping == strategy) {
+            make_available(offset, offset + size);
+            data = memory ? memory + offset : nullptr;
+        }
+        else {
+            constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+            detail::bind_buffer(GL_COPY_WRITE_BUFFER, handle);
+            data = static_cast<std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                                                            static_cast<GLsizeiptr>(size), flags));
+        }
+
+        if (!data) {
+            // TODO: report the error.
+            return {};
+        }
+
+        mapped = true;
+        head = offset + size;
+        frame_counters.uploaded_bytes += size;
+
+        return {reinterpret_cast<T*>(data), count, static_cast<GLintptr>(offset)};
+    }
+
+    /// Finishes writing into the range returned by the last `map()` call.
+    void unmap()
+    {
+        if (!mapped) {
+            return;
+        }
+        mapped = false;
+
+        if (Strategy::Orphaning == strategy) {
+            detail::bind_buffer(GL_COPY_WRITE_BUFFER, handle);
+            if (GL_FALSE == glUnmapBuffer(GL_COPY_WRITE_BUFFER)) {
+                // TODO: report the error, the contents of the buffer got corrupted.
+            }
+        }
+    }
+
+    /// Marks the end of a frame: the ranges written so far get guarded by a fence. Call this once the frame's draws
+    /// have been issued.
+    void end_frame()
+    {
+        unmap();
+
+        if (Strategy::PersistentMapping == strategy && head != frame_start) {
+            pending.push_back({frame_start, head, head < frame_start, Fence::insert()});
+        }
+        frame_start = head;
+
+        counters.uploaded_bytes += frame_counters.uploaded_bytes;
+        counters.wait_count += frame_counters.wait_count;
+        counters.wait_time += frame_counters.wait_time;
+        counters.orphan_count += frame_counters.orphan_count;
+        last_frame = std::exchange(frame_counters, Counters{});
+    }
+
+    /// \returns The counters accumulated over the lifetime of the buffer, up to the last `end_frame()` call.
+    Counters const& get_counters() const
+    {
+        return counters;
+    }
+
+    /// \returns The counters of the last frame, i.e. the one ended by the last `end_frame()` call.
+    Counters const& get_frame_counters() const
+    {
+        return last_frame;
+    }
+
+  private:
+    /// A range of the buffer written by a frame, which the GPU may still read from.
+    struct Region {
+        /// Holds the offset of the first byte of the region.
+        std::size_t start;
+
+        /// Holds the offset past the last byte of the region.
+        std::size_t end;
+
+        /// Holds a boolean which specifies whether the region wraps around the end of the buffer.
+        bool wrapped;
+
+        /// Holds the fence, which gets signaled when the GPU is done with the region.
+        Fence fence;
+    };
+
+    /// Moves the head of the ring to the beginning of the buffer, so that `size` bytes fit after it.
+    /// \returns `true` on success, `false` when the current frame alone would overflow the buffer.
+    bool wrap_around(std::size_t const size)
+    {
+        if (Strategy::Orphaning == strategy) {
+            // The driver keeps the old storage around while the GPU reads from it.
+            detail::bind_buffer(GL_COPY_WRITE_BUFFER, handle);
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+            ++frame_counters.orphan_count;
+            frame_start = 0u;
+        }
+        else if (head < frame_start || size >= frame_start) {
+            // The current frame has wrapped around already, or would overwrite its own data.
+            // TODO: report the error.
+            return false;
+        }
+
+        head = 0u;
+        return true;
+    }
+
+    /// Waits until the GPU is done with the regions overlapping the [`start`, `end`) range.
+    void make_available(std::size_t const start, std::size_t const end)
+    {
+        auto const overlaps = [start, end](Region const& region) {
+            if (region.wrapped) {
+                return start < region.end || end > region.start;
+            }
+            return start < region.end && end > region.start;
+        };
+
+        // Regions retire in the order they were written, so waiting for the last overlapping one covers the rest.
+        auto const last = std::find_if(pending.rbegin(), pending.rend(), overlaps);
+        if (pending.rend() == last) {
+            return;
+        }
+
+        auto const num_retired = static_cast<std::size_t>(pending.rend() - last);
+        auto& fence = pending[num_retired - 1u].fence;
+        if (!fence.is_signaled()) {
+            auto const started = std::chrono::steady_clock::now();
+            while (!fence.wait(std::chrono::milliseconds(1))) {
+            }
+            ++frame_counters.wait_count;
+            frame_counters.wait_time += std::chrono::steady_clock::now() - started;
+        }
+
+        pending.erase(pending.begin(), pending.begin() + num_retired);
+    }
+
+    /// Holds the OpenGL name of the buffer.
+    GLuint handle = 0u;
+
+    /// Holds the strategy used for writing into the buffer.
+    Strategy strategy = Strategy::PersistentMapping;
+
+    /// Holds the size of the buffer in bytes.
+    std::size_t capacity = 0u;
+
+    /// Holds a pointer to the persistently mapped memory of the buffer.
+    std::byte* memory = nullptr;
+
+    /// Holds the offset, which the next range is mapped at.
+    std::size_t head = 0u;
+
+    /// Holds the offset of the first range written by the current frame.
+    std::size_t frame_start = 0u;
+
+    /// Holds a boolean which specifies whether a range is mapped.
+    bool mapped = false;
+
+    /// Holds the regions written by the previous frames, oldest first.
+    std::deque<Region> pending;
+
+    /// Holds the counters up to the last `end_frame()` call.
+    Counters counters;
+
+    /// Holds the counters of the current frame.
+    Counters frame_counters;
+
+    /// Holds the counters of the last frame.
+    Counters last_frame;
+};
+
+} // namespace v1
+} // namespace nest
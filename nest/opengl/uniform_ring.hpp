@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include <GL/glew.h>
+
+#include <nest/opengl/state_cache.hpp>
+#include <nest/opengl/std140.hpp>
+#include <nest/opengl/stream_buffer.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for passing per-draw uniform data through a uniform buffer, which is rewritten every frame.
+///
+/// Every draw pushes a block of its data, e.g. a transform and a tint, which is written into a `StreamBuffer` in the
+/// std140 layout of the block's type, and binds the returned range to the binding point of the uniform block in the
+/// shader with `glBindBufferRange`. A frame thus sets its uniforms with a single buffer and a few offsets, rather than
+/// with a `glUniform*` call per value. Call `end_frame()` once the frame's draws have been issued.
+class UniformRing final {
+  public:
+    /// A range of the ring holding a uniform block.
+    struct Range {
+        /// Holds the offset of the block in bytes from the beginning of the buffer.
+        GLintptr offset = 0;
+
+        /// Holds the size of the block in bytes, or 0 if the range is empty.
+        GLsizeiptr size = 0;
+
+        /// \returns `true` when the range holds a block, `false` otherwise.
+        explicit operator bool() const
+        {
+            return 0 != size;
+        }
+    };
+
+    /// Constructs an empty `UniformRing`.
+    UniformRing() noexcept = default;
+
+    /// Constructs a ring of the given `capacity` in bytes, which must be large enough to hold the blocks of several
+    /// frames in flight, see `StreamBuffer`. Blocks are aligned to `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT`. The context
+    /// must be current.
+    explicit UniformRing(std::size_t const capacity,
+                         StreamBuffer::Strategy const strategy = StreamBuffer::default_strategy())
+        : buffer(capacity, strategy)
+    {
+        GLint offset_alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+        alignment = static_cast<std::size_t>(std::max(offset_alignment, 1));
+    }
+
+    UniformRing(UniformRing const&) = delete;
+    UniformRing(UniformRing&& that) noexcept
+    {
+        swap(that);
+    }
+
+    UniformRing& operator=(UniformRing const&) = delete;
+    UniformRing& operator=(UniformRing&& that) noexcept
+    {
+        swap(that);
+        return *this;
+    }
+
+    void swap(UniformRing& that) noexcept
+    {
+        buffer.swap(that.buffer);
+        std::swap(alignment, that.alignment);
+    }
+
+    /// \returns `true` when this `UniformRing` is not empty, `false` otherwise.
+    explicit operator bool() const
+    {
+        return static_cast<bool>(buffer);
+    }
+
+    /// Writes the given `block` into the ring in the std140 layout of its type. See `Std140Layout`.
+    /// \returns The range holding the block, which is empty if the block doesn't fit into the ring.
+    template <typename Block>
+    Range push(Block const& block)
+    {
+        constexpr auto size = Std140Layout<Block>::size;
+
+        auto const range = buffer.map<std::byte>(size, alignment);
+        if (!range) {
+            // TODO: report the error.
+            return {};
+        }
+        write_std140(block, range.data);
+        buffer.unmap();
+
+        return {range.offset, static_cast<GLsizeiptr>(size)};
+    }
+
+    /// Binds the given `range` to the uniform buffer binding point of the given `index`, see
+    /// `ShaderProgram::bind_uniform_block`.
+    void bind(GLuint const index, Range const& range) const
+    {
+        if (range) {
+            detail::bind_uniform_buffer(index, buffer.get_handle(), range.offset, range.size);
+        }
+    }
+
+    /// Marks the end of a frame, see `StreamBuffer::end_frame`.
+    void end_frame()
+    {
+        buffer.end_frame();
+    }
+
+    /// \returns The buffer of the ring, e.g. for reading its counters.
+    StreamBuffer const& get_buffer() const
+    {
+        return buffer;
+    }
+
+  private:
+    /// Holds the buffer of the ring.
+    StreamBuffer buffer;
+
+    /// Holds the alignment of blocks in bytes.
+    std::size_t alignment = 1u;
+};
+
+} // namespace v1
+} // namespace nest
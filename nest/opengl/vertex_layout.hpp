@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include <nest/mesh_format.hpp>
+#include <nest/quantization.hpp>
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+namespace detail {
+
+/// Enables and initializes an attribute with the given `index`, which is found at the given `offset` within vertices
+/// of the given `stride`. Attributes taking several slots, e.g. matrices, are set up slot by slot. The attribute
+/// advances once per `divisor` instances, or once per vertex if the `divisor` is 0. Attributes of normalized types,
+/// e.g. `Unorm8`, are read as floats.
+template <typename T>
+void enable_attribute(GLuint const index, GLsizei const stride, std::size_t const offset, GLuint const divisor = 0u)
+{
+    constexpr GLboolean normalized = is_normalized<T> ? GL_TRUE : GL_FALSE;
+
+    for (std::size_t slot = 0u; slot < slot_count<T>; ++slot) {
+        auto const slot_index = index + static_cast<GLuint>(slot);
+        auto const slot_offset = offset + slot * sizeof(T) / slot_count<T>;
+
+        glEnableVertexAttribArray(slot_index);
+        glVertexAttribPointer(slot_index, component_count<T>, opengl_type<T>, normalized, stride,
+                              reinterpret_cast<GLvoid const*>(slot_offset));
+        glVertexAttribDivisor(slot_index, divisor);
+    }
+}
+
+/// Enables the attributes of the given `Vertex` type in the bound VAO. The attributes are read from the buffer bound
+/// to `GL_ARRAY_BUFFER`.
+template <typename Vertex>
+void enable_attributes()
+{
+    if constexpr (has_position<Vertex>) {
+        enable_attribute<decltype(Vertex::position)>(PositionAttribute, sizeof(Vertex), offsetof(Vertex, position));
+    }
+
+    if constexpr (has_color<Vertex>) {
+        enable_attribute<decltype(Vertex::color)>(ColorAttribute, sizeof(Vertex), offsetof(Vertex, color));
+    }
+
+    if constexpr (has_texcoord<Vertex>) {
+        enable_attribute<decltype(Vertex::texcoord)>(TexcoordAttribute, sizeof(Vertex), offsetof(Vertex, texcoord));
+    }
+}
+
+/// Enables the attributes of the given `Vertex` type in the bound VAO, as they are laid out by `quantize_vertices`.
+/// The attributes are read from the buffer bound to `GL_ARRAY_BUFFER`.
+template <typename Vertex>
+void enable_quantized_attributes()
+{
+    using Layout = QuantizedLayout<Vertex>;
+    constexpr auto stride = static_cast<GLsizei>(Layout::stride);
+
+    if constexpr (has_position<Vertex>) {
+        enable_attribute<Quantized<decltype(Vertex::position)>>(PositionAttribute, stride, Layout::position_offset);
+    }
+
+    if constexpr (has_color<Vertex>) {
+        enable_attribute<Quantized<decltype(Vertex::color), true>>(ColorAttribute, stride, Layout::color_offset);
+    }
+
+    if constexpr (has_texcoord<Vertex>) {
+        enable_attribute<Quantized<decltype(Vertex::texcoord)>>(TexcoordAttribute, stride, Layout::texcoord_offset);
+    }
+}
+
+/// \returns The OpenGL type of the given `type` of components of a mesh file.
+inline GLenum get_opengl_type(ComponentType const type)
+{
+    switch (type) {
+    case ComponentType::Float:
+        return GL_FLOAT;
+    case ComponentType::Half:
+        return GL_HALF_FLOAT;
+    case ComponentType::Byte:
+        return GL_BYTE;
+    case ComponentType::UnsignedByte:
+        return GL_UNSIGNED_BYTE;
+    case ComponentType::Short:
+        return GL_SHORT;
+    case ComponentType::UnsignedShort:
+        return GL_UNSIGNED_SHORT;
+    case ComponentType::Int:
+        return GL_INT;
+    case ComponentType::UnsignedInt:
+        return GL_UNSIGNED_INT;
+    case ComponentType::Fixed:
+        return GL_FIXED;
+    case ComponentType::Int2101010:
+        return GL_INT_2_10_10_10_REV;
+    }
+    return GL_FLOAT;
+}
+
+/// Enables the attributes described by the given `header` of a mesh file in the bound VAO. The attributes are read
+/// from the buffer bound to `GL_ARRAY_BUFFER`.
+inline void enable_attributes(MeshFileHeader const& header)
+{
+    for (std::size_t i = 0u; i < header.attribute_count; ++i) {
+        auto const& attribute = header.attributes[i];
+        auto const index = AttributeSemantic::Position == attribute.semantic ? PositionAttribute
+                           : AttributeSemantic::Color == attribute.semantic  ? ColorAttribute
+                                                                             : TexcoordAttribute;
+
+        glEnableVertexAttribArray(index);
+        glVertexAttribPointer(index, attribute.component_count, get_opengl_type(attribute.type),
+                              attribute.normalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(header.vertex_stride),
+                              reinterpret_cast<GLvoid const*>(static_cast<std::size_t>(attribute.offset)));
+        glVertexAttribDivisor(index, 0u);
+    }
+}
+
+/// Enables the per-instance attributes of the given `Instance` type in the bound VAO. The attributes are read from the
+/// buffer bound to `GL_ARRAY_BUFFER`, and advance once per instance.
+template <typename Instance>
+void enable_instance_attributes()
+{
+    if constexpr (has_transform<Instance>) {
+        enable_attribute<decltype(Instance::transform)>(TransformAttribute, sizeof(Instance),
+                                                        offsetof(Instance, transform), 1u);
+    }
+
+    if constexpr (has_tint<Instance>) {
+        enable_attribute<decltype(Instance::tint)>(TintAttribute, sizeof(Instance), offsetof(Instance, tint), 1u);
+    }
+}
+
+} // namespace detail
+} // namespace v1
+} // namespace nest
@@ -4,6 +4,8 @@
 
 #include <GL/glew.h>
 
+#include <nest/packed_types.hpp>
+
 namespace nest {
 inline namespace v1 {
 
@@ -43,12 +45,25 @@ template <>              constexpr GLenum opengl_type<glm::uvec2>  = GL_UNSIGNED
 template <>              constexpr GLenum opengl_type<glm::uvec3>  = GL_UNSIGNED_INT;
 template <>              constexpr GLenum opengl_type<glm::uvec4>  = GL_UNSIGNED_INT;
 
-// TODO(oleksii): Implement strongly-typed type alias for `GLhalf`, since it's a typedef of `unsigned int` just like `GLushort`.
-#if 0
+// 8-bit, signed, 2's complement binary integer, normalized to [-1, 1]:
+template <>              constexpr GLenum opengl_type<Snorm8>      = GL_BYTE;
+template <std::size_t N> constexpr GLenum opengl_type<Snorm8[N]>   = GL_BYTE;
+
+// 8-bit, unsigned binary integer, normalized to [0, 1]:
+template <>              constexpr GLenum opengl_type<Unorm8>      = GL_UNSIGNED_BYTE;
+template <std::size_t N> constexpr GLenum opengl_type<Unorm8[N]>   = GL_UNSIGNED_BYTE;
+
+// 16-bit, signed, 2's complement binary integer, normalized to [-1, 1]:
+template <>              constexpr GLenum opengl_type<Snorm16>     = GL_SHORT;
+template <std::size_t N> constexpr GLenum opengl_type<Snorm16[N]>  = GL_SHORT;
+
+// 16-bit, unsigned binary integer, normalized to [0, 1]:
+template <>              constexpr GLenum opengl_type<Unorm16>     = GL_UNSIGNED_SHORT;
+template <std::size_t N> constexpr GLenum opengl_type<Unorm16[N]>  = GL_UNSIGNED_SHORT;
+
 // 16-bit, IEEE-754 floating-point value:
-template <>              constexpr GLenum opengl_type<GLhalf>      = GL_HALF_FLOAT;
-template <std::size_t N> constexpr GLenum opengl_type<GLhalf[N]>   = GL_HALF_FLOAT;
-#endif
+template <>              constexpr GLenum opengl_type<Half>        = GL_HALF_FLOAT;
+template <std::size_t N> constexpr GLenum opengl_type<Half[N]>     = GL_HALF_FLOAT;
 
 // 32-bit, IEEE-754 floating-point value:
 template <>              constexpr GLenum opengl_type<GLfloat>     = GL_FLOAT;
@@ -56,6 +71,8 @@ template <std::size_t N> constexpr GLenum opengl_type<GLfloat[N]>  = GL_FLOAT;
 template <>              constexpr GLenum opengl_type<glm::vec2>   = GL_FLOAT;
 template <>              constexpr GLenum opengl_type<glm::vec3>   = GL_FLOAT;
 template <>              constexpr GLenum opengl_type<glm::vec4>   = GL_FLOAT;
+template <>              constexpr GLenum opengl_type<glm::mat3>   = GL_FLOAT;
+template <>              constexpr GLenum opengl_type<glm::mat4>   = GL_FLOAT;
 
 // 64-bit, IEEE-754 floating-point value:
 template <>              constexpr GLenum opengl_type<GLdouble>    = GL_DOUBLE;
@@ -64,18 +81,25 @@ template <>              constexpr GLenum opengl_type<glm::dvec2>  = GL_DOUBLE;
 template <>              constexpr GLenum opengl_type<glm::dvec3>  = GL_DOUBLE;
 template <>              constexpr GLenum opengl_type<glm::dvec4>  = GL_DOUBLE;
 
-// TODO(oleksii): Implement strongly-typed type alias for `GLfixed`, since it's a typedef of `int` just like `GLint`.
-#if 0
 // 32-bit, signed, 2's complement 16.16 integer:
-template <>              constexpr GLenum opengl_type<GLfixed>     = GL_FIXED;
-template <std::size_t N> constexpr GLenum opengl_type<GLfixed[N]>  = GL_FIXED;
-#endif
+template <>              constexpr GLenum opengl_type<Fixed>       = GL_FIXED;
+template <std::size_t N> constexpr GLenum opengl_type<Fixed[N]>    = GL_FIXED;
+
+// Four signed, 2's complement binary integers of 10, 10, 10 and 2 bits packed into 32 bits, normalized to [-1, 1]:
+template <>              constexpr GLenum opengl_type<Snorm2101010> = GL_INT_2_10_10_10_REV;
 
 // clang-format on
 ///@}
 
-/// Holds indices of vertex attributes, as they are expected to be mapped in a shader program.
-enum : GLuint { PositionAttribute = 0u, ColorAttribute = 1u, TexcoordAttribute = 2u };
+/// Holds indices of vertex attributes, as they are expected to be mapped in a shader program. The per-instance
+/// `transform` takes four consecutive slots, one per column.
+enum : GLuint {
+    PositionAttribute = 0u,
+    ColorAttribute = 1u,
+    TexcoordAttribute = 2u,
+    TransformAttribute = 3u,
+    TintAttribute = 7u
+};
 
 } // namespace v1
 } // namespace nest
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A 16-bit IEEE-754 floating-point value. It's a distinct type, so it isn't mistaken for a 16-bit integer the way
+/// `GLhalf` is.
+struct Half final {
+    /// Holds the bits of the value: 1 sign bit, 5 exponent bits and 10 mantissa bits.
+    std::uint16_t bits = 0u;
+
+    /// Constructs a zero.
+    Half() = default;
+
+    /// Constructs the value nearest to the given one. Values too large for a half float become infinities.
+    explicit Half(float const value)
+    {
+        std::uint32_t x;
+        std::memcpy(&x, &value, sizeof(x));
+
+        auto const sign = static_cast<std::uint16_t>((x >> 16u) & 0x8000u);
+        auto const magnitude = x & 0x7fffffffu;
+
+        if (magnitude >= 0x7f800000u) {
+            // Keeps infinities, and keeps NaNs quiet.
+            bits = sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u);
+        }
+        else if (magnitude >= 0x477ff000u) {
+            // Rounds to a value above 65504, the largest half float.
+            bits = sign | 0x7c00u;
+        }
+        else if (magnitude < 0x38800000u) {
+            // Below 2^-14, the smallest normal half float, values are multiples of 2^-24.
+            float absolute;
+            std::memcpy(&absolute, &magnitude, sizeof(absolute));
+            bits = sign | static_cast<std::uint16_t>(std::nearbyint(absolute * 16777216.f));
+        }
+        else {
+            // Rebiases the exponent, and rounds the 13 dropped mantissa bits to nearest even.
+            auto half = (magnitude - 0x38000000u) >> 13u;
+            auto const rest = magnitude & 0x1fffu;
+            if (rest > 0x1000u || (0x1000u == rest && (half & 1u))) {
+                ++half;
+            }
+            bits = sign | static_cast<std::uint16_t>(half);
+        }
+    }
+
+    /// \returns The value as a 32-bit float, which represents every half float exactly.
+    explicit operator float() const
+    {
+        auto const sign = static_cast<std::uint32_t>(bits & 0x8000u) << 16u;
+        auto const exponent = static_cast<std::uint32_t>(bits >> 10u) & 0x1fu;
+        auto const mantissa = static_cast<std::uint32_t>(bits) & 0x3ffu;
+
+        if (0u == exponent) {
+            auto const value = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -value : value;
+        }
+
+        auto const x = 0x1fu == exponent ? sign | 0x7f800000u | (mantissa << 13u)
+                                         : sign | ((exponent + 112u) << 23u) | (mantissa << 13u);
+        float value;
+        std::memcpy(&value, &x, sizeof(value));
+        return value;
+    }
+};
+
+/// An integer, which the GPU reads as a normalized float: unsigned integers map to [0, 1], and signed ones map to
+/// [-1, 1].
+template <typename T>
+struct Normalized final {
+    static_assert(std::is_integral_v<T>, "Only integers can be normalized.");
+
+    /// Holds the integer.
+    T value = 0;
+
+    /// Constructs a zero.
+    Normalized() = default;
+
+    /// Constructs the integer nearest to the given `value`, which is clamped to the normalized range first.
+    explicit Normalized(float const value)
+        : value(static_cast<T>(std::lround(std::clamp(value, lowest, 1.f) * largest)))
+    {
+    }
+
+    /// \returns The float the GPU reads, as of OpenGL 4.2: a signed integer c of b bits maps to
+    /// max(c / (2^(b-1) - 1), -1), so 0 is exact, and both of the lowest two integers map to -1. OpenGL 4.1, which the
+    /// engine creates contexts of, specifies (2c + 1) / (2^b - 1) instead, which has no exact 0, and maps only the
+    /// lowest integer to -1, although drivers may apply the newer rule regardless of the version. Unsigned integers map
+    /// the same way in both.
+    explicit operator float() const
+    {
+        return std::max(static_cast<float>(value) / largest, lowest);
+    }
+
+  private:
+    static constexpr float largest = static_cast<float>(std::numeric_limits<T>::max());
+    static constexpr float lowest = std::is_signed_v<T> ? -1.f : 0.f;
+};
+
+/// Normalized integers of the common sizes.
+/// @{
+using Snorm8 = Normalized<std::int8_t>;
+using Unorm8 = Normalized<std::uint8_t>;
+using Snorm16 = Normalized<std::int16_t>;
+using Unorm16 = Normalized<std::uint16_t>;
+/// @}
+
+/// A signed 16.16 fixed-point value. It's a distinct type, so it isn't mistaken for a 32-bit integer the way `GLfixed`
+/// is.
+struct Fixed final {
+    /// Holds the value multiplied by 2^16.
+    std::int32_t bits = 0;
+
+    /// Constructs a zero.
+    Fixed() = default;
+
+    /// Constructs the value nearest to the given one, which is clamped to the representable range first.
+    explicit Fixed(float const value)
+        : bits(static_cast<std::int32_t>(std::clamp(std::round(value * 65536.f), -2147483648.f, 2147483520.f)))
+    {
+    }
+
+    /// \returns The value as a float.
+    explicit operator float() const
+    {
+        return static_cast<float>(bits) / 65536.f;
+    }
+};
+
+/// Four signed normalized components packed into 32 bits: 10 bits for each of `x`, `y` and `z`, and 2 bits for `w`,
+/// starting from the least significant bit. It suits normals and tangents, whose `w` holds the handedness.
+struct Snorm2101010 final {
+    /// Holds the packed components.
+    std::uint32_t bits = 0u;
+
+    /// Constructs a zero vector.
+    Snorm2101010() = default;
+
+    /// Constructs the vector nearest to the given one, whose components are clamped to [-1, 1] first.
+    explicit Snorm2101010(glm::vec4 const& value)
+        : bits(pack(value.x, 511.f) | pack(value.y, 511.f) << 10u | pack(value.z, 511.f) << 20u |
+               pack(value.w, 1.f) << 30u)
+    {
+    }
+
+    /// \returns The vector the GPU reads, as of OpenGL 4.2. See `Normalized::operator float` for the rule of OpenGL
+    /// 4.1.
+    explicit operator glm::vec4() const
+    {
+        return glm::vec4(unpack(bits, 10u, 511.f), unpack(bits >> 10u, 10u, 511.f), unpack(bits >> 20u, 10u, 511.f),
+                         unpack(bits >> 30u, 2u, 1.f));
+    }
+
+  private:
+    /// \returns The bits of a component of the given `largest` value, which `value` is normalized to.
+    static std::uint32_t pack(float const value, float const largest)
+    {
+        auto const component = static_cast<std::int32_t>(std::lround(std::clamp(value, -1.f, 1.f) * largest));
+        return static_cast<std::uint32_t>(component) & (1.f == largest ? 0x3u : 0x3ffu);
+    }
+
+    /// \returns The component stored in the given number of least significant `width` bits.
+    static float unpack(std::uint32_t const bits, std::uint32_t const width, float const largest)
+    {
+        auto const shift = 32u - width;
+        auto const component = static_cast<std::int32_t>(bits << shift) >> shift;
+        return std::max(static_cast<float>(component) / largest, -1.f);
+    }
+};
+
+} // namespace v1
+} // namespace nest
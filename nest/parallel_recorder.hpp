@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nest/renderer.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// A class for recording a single command queue on several threads at once.
+///
+/// The work is split into parts, e.g. ranges of a scene, and every part is recorded into a builder of its own. The
+/// parts are then merged in the order of their indices, so the resulting queue doesn't depend on which thread recorded
+/// which part. Merging doesn't copy commands, see `AsyncRenderer::CommandQueue::Builder::append`.
+///
+/// The worker threads are started once and are kept around, so recording a frame doesn't spawn threads.
+class ParallelRecorder final {
+  public:
+    using CommandQueue = AsyncRenderer::CommandQueue;
+
+    /// Constructs a recorder, which uses `num_threads` threads, including the one calling `record`.
+    explicit ParallelRecorder(std::size_t const num_threads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (std::size_t i = 1u; i < num_threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ParallelRecorder() noexcept
+    {
+        {
+            std::unique_lock lock(mutex);
+            stopping = true;
+        }
+        started.notify_all();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ParallelRecorder(ParallelRecorder const&) = delete;
+    ParallelRecorder& operator=(ParallelRecorder const&) = delete;
+
+    /// \returns The number of threads used for recording, including the one calling `record`.
+    std::size_t get_thread_count() const noexcept
+    {
+        return workers.size() + 1u;
+    }
+
+    /// Calls `fn(part, builder)` for every `part` in the [0, `num_parts`) range, each with a builder of its own, and
+    /// merges the recorded parts in the order of their indices. Blocks until all the parts are recorded. If `fn` throws,
+    /// the first exception is rethrown once all the threads are done.
+    template <typename F> // F models void(std::size_t part, CommandQueue::Builder& builder)
+    CommandQueue record(std::size_t const num_parts, F&& fn)
+    {
+        parts.resize(num_parts);
+
+        task = [](void const* context, std::size_t const part, CommandQueue::Builder& builder) {
+            (*static_cast<std::remove_reference_t<F>*>(const_cast<void*>(context)))(part, builder);
+        };
+        task_context = std::addressof(fn);
+        part_count = num_parts;
+        next_part.store(0u);
+        error = nullptr;
+
+        {
+            std::unique_lock lock(mutex);
+            ++generation;
+            busy_workers = workers.size();
+        }
+        started.notify_all();
+
+        record_parts();
+
+        {
+            std::unique_lock lock(mutex);
+            finished.wait(lock, [this] { return 0u == busy_workers; });
+        }
+
+        if (error) {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+
+        CommandQueue::Builder builder;
+        for (auto& part : parts) {
+            builder.append(std::move(part));
+        }
+        return builder;
+    }
+
+  private:
+    /// Is run by every worker thread: waits for a new batch of parts to record, and records them.
+    void work()
+    {
+        std::size_t seen_generation = 0u;
+
+        for (;;) {
+            {
+                std::unique_lock lock(mutex);
+                started.wait(lock, [&] { return stopping || generation != seen_generation; });
+                if (stopping) {
+                    return;
+                }
+                seen_generation = generation;
+            }
+
+            record_parts();
+
+            {
+                std::unique_lock lock(mutex);
+                if (0u == --busy_workers) {
+                    finished.notify_one();
+                }
+            }
+        }
+    }
+
+    /// Records parts until there are none left. Threads grab the next part index one by one, so a slow part doesn't
+    /// hold up the rest.
+    void record_parts()
+    {
+        for (auto part = next_part.fetch_add(1u); part < part_count; part = next_part.fetch_add(1u)) {
+            try {
+                CommandQueue::Builder builder;
+                task(task_context, part, builder);
+                parts[part] = builder;
+            }
+            catch (...) {
+                std::unique_lock lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    /// Holds the worker threads.
+    std::vector<std::thread> workers;
+
+    /// Holds a handle to a mutex which protects `generation`, `busy_workers`, `stopping` and `error`.
+    std::mutex mutex;
+
+    /// Is used to wake up the workers when there is a new batch of parts to record.
+    std::condition_variable started;
+
+    /// Is used to wake up the thread calling `record` when the workers are done.
+    std::condition_variable finished;
+
+    /// Holds the number of batches started so far.
+    std::size_t generation = 0u;
+
+    /// Holds the number of workers, which haven't finished the current batch yet.
+    std::size_t busy_workers = 0u;
+
+    /// Holds a boolean which specifies whether the workers shall stop.
+    bool stopping = false;
+
+    /// Holds the first exception thrown while recording the current batch.
+    std::exception_ptr error;
+
+    /// Holds the function, which calls the user's recording function stored in `task_context`.
+    void (*task)(void const*, std::size_t, CommandQueue::Builder&) = nullptr;
+
+    /// Holds a pointer to the user's recording function.
+    void const* task_context = nullptr;
+
+    /// Holds the number of parts in the current batch.
+    std::size_t part_count = 0u;
+
+    /// Holds the index of the next part to be recorded.
+    std::atomic<std::size_t> next_part{0u};
+
+    /// Holds the recorded parts of the current batch.
+    std::vector<CommandQueue> parts;
+};
+
+} // namespace v1
+} // namespace nest
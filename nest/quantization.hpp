@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include <nest/packed_types.hpp>
+#include <nest/vertex_traits.hpp>
+
+namespace nest {
+inline namespace v1 {
+
+/// Holds the largest absolute error per component introduced by quantizing vertices, per attribute.
+struct QuantizationError {
+    float position = 0.f;
+    float color = 0.f;
+    float texcoord = 0.f;
+};
+
+namespace detail {
+
+/// Holds a boolean value which specifies whether the given type `T` is a vector of 32-bit floats.
+/// @{
+// clang-format off
+template <typename T> static constexpr bool is_float_vector = false;
+
+template <std::size_t N> constexpr bool is_float_vector<float[N]>  = true;
+template <>              constexpr bool is_float_vector<glm::vec2> = true;
+template <>              constexpr bool is_float_vector<glm::vec3> = true;
+template <>              constexpr bool is_float_vector<glm::vec4> = true;
+// clang-format on
+/// @}
+
+/// The compact type an attribute of the given type `T` is quantized into. Colors become normalized bytes, other float
+/// vectors become half floats, and the rest is kept as is.
+template <typename T, bool IsColor = false>
+using Quantized =
+    std::conditional_t<is_float_vector<T>, std::conditional_t<IsColor, Unorm8, Half>[component_count<T>], T>;
+
+/// \returns The size of the given attribute type `T` rounded up to 4 bytes, since attributes should be 4-byte aligned.
+template <typename T>
+constexpr std::size_t padded_size()
+{
+    return (sizeof(T) + 3u) / 4u * 4u;
+}
+
+/// Describes the compact layout the given `Vertex` type is quantized into: its attributes are packed one after
+/// another in the `position`, `color`, `texcoord` order.
+template <typename Vertex>
+struct QuantizedLayout final {
+    // clang-format off
+    static constexpr std::size_t position_size = [] {
+        if constexpr (has_position<Vertex>) { return padded_size<Quantized<decltype(Vertex::position)>>(); }
+        else                                { return std::size_t{0u}; }
+    }();
+
+    static constexpr std::size_t color_size = [] {
+        if constexpr (has_color<Vertex>)    { return padded_size<Quantized<decltype(Vertex::color), true>>(); }
+        else                                { return std::size_t{0u}; }
+    }();
+
+    static constexpr std::size_t texcoord_size = [] {
+        if constexpr (has_texcoord<Vertex>) { return padded_size<Quantized<decltype(Vertex::texcoord)>>(); }
+        else                                { return std::size_t{0u}; }
+    }();
+
+    static constexpr std::size_t position_offset = 0u;
+    static constexpr std::size_t color_offset    = position_offset + position_size;
+    static constexpr std::size_t texcoord_offset = color_offset + color_size;
+    static constexpr std::size_t stride          = texcoord_offset + texcoord_size;
+    // clang-format on
+};
+
+/// Writes the given `attribute` quantized into the `Target` type at the given `destination`.
+/// \returns The largest absolute error per component.
+template <typename Target, typename T>
+float quantize_attribute(T const& attribute, std::byte* const destination)
+{
+    if constexpr (std::is_same_v<Target, T>) {
+        std::memcpy(destination, &attribute, sizeof(T));
+        return 0.f;
+    }
+    else {
+        using Component = std::remove_extent_t<Target>;
+
+        Target quantized;
+        auto error = 0.f;
+        for (std::size_t i = 0u; i < component_count<T>; ++i) {
+            auto const value = static_cast<float>(attribute[static_cast<int>(i)]);
+            quantized[i] = Component(value);
+            error = std::max(error, std::abs(static_cast<float>(quantized[i]) - value));
+        }
+        std::memcpy(destination, &quantized, sizeof(Target));
+        return error;
+    }
+}
+
+/// Quantizes the vertices in the [`begin`, `end`) range into the `QuantizedLayout` of their type, and stores them in
+/// the given `data`.
+/// \returns The largest errors introduced by the quantization.
+template <typename T> // T models RandomAccessIterator
+QuantizationError quantize_vertices(T begin, T end, std::vector<std::byte>& data)
+{
+    using Vertex = typename std::iterator_traits<T>::value_type;
+    using Layout = QuantizedLayout<Vertex>;
+
+    data.assign(static_cast<std::size_t>(end - begin) * Layout::stride, std::byte{0});
+
+    QuantizationError error;
+    auto destination = data.data();
+    for (auto it = begin; it != end; ++it, destination += Layout::stride) {
+        if constexpr (has_position<Vertex>) {
+            using Target = Quantized<decltype(Vertex::position)>;
+            auto const position = quantize_attribute<Target>(it->position, destination + Layout::position_offset);
+            error.position = std::max(error.position, position);
+        }
+
+        if constexpr (has_color<Vertex>) {
+            using Target = Quantized<decltype(Vertex::color), true>;
+            auto const color = quantize_attribute<Target>(it->color, destination + Layout::color_offset);
+            error.color = std::max(error.color, color);
+        }
+
+        if constexpr (has_texcoord<Vertex>) {
+            using Target = Quantized<decltype(Vertex::texcoord)>;
+            auto const texcoord = quantize_attribute<Target>(it->texcoord, destination + Layout::texcoord_offset);
+            error.texcoord = std::max(error.texcoord, texcoord);
+        }
+    }
+
+    return error;
+}
+
+} // namespace detail
+} // namespace v1
+} // namespace nest
@@ -1,16 +1,69 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <optional>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <nest/bounded_queue.hpp>
+#include <nest/frame_pacer.hpp>
+#include <nest/sort_key.hpp>
+
 namespace nest {
 inline namespace v1 {
 
+namespace detail {
+
+/// A fence for contexts, which can't tell when the GPU has finished a frame. It is always signaled.
+struct NullFence final {
+    bool wait(std::chrono::nanoseconds)
+    {
+        return true;
+    }
+};
+
+/// Holds a boolean value which specifies whether the given context type `T` can insert fences.
+/// @{
+template <typename T, typename = void>
+static constexpr bool has_fences = false;
+
+template <typename T>
+constexpr bool has_fences<T, std::void_t<decltype(std::declval<T&>().insert_fence())>> = true;
+/// @}
+
+/// \returns A fence inserted into the command stream of the given context, or a `NullFence` if the context can't
+/// insert fences.
+template <typename Context>
+auto insert_fence(Context& ctx)
+{
+    if constexpr (has_fences<Context>) {
+        return ctx.insert_fence();
+    }
+    else {
+        return NullFence{};
+    }
+}
+
+/// Holds the type of fences inserted by the given context type.
+template <typename Context>
+using fence_type = decltype(insert_fence(std::declval<Context&>()));
+
+} // namespace detail
+
 /// A class for executing renderer commands on seprate thread.
 class AsyncRenderer final {
   public:
@@ -19,6 +72,14 @@ class AsyncRenderer final {
 
     /// A class for storing commands in a queue. Instances of this class are immutable, use the nested `Builder` class
     /// to construct them.
+    ///
+    /// Commands are stored inline in a list of contiguous memory blocks. Every command is preceded by a small header,
+    /// which holds pointers to the functions for invoking and destroying the command. Appending a command is a bump of
+    /// the current block's size, so the heap is only touched when a block is exhausted.
+    ///
+    /// Commands enqueued with a `SortKey` may be reordered: every run of them is sorted by key before execution, which
+    /// groups together draws sharing GPU state. Commands enqueued without a key keep their place, and act as barriers
+    /// the keyed ones are never moved across.
     class CommandQueue final {
       public:
         class Builder;
@@ -26,34 +87,311 @@ class AsyncRenderer final {
         /// Constructs an empty queue of commands.
         CommandQueue() noexcept = default;
 
+        CommandQueue(CommandQueue const&) = delete;
+        CommandQueue(CommandQueue&& that) noexcept
+        {
+            swap(that);
+        }
+
+        /// Destroys the enqueued commands.
+        ~CommandQueue() noexcept
+        {
+            for_each_record([](Record* record) {
+                if (record->destroy) {
+                    record->destroy(record);
+                }
+            });
+        }
+
+        CommandQueue& operator=(CommandQueue const&) = delete;
+        CommandQueue& operator=(CommandQueue&& that) noexcept
+        {
+            swap(that);
+            return *this;
+        }
+
+        /// Swaps contents of this `CommandQueue` with `that` one.
+        void swap(CommandQueue& that) noexcept
+        {
+            std::swap(blocks, that.blocks);
+            std::swap(num_sorted, that.num_sorted);
+            std::swap(schedule, that.schedule);
+        }
+
+        /// \returns `true` when there are no commands in the queue, `false` otherwise.
+        bool empty() const noexcept
+        {
+            return blocks.empty();
+        }
+
         /// Executes commands in the queue.
         void execute()
+        {
+            if (!schedule.empty()) {
+                std::for_each(begin(schedule), end(schedule), invoke);
+            }
+            else {
+                for_each_record_in_order(invoke);
+            }
+        }
+
+        /// Sorts the commands once, so the following executions don't have to. This pays off for queues executed many
+        /// times, see `RetainedQueue`.
+        void presort()
+        {
+            if (num_sorted && schedule.empty()) {
+                for_each_record_in_order([this](Record* record) { schedule.push_back(record); });
+            }
+        }
+
+      private:
+        /// A header which precedes every command stored in a block.
+        struct Record {
+            /// Holds a pointer to the function which invokes the command.
+            void (*invoke)(Record*);
+
+            /// Holds a pointer to the function which destroys the command, or `nullptr` when the command is trivially
+            /// destructible.
+            void (*destroy)(Record*) noexcept;
+
+            /// Holds the sort key of the command.
+            std::uint64_t key;
+
+            /// Holds the distance in bytes from this record to the next one.
+            std::uint32_t size;
+
+            /// Holds a boolean which specifies whether the command may be reordered according to its `key`.
+            bool sorted;
+        };
+
+        /// A record along with its sort key, which is what gets sorted.
+        struct SortItem {
+            std::uint64_t key;
+            Record* record;
+        };
+
+        /// Invokes the command of the given `record`.
+        static void invoke(Record* record)
         {
             // Current strategy is not to break execution when an exception gets thrown by a command.
             // TODO: figure out if this strategy is wrong or if it's desirable to support other strategies as well.
 
-            std::for_each(begin(commands), end(commands), [](auto& fn) {
-                try {
-                    fn();
+            try {
+                record->invoke(record);
+            }
+            catch (...) {
+                // TODO: report an error.
+            }
+        }
+
+        /// \returns One of the two buffers used for sorting on the calling thread. They are kept around, so sorting
+        /// doesn't allocate memory once the buffers have grown big enough. See `for_each_record_in_order`.
+        static std::vector<SortItem>& sort_buffer(std::size_t const index)
+        {
+            static thread_local std::vector<SortItem> buffers[2];
+            return buffers[index];
+        }
+
+        /// A contiguous chunk of memory, which holds records and their commands.
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t capacity = 0u;
+            std::size_t size = 0u;
+        };
+
+        /// Holds the default capacity of a block in bytes. Commands larger than this get a block of their own.
+        static constexpr std::size_t BlockCapacity = 64u * 1024u;
+
+        /// \returns `value` rounded up to the nearest multiple of `alignment`, which must be a power of two.
+        static constexpr std::size_t align_up(std::size_t const value, std::size_t const alignment) noexcept
+        {
+            return (value + alignment - 1u) & ~(alignment - 1u);
+        }
+
+        /// \returns The offset of a command of type `F` relative to its record.
+        template <typename F>
+        static constexpr std::size_t payload_offset() noexcept
+        {
+            return align_up(sizeof(Record), alignof(F));
+        }
+
+        /// \returns A pointer to the storage of a command of type `F`, which follows the given `record`.
+        template <typename F>
+        static void* payload_address(void* record) noexcept
+        {
+            return static_cast<std::byte*>(record) + payload_offset<F>();
+        }
+
+        /// \returns A pointer to the command of type `F`, which is stored after the given `record`.
+        template <typename F>
+        static F* payload(Record* record) noexcept
+        {
+            return std::launder(static_cast<F*>(payload_address<F>(record)));
+        }
+
+        /// Constructs a command of type `F` with the given `command` at the end of the queue. The command is reordered
+        /// according to `key` unless the key is empty.
+        template <typename F, typename T>
+        void emplace(T&& command, std::optional<SortKey> const key = std::nullopt)
+        {
+            static_assert(alignof(F) <= alignof(std::max_align_t), "Over-aligned commands are not supported.");
+
+            auto const size = align_up(payload_offset<F>() + sizeof(F), alignof(Record));
+
+            if (blocks.empty() || blocks.back().capacity - blocks.back().size < size) {
+                auto const capacity = std::max(size, BlockCapacity);
+                blocks.push_back(Block{std::make_unique<std::byte[]>(capacity), capacity, 0u});
+            }
+
+            auto& block = blocks.back();
+            auto const address = block.data.get() + block.size;
+
+            // The block's size is bumped only after the command is constructed, so a throwing constructor leaves the
+            // queue intact.
+            new (payload_address<F>(address)) F(std::forward<T>(command));
+
+            auto const record = new (address) Record;
+            record->invoke = [](Record* record) { (*payload<F>(record))(); };
+            if constexpr (std::is_trivially_destructible_v<F>) {
+                record->destroy = nullptr;
+            }
+            else {
+                record->destroy = [](Record* record) noexcept { payload<F>(record)->~F(); };
+            }
+            record->key = key ? key->value : 0u;
+            record->size = static_cast<std::uint32_t>(size);
+            record->sorted = key.has_value();
+
+            block.size += size;
+            num_sorted += record->sorted;
+        }
+
+        /// Moves all the commands of `that` queue to the end of this one. The blocks are handed over, so no command is
+        /// copied or moved.
+        void append(CommandQueue&& that)
+        {
+            if (blocks.empty()) {
+                swap(that);
+                return;
+            }
+
+            blocks.insert(end(blocks), std::make_move_iterator(begin(that.blocks)),
+                          std::make_move_iterator(end(that.blocks)));
+            num_sorted += that.num_sorted;
+            schedule.clear();
+
+            that.blocks.clear();
+            that.num_sorted = 0u;
+            that.schedule.clear();
+        }
+
+        /// Calls `fn` with every record in the queue, in the order of their execution.
+        template <typename F>
+        void for_each_record_in_order(F&& fn)
+        {
+            if (!num_sorted) {
+                for_each_record(fn);
+                return;
+            }
+
+            // The buffers are taken from the thread for the duration of the call, so a command which executes another
+            // queue gets buffers of its own rather than the ones being iterated.
+            std::vector<SortItem> run;
+            std::vector<SortItem> scratch;
+            run.swap(sort_buffer(0u));
+            scratch.swap(sort_buffer(1u));
+
+            auto const flush = [&run, &scratch, &fn] {
+                detail::radix_sort(run, scratch);
+                for (auto const& item : run) {
+                    fn(item.record);
                 }
-                catch (...) {
-                    // TODO: report an error.
+                run.clear();
+            };
+
+            for_each_record([&run, &flush, &fn](Record* record) {
+                if (record->sorted) {
+                    run.push_back({record->key, record});
+                }
+                else {
+                    flush();
+                    fn(record);
                 }
             });
+            flush();
+
+            sort_buffer(0u).swap(run);
+            sort_buffer(1u).swap(scratch);
         }
 
-      private:
-        /// Holds the enqueued commands.
-        std::vector<Command> commands;
+        /// Calls `fn` with every record in the queue, in the order of their appearance.
+        template <typename F>
+        void for_each_record(F&& fn)
+        {
+            for (auto& block : blocks) {
+                for (std::size_t offset = 0u; offset < block.size;) {
+                    auto const record = std::launder(reinterpret_cast<Record*>(block.data.get() + offset));
+                    offset += record->size;
+                    fn(record);
+                }
+            }
+        }
+
+        /// Holds the blocks with enqueued commands.
+        std::vector<Block> blocks;
+
+        /// Holds the number of commands, which may be reordered.
+        std::size_t num_sorted = 0u;
+
+        /// Holds the records in the order of their execution, if the queue has been presorted.
+        std::vector<Record*> schedule;
     };
 
-    /// Constructs a renderer instance with the given context.
+    /// Holds timings of a single frame, measured from the moment the frame's first queue was submitted.
+    struct FrameTimings {
+        /// Holds the time the first queue waited for the renderer thread.
+        std::chrono::nanoseconds started{};
+
+        /// Holds the time until the renderer thread finished executing the commands of the frame's last queue.
+        std::chrono::nanoseconds executed{};
+
+        /// Holds the time until the GPU finished the frame. Equals to `executed` unless the context supports fences.
+        std::chrono::nanoseconds completed{};
+    };
+
+    /// Specifies whether a submitted queue ends a frame, or the frame continues with the following queues.
+    enum class Frame { End, Continue };
+
+    /// An empty set of parameters of a `RetainedQueue`.
+    struct NoParameters {
+    };
+
+    template <typename Parameters = NoParameters>
+    class RetainedQueue;
+
+    /// Holds the maximum size of the parameters of a `RetainedQueue` in bytes.
+    static constexpr std::size_t MaxParameterSize = 256u;
+
+    /// Holds the default number of command queues which can be submitted, but not yet executed.
+    static constexpr std::size_t DefaultCapacity = 64u;
+
+    /// Holds the maximum number of frames the GPU may lag behind the game.
+    static constexpr std::size_t MaxFramesInFlight = 3u;
+
+    /// Holds the default number of frames the GPU may lag behind the game.
+    static constexpr std::size_t DefaultFramesInFlight = 2u;
+
+    /// Constructs a renderer instance with the given context. At most `capacity` submitted queues may wait for
+    /// execution, further submissions are subject to backpressure.
+    ///
+    /// When the context provides `insert_fence()`, a frame is in flight until the GPU has finished it, otherwise until
+    /// the renderer thread has executed its commands.
     template <typename Context>
-    AsyncRenderer(Context&& ctx)
+    AsyncRenderer(Context&& ctx, std::size_t const capacity = DefaultCapacity) : queues(capacity)
     {
         thread = std::thread([this, ctx = std::move(ctx)]() mutable {
             ctx.make_current();
-            loop();
+            loop(ctx);
         });
     }
 
@@ -61,54 +399,335 @@ class AsyncRenderer final {
     {
         running.store(false);
 
-        awake.notify_one();
+        wake_up();
+        wake_up_submitters();
 
         if (thread.joinable()) {
             thread.join();
         }
     }
 
-    /// Submits the given command queue for execution.
-    void submit(CommandQueue&& queue)
+    /// Submits the given command queue for execution. A frame is made of the queues submitted with `Frame::Continue`
+    /// followed by the one submitted with `Frame::End`, so by default every queue is a frame of its own. Blocks while
+    /// the renderer has `capacity` queues pending, or, if the queue ends a frame, while there are too many frames in
+    /// flight.
+    void submit(CommandQueue&& queue, Frame const frame = Frame::End)
+    {
+        Submission submission{std::move(queue), nullptr, nullptr, 0u, Frame::End == frame, Clock::time_point{}};
+        submit(submission);
+    }
+
+    /// Submits the given command queue for execution without blocking. See `submit`.
+    /// \returns `true` on success, `false` when the renderer has `capacity` queues pending, or the queue ends a frame
+    /// and there are too many frames in flight. In the latter case `queue` is left untouched, so the caller may drop it
+    /// or retry later.
+    bool try_submit(CommandQueue&& queue, Frame const frame = Frame::End)
+    {
+        Submission submission{std::move(queue), nullptr, nullptr, 0u, Frame::End == frame, Clock::time_point{}};
+        if (!try_submit(submission)) {
+            queue = std::move(submission.queue);
+            return false;
+        }
+        return true;
+    }
+
+    /// Submits the given retained queue for execution, with its parameters set to `parameters`. See `submit`.
+    template <typename Parameters>
+    void submit(RetainedQueue<Parameters> const& queue, Parameters const& parameters = Parameters{},
+                Frame const frame = Frame::End)
+    {
+        auto submission = make_submission(queue, parameters, frame);
+        submit(submission);
+    }
+
+    /// Submits the given retained queue for execution without blocking, with its parameters set to `parameters`. See
+    /// `try_submit`.
+    template <typename Parameters>
+    bool try_submit(RetainedQueue<Parameters> const& queue, Parameters const& parameters = Parameters{},
+                    Frame const frame = Frame::End)
     {
-        std::unique_lock lock(queues_mutex);
-        queues.emplace_back(std::move(queue));
+        auto submission = make_submission(queue, parameters, frame);
+        return try_submit(submission);
+    }
+
+    /// Sets the maximum number of frames the GPU may lag behind the game. The value is clamped to the
+    /// [1, `MaxFramesInFlight`] range: lower values reduce input latency, higher values improve throughput.
+    void set_max_frames_in_flight(std::size_t const value)
+    {
+        max_frames_in_flight.store(std::clamp<std::size_t>(value, 1u, MaxFramesInFlight));
+        wake_up_submitters();
+    }
+
+    /// \returns The maximum number of frames the GPU may lag behind the game.
+    std::size_t get_max_frames_in_flight() const
+    {
+        return max_frames_in_flight.load();
+    }
+
+    /// \returns The number of frames, whose last queue has been submitted, but which have not yet finished.
+    std::size_t get_frames_in_flight() const
+    {
+        return frames_in_flight.load();
+    }
+
+    /// \returns The timings of the most recently finished frame.
+    FrameTimings get_last_frame_timings() const
+    {
+        std::unique_lock lock(timings_mutex);
+        return last_timings;
+    }
+
+    /// \returns The exponential moving average of frame timings.
+    FrameTimings get_average_frame_timings() const
+    {
+        std::unique_lock lock(timings_mutex);
+        return average_timings;
+    }
+
+    /// Sets the maximum `rate` in frames per second at which the renderer thread executes frames. Unlimited by default,
+    /// which suits contexts paced by vsync. A `rate` of zero means unlimited.
+    void set_frame_rate(double const rate)
+    {
+        pacer.set_rate(rate);
+    }
+
+    /// \returns The statistics of frame pacing on the renderer thread.
+    FramePacer::Statistics get_pacing_statistics() const
+    {
+        return pacer.get_statistics();
     }
 
   private:
-    /// 'Infinite' loop which executes renderer commands.
-    void loop()
+    using Clock = std::chrono::steady_clock;
+
+    /// A block of memory for storing parameters of a `RetainedQueue`.
+    struct ParameterBlock {
+        alignas(std::max_align_t) std::byte data[MaxParameterSize];
+    };
+
+    /// The part of a `RetainedQueue` shared with the renderer thread. The parameters are only written to by the
+    /// renderer thread, right before it executes the queue, so the commands can read them without synchronization.
+    struct RetainedState {
+        CommandQueue queue;
+        ParameterBlock parameters;
+    };
+
+    /// A command queue along with the time it was submitted at.
+    struct Submission {
+        /// Holds the submitted queue, unless a retained one was submitted.
+        CommandQueue queue;
+
+        /// Holds the submitted retained queue, if any.
+        std::shared_ptr<RetainedState> retained;
+
+        /// Holds the parameters to be copied into `retained` before it's executed, or `nullptr` if there are none.
+        /// They are kept out of line, so submissions of queues without parameters stay small.
+        std::unique_ptr<ParameterBlock> parameters;
+
+        /// Holds the size of `parameters` in bytes.
+        std::size_t parameter_size = 0u;
+
+        /// Holds a boolean which specifies whether the queue ends a frame.
+        bool ends_frame = true;
+
+        /// Holds the time the submission was made at.
+        Clock::time_point submitted;
+    };
+
+    /// \returns A submission of the given retained `queue` with the given `parameters`.
+    template <typename Parameters>
+    static Submission make_submission(RetainedQueue<Parameters> const& queue, Parameters const& parameters,
+                                      Frame const frame)
+    {
+        Submission submission{CommandQueue{}, queue.state, nullptr, 0u, Frame::End == frame, Clock::time_point{}};
+        if constexpr (!std::is_empty_v<Parameters>) {
+            submission.parameters = std::make_unique<ParameterBlock>();
+            std::memcpy(submission.parameters->data, std::addressof(parameters), sizeof(Parameters));
+            submission.parameter_size = sizeof(Parameters);
+        }
+        return submission;
+    }
+
+    /// Submits the given `submission`, blocking while there is no room for it.
+    void submit(Submission& submission)
     {
-        using std::chrono::high_resolution_clock;
+        if (try_submit(submission)) {
+            return;
+        }
+
+        // Slow path: the renderer is behind, wait until it frees up a slot. `blocked_submitters` is bumped before the
+        // submission is retried under the lock, so the renderer can't miss this thread going to sleep.
+        std::unique_lock lock(space_mutex);
+        blocked_submitters.fetch_add(1u);
+        space_available.wait(lock, [&] { return try_submit(submission) || !running.load(); });
+        blocked_submitters.fetch_sub(1u);
+    }
+
+    /// Submits the given `submission` without blocking.
+    /// \returns `true` on success, `false` when there is no room for it. In the latter case `submission` is left
+    /// untouched.
+    bool try_submit(Submission& submission)
+    {
+        // The frame is accounted for before its last queue is pushed, so the renderer can't retire it before it's
+        // counted.
+        auto const ends_frame = submission.ends_frame;
+        if (ends_frame) {
+            auto in_flight = frames_in_flight.load();
+            do {
+                if (in_flight >= max_frames_in_flight.load()) {
+                    return false;
+                }
+            } while (!frames_in_flight.compare_exchange_weak(in_flight, in_flight + 1u));
+        }
 
-        // Holds the desired duration of a single frame.
-        auto const desired_duration = high_resolution_clock::duration(std::chrono::nanoseconds(1'000'000'000 / 60));
+        submission.submitted = Clock::now();
+        if (!queues.try_push(std::move(submission))) {
+            if (ends_frame) {
+                frames_in_flight.fetch_sub(1u);
+            }
+            return false;
+        }
+
+        // Pairs with the fence in `sleep()`: either the renderer sees the new queue, or this thread sees it sleeping.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) {
+            wake_up();
+        }
+        return true;
+    }
+
+    /// A frame, which has been executed by the renderer thread, but may still be processed by the GPU.
+    template <typename Fence>
+    struct PendingFrame {
+        Fence fence;
+        Clock::time_point submitted;
+        Clock::time_point started;
+        Clock::time_point executed;
+    };
 
+    /// 'Infinite' loop which executes renderer commands.
+    template <typename Context>
+    void loop(Context& ctx)
+    {
         // Holds a zero-length duration.
-        auto const zero_duration = high_resolution_clock::duration::zero();
+        auto const zero_duration = std::chrono::nanoseconds::zero();
+
+        // Holds how long to wait for the GPU before checking for new submissions.
+        auto const fence_timeout = std::chrono::milliseconds(1);
+
+        // Holds the frames, which haven't been finished by the GPU yet, the oldest one first.
+        std::array<PendingFrame<detail::fence_type<Context>>, MaxFramesInFlight> pending;
+        std::size_t num_pending = 0u;
 
-        auto then = high_resolution_clock::now();
+        // Holds the times the first queue of the current frame was submitted and started at, if it has been executed.
+        std::optional<std::pair<Clock::time_point, Clock::time_point>> current_frame;
 
         while (running.load()) {
-            decltype(queues) queues;
-            {
-                std::unique_lock lock(queues_mutex);
-                std::swap(queues, this->queues);
-            }
+            auto popped = false;
+            for (Submission submission; num_pending < pending.size() && queues.try_pop(submission);
+                 submission = Submission{}) {
+                popped = true;
+
+                auto const started = Clock::now();
+                if (!current_frame) {
+                    current_frame.emplace(submission.submitted, started);
+                }
+
+                if (auto const& retained = submission.retained) {
+                    if (submission.parameters) {
+                        std::memcpy(retained->parameters.data, submission.parameters->data, submission.parameter_size);
+                    }
+                    retained->queue.execute();
+                }
+                else {
+                    submission.queue.execute();
+                }
 
-            std::for_each(begin(queues), end(queues), [](auto& q) { q.execute(); });
+                // Only the last queue of a frame is fenced, since the GPU finishes the queues in order.
+                if (submission.ends_frame) {
+                    auto const [submitted, first_started] = *current_frame;
+                    pending[num_pending++] = {detail::insert_fence(ctx), submitted, first_started, Clock::now()};
+                    current_frame.reset();
 
-            auto const now = high_resolution_clock::now();
+                    pacer.wait();
+                }
+            }
 
-            // Specifies how much time passed since last tick.
-            auto const frame_duration = now - then;
+            // Queues, which don't end frames, free up room for the submitters blocked on the capacity.
+            if (popped) {
+                wake_up_submitters();
+            }
 
-            if (auto const mod = frame_duration % desired_duration; zero_duration == mod) {
-                std::unique_lock lock(awake_mutex);
-                awake.wait_for(lock, mod);
+            // Retires the frames finished by the GPU, the oldest one first.
+            std::size_t num_finished = 0u;
+            for (; num_finished < num_pending && pending[num_finished].fence.wait(zero_duration); ++num_finished) {
+                auto const& frame = pending[num_finished];
+                retire_frame(frame.submitted, frame.started, frame.executed);
+            }
+            if (num_finished) {
+                std::move(begin(pending) + num_finished, begin(pending) + num_pending, begin(pending));
+                for (auto i = num_pending - num_finished; i < num_pending; ++i) {
+                    pending[i] = {};
+                }
+                num_pending -= num_finished;
+                wake_up_submitters();
             }
 
-            then = now;
+            if (!num_pending) {
+                sleep();
+                pacer.reset();
+            }
+            else if (queues.empty()) {
+                pending.front().fence.wait(fence_timeout);
+            }
+        }
+    }
+
+    /// Records timings of a finished frame, and stops accounting it as a frame in flight.
+    void retire_frame(Clock::time_point const submitted, Clock::time_point const started,
+                      Clock::time_point const executed)
+    {
+        FrameTimings const timings{started - submitted, executed - submitted, Clock::now() - submitted};
+        {
+            std::unique_lock lock(timings_mutex);
+
+            // Weights the latest frame by 1/16.
+            auto const smooth = [](auto average, auto latest) { return average + (latest - average) / 16; };
+
+            last_timings = timings;
+            average_timings.started = smooth(average_timings.started, timings.started);
+            average_timings.executed = smooth(average_timings.executed, timings.executed);
+            average_timings.completed = smooth(average_timings.completed, timings.completed);
+        }
+        frames_in_flight.fetch_sub(1u);
+    }
+
+    /// Puts the thread to sleep until a queue gets submitted or the renderer is shutting down.
+    void sleep()
+    {
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(awake_mutex);
+            awake.wait(lock, [this] { return !queues.empty() || !running.load(); });
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    /// Wakes the thread up. The mutex is locked so the notification can't slip in between the thread checking its
+    /// wait condition and going to sleep.
+    void wake_up()
+    {
+        std::unique_lock lock(awake_mutex);
+        awake.notify_one();
+    }
+
+    /// Wakes up the threads blocked in `submit`, if there are any.
+    void wake_up_submitters()
+    {
+        if (blocked_submitters.load() > 0u || !running.load()) {
+            std::unique_lock lock(space_mutex);
+            space_available.notify_all();
         }
     }
 
@@ -122,11 +741,38 @@ class AsyncRenderer final {
     /// Is used to wake up the thread.
     std::condition_variable awake;
 
-    /// Holds a handle to a mutex which protects `queues`.
-    std::mutex queues_mutex;
+    /// Holds a boolean which specifies whether the thread is sleeping, or is about to, on `awake`.
+    std::atomic_bool sleeping{false};
 
     /// Holds the queues, submitted for execution.
-    std::vector<CommandQueue> queues;
+    BoundedQueue<Submission> queues;
+
+    /// Holds a handle to a mutex which protects `space_available`.
+    std::mutex space_mutex;
+
+    /// Is used to wake up the threads blocked in `submit`.
+    std::condition_variable space_available;
+
+    /// Holds the number of threads blocked in `submit`.
+    std::atomic<std::size_t> blocked_submitters{0u};
+
+    /// Holds the number of frames, which have been submitted, but not yet finished.
+    std::atomic<std::size_t> frames_in_flight{0u};
+
+    /// Holds the maximum number of frames in flight.
+    std::atomic<std::size_t> max_frames_in_flight{DefaultFramesInFlight};
+
+    /// Paces the renderer thread.
+    FramePacer pacer{0.0};
+
+    /// Holds a handle to a mutex which protects `last_timings` and `average_timings`.
+    mutable std::mutex timings_mutex;
+
+    /// Holds the timings of the most recently finished frame.
+    FrameTimings last_timings;
+
+    /// Holds the exponential moving average of frame timings.
+    FrameTimings average_timings;
 
     /// Holds a boolean which specifies whether the thread shall be running.
     std::atomic_bool running{true};
@@ -135,14 +781,41 @@ class AsyncRenderer final {
 /// A class for constructing instances of `CommandQueue` class.
 class AsyncRenderer::CommandQueue::Builder final {
   public:
-    /// Appends a new command into the queue. The command is constructed with the given arguments.
-    template <typename... T>
-    Builder& enqueue(T&&... args)
+    /// Appends a new command into the queue. The command is any callable object, which can be invoked without
+    /// arguments; it is stored inline in the queue, so enqueueing it doesn't allocate memory on its own.
+    template <typename T>
+    Builder& enqueue(T&& command)
+    {
+        queue.emplace<std::decay_t<T>>(std::forward<T>(command));
+        return *this;
+    }
+
+    /// Appends a new draw command into the queue. The renderer may reorder it with the adjacent commands, which have
+    /// been enqueued with a key as well, so that the draws are executed in the order of their keys. Draws with equal
+    /// keys keep their relative order.
+    template <typename T>
+    Builder& enqueue(SortKey const key, T&& command)
+    {
+        queue.emplace<std::decay_t<T>>(std::forward<T>(command), key);
+        return *this;
+    }
+
+    /// Appends all the commands of the given `commands` queue, leaving the latter empty. This is how queues recorded on
+    /// different threads are merged: the commands stay where they are in memory, so the cost doesn't depend on their
+    /// number.
+    Builder& append(CommandQueue&& commands)
     {
-        queue.commands.emplace_back(std::forward<T>(args)...);
+        queue.append(std::move(commands));
         return *this;
     }
 
+    /// Appends a barrier into the queue. The commands enqueued with a key before the barrier are executed before the
+    /// ones enqueued after it.
+    Builder& barrier()
+    {
+        return enqueue([] {});
+    }
+
     /// \returns The constructed `CommandQueue` instance.
     operator CommandQueue()
     {
@@ -154,5 +827,43 @@ class AsyncRenderer::CommandQueue::Builder final {
     CommandQueue queue;
 };
 
+/// A class for a command queue, which is recorded once and can be submitted any number of times, e.g. every frame.
+///
+/// Instead of being re-recorded, a retained queue is patched with a small block of `Parameters`, such as transforms or
+/// uniform values, which is passed along with every submission. The commands read the parameters through a pointer
+/// given to them at recording. The renderer copies the submitted parameters right before it executes the queue, so
+/// the commands always see the parameters of the submission being executed.
+template <typename Parameters>
+class AsyncRenderer::RetainedQueue final {
+    static_assert(std::is_trivially_copyable_v<Parameters>, "Parameters must be trivially copyable.");
+    static_assert(sizeof(Parameters) <= MaxParameterSize, "Parameters must fit into MaxParameterSize bytes.");
+    static_assert(alignof(Parameters) <= alignof(std::max_align_t), "Over-aligned parameters are not supported.");
+
+  public:
+    /// Records the queue by calling `record(parameters, builder)`, where `parameters` is a `Parameters const*` the
+    /// commands should read their parameters from, and `builder` is the builder to record the commands into. The
+    /// parameters are initialized with `initial` until the first submission.
+    template <typename F, // F models void(Parameters const* parameters, CommandQueue::Builder& builder)
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, RetainedQueue>>>
+    explicit RetainedQueue(F&& record, Parameters const& initial = Parameters{})
+        : state(std::make_shared<RetainedState>())
+    {
+        auto const parameters = new (state->parameters.data) Parameters(initial);
+
+        CommandQueue::Builder builder;
+        record(static_cast<Parameters const*>(parameters), builder);
+
+        state->queue = builder;
+        state->queue.presort();
+    }
+
+  private:
+    friend class AsyncRenderer;
+
+    /// Holds the state shared with the renderer thread. It stays alive while the queue is in flight, even if this
+    /// `RetainedQueue` is destroyed.
+    std::shared_ptr<RetainedState> state;
+};
+
 } // namespace v1
 } // namespace nest
@@ -3,9 +3,13 @@
 #include <nest/config.hpp>
 
 #if NEST_RENDERER == NEST_RENDERER_OPENGL
+#include <nest/opengl/background_uploader.hpp>
 #include <nest/opengl/context.hpp>
 #include <nest/opengl/mesh.hpp>
+#include <nest/opengl/pipeline_state.hpp>
+#include <nest/opengl/shader_permutations.hpp>
 #include <nest/opengl/shader_program.hpp>
+#include <nest/opengl/uniform_ring.hpp>
 #endif
 
 namespace nest {
@@ -29,6 +33,38 @@ OpenGL make_renderer_context(std::string const& title, int width, int height)
         .with(nest::OpenGL::DoubleBuffering::On);
 }
 
+/// Creates a context, which shares objects with the given default `context`, e.g. for a `BackgroundUploader`. The
+/// context is of the same version and profile, and draws nothing. A windowed `context` must be current on the calling
+/// thread.
+inline OpenGL make_shared_renderer_context(OpenGL const& context)
+{
+    return OpenGL::Builder{}
+        .with_shared_objects(context)
+        .with_color(8, 8, 8, 8)
+        .with_depth_and_stencil(24, 8)
+        .with_version(4, 1)
+        .with(nest::OpenGL::Profile::Core);
+}
+
+#if NEST_OPENGL_HEADLESS
+
+/// Creates default headless OpenGL context, which needs neither a display nor a GPU, with the following attributes:
+///     - offscreen framebuffer of the given dimensions;
+///     - RGBA color buffer, 8-bits per channel;
+///     - 24-bit depth and 8-bit stencil buffers;
+///     - OpenGL 4.1 core profile.
+inline OpenGL make_headless_renderer_context(int width, int height)
+{
+    return OpenGL::Builder{}
+        .with_headless(width, height)
+        .with_color(8, 8, 8, 8)
+        .with_depth_and_stencil(24, 8)
+        .with_version(4, 1)
+        .with(nest::OpenGL::Profile::Core);
+}
+
+#endif
+
 #endif
 
 } // namespace v1
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace nest {
+inline namespace v1 {
+
+/// A 64-bit key, which orders draw commands so that the ones sharing GPU state end up next to each other. Smaller keys
+/// are drawn first.
+///
+/// Opaque draws are grouped by shader program, then by mesh, then sorted front to back. Translucent draws come after
+/// the opaque ones of the same layer and are sorted back to front, which is required for correct blending:
+///
+///     opaque:      | layer:6 | 0 | program:16 | mesh:16 | depth:24  | 0 |
+///     translucent: | layer:6 | 1 | ~depth:24  | program:16 | mesh:16 | 0 |
+///
+/// Handles wider than 16 bits are truncated, which only affects the quality of sorting, never its correctness. The
+/// program may as well be the id of an interned `PipelineState`, which groups draws by all of their state.
+struct SortKey final {
+    /// Holds the number of layers, which can be encoded in a key.
+    static constexpr unsigned LayerCount = 64u;
+
+    /// Holds the value of the key.
+    std::uint64_t value = 0u;
+
+    /// \returns A key for a draw command in the given `layer` with the given `program` and `mesh` handles. The `depth`
+    /// is the normalized view-space depth of the drawn object in the [0, 1] range.
+    static SortKey make(unsigned const layer, bool const translucent, std::uint32_t const program,
+                        std::uint32_t const mesh, float const depth)
+    {
+        auto const quantized_depth = static_cast<std::uint64_t>(std::clamp(depth, 0.f, 1.f) * 0xFF'FFFF) & 0xFF'FFFFu;
+
+        // clang-format off
+        std::uint64_t value = (static_cast<std::uint64_t>(layer % LayerCount) << 58u)
+                            | (static_cast<std::uint64_t>(translucent)        << 57u);
+
+        if (!translucent) {
+            value |= (static_cast<std::uint64_t>(program & 0xFFFFu) << 41u)
+                   | (static_cast<std::uint64_t>(mesh    & 0xFFFFu) << 25u)
+                   | (quantized_depth                               <<  1u);
+        }
+        else {
+            value |= ((0xFF'FFFFu - quantized_depth)                << 33u)
+                   | (static_cast<std::uint64_t>(program & 0xFFFFu) << 17u)
+                   | (static_cast<std::uint64_t>(mesh    & 0xFFFFu) <<  1u);
+        }
+        // clang-format on
+
+        return SortKey{value};
+    }
+};
+
+namespace detail {
+
+/// Sorts `items` by their `key` field in ascending order. The sort is stable, so items with equal keys keep their
+/// relative order. `scratch` is used as temporary storage; both vectors keep their capacity, so sorting doesn't
+/// allocate once they have grown big enough.
+///
+/// Short ranges are insertion sorted. Longer ones are LSD radix sorted one byte per pass, skipping the passes where all
+/// keys share the same byte, which is common since the upper bytes of keys vary little within a frame.
+template <typename T> // T has a std::uint64_t `key` field
+void radix_sort(std::vector<T>& items, std::vector<T>& scratch)
+{
+    constexpr std::size_t InsertionSortThreshold = 64u;
+
+    auto const num_items = items.size();
+
+    if (num_items < InsertionSortThreshold) {
+        for (std::size_t i = 1u; i < num_items; ++i) {
+            auto item = std::move(items[i]);
+            auto j = i;
+            for (; j > 0u && item.key < items[j - 1u].key; --j) {
+                items[j] = std::move(items[j - 1u]);
+            }
+            items[j] = std::move(item);
+        }
+        return;
+    }
+
+    // Counts occurrences of every byte value at every byte position in a single pass over the keys.
+    std::array<std::array<std::size_t, 256u>, sizeof(std::uint64_t)> counts{};
+    for (auto const& item : items) {
+        for (std::size_t pass = 0u; pass < counts.size(); ++pass) {
+            ++counts[pass][(item.key >> (pass * 8u)) & 0xFFu];
+        }
+    }
+
+    scratch.resize(num_items);
+
+    for (std::size_t pass = 0u; pass < counts.size(); ++pass) {
+        auto& offsets = counts[pass];
+        auto const shift = pass * 8u;
+
+        if (offsets[(items.front().key >> shift) & 0xFFu] == num_items) {
+            continue;
+        }
+
+        std::size_t offset = 0u;
+        for (auto& count : offsets) {
+            offset += std::exchange(count, offset);
+        }
+
+        for (auto& item : items) {
+            scratch[offsets[(item.key >> shift) & 0xFFu]++] = std::move(item);
+        }
+
+        std::swap(items, scratch);
+    }
+}
+
+} // namespace detail
+
+} // namespace v1
+} // namespace nest
@@ -7,6 +7,7 @@
 #include <glm/glm.hpp>
 
 #include <nest/config.hpp>
+#include <nest/packed_types.hpp>
 
 #if NEST_RENDERER == NEST_RENDERER_OPENGL
 #include <nest/opengl/vertex_traits.hpp>
@@ -42,7 +43,26 @@ template <typename T>
 constexpr bool has_texcoord<T, std::void_t<decltype(std::declval<T>().texcoord)>> = true;
 /// @}
 
-/// Holds a numeric value which represents the number of components per vertex attribute.
+/// Holds a boolean value which specifies whether the given type `T` has a field named `transform`.
+/// @{
+template <typename T, typename = void>
+static constexpr bool has_transform = false;
+
+template <typename T>
+constexpr bool has_transform<T, std::void_t<decltype(std::declval<T>().transform)>> = true;
+/// @}
+
+/// Holds a boolean value which specifies whether the given type `T` has a field named `tint`.
+/// @{
+template <typename T, typename = void>
+static constexpr bool has_tint = false;
+
+template <typename T>
+constexpr bool has_tint<T, std::void_t<decltype(std::declval<T>().tint)>> = true;
+/// @}
+
+/// Holds a numeric value which represents the number of components per vertex attribute. Matrices take an attribute
+/// per column, so this is the number of components per column for them.
 /// @{
 // clang-format off
 template<typename T> static constexpr std::size_t component_count = 1u;
@@ -60,6 +80,31 @@ template<>                          constexpr std::size_t component_count<glm::i
 template<>                          constexpr std::size_t component_count<glm::uvec2> = 2u;
 template<>                          constexpr std::size_t component_count<glm::uvec3> = 3u;
 template<>                          constexpr std::size_t component_count<glm::uvec4> = 4u;
+template<>                          constexpr std::size_t component_count<glm::mat3>  = 3u;
+template<>                          constexpr std::size_t component_count<glm::mat4>  = 4u;
+template<>                          constexpr std::size_t component_count<Snorm2101010> = 4u;
+// clang-format on
+/// @}
+
+/// Holds a boolean value which specifies whether a vertex attribute of the given type `T` is read as normalized
+/// floats.
+/// @{
+// clang-format off
+template<typename T> static constexpr bool is_normalized = false;
+
+template<typename T, std::size_t N> constexpr bool is_normalized<T[N]>          = is_normalized<T>;
+template<typename T>                constexpr bool is_normalized<Normalized<T>> = true;
+template<>                          constexpr bool is_normalized<Snorm2101010>  = true;
+// clang-format on
+/// @}
+
+/// Holds a numeric value which represents the number of attribute slots a vertex attribute takes.
+/// @{
+// clang-format off
+template<typename T> static constexpr std::size_t slot_count = 1u;
+
+template<>           constexpr std::size_t slot_count<glm::mat3> = 3u;
+template<>           constexpr std::size_t slot_count<glm::mat4> = 4u;
 // clang-format on
 /// @}
 
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nest/asset_streamer.hpp>
+#include <nest/renderer.hpp>
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/asset_streamer.cpp \
+        -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output, the timings vary from machine to machine:
+
+    Without a budget: 32 meshes uploaded in the first frame, which took <T1> ms
+    With a budget of 1 MB per frame: 1 mesh uploaded per frame over 32 frames, the longest frame took <T2> ms
+    The longest frame with a budget is shorter: yes
+    Streamed meshes have their vertices: yes
+    Failed decodes are reported: yes
+    Assets abandoned by a destroyed streamer are reported failed: yes
+
+Without a budget, all the assets decoded while the renderer was busy are uploaded at once, which makes a spike in the
+frame time. The budget spreads the uploads over frames.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+struct Vertex final {
+    glm::vec2 position;
+    glm::vec2 texcoord;
+};
+
+constexpr std::size_t num_meshes = 32u;
+constexpr std::size_t num_vertices = 65'536u;
+
+/// Executes the given `fn` on the renderer thread as a single frame, and waits until it's done.
+template <typename F>
+void run_frame(nest::AsyncRenderer& renderer, F&& fn)
+{
+    std::atomic_bool done{false};
+
+    nest::AsyncRenderer::CommandQueue::Builder builder;
+    builder.enqueue([&] {
+        fn();
+        done.store(true);
+    });
+    renderer.submit(builder);
+
+    while (!done.load()) {
+        std::this_thread::yield();
+    }
+}
+
+/// Streams `num_meshes` meshes of 1 MB each with the given `streamer`. All the meshes are decoded before the first
+/// frame starts uploading them.
+/// \returns The number of meshes uploaded by every frame, and the longest time a frame spent on uploads in ms.
+std::pair<std::vector<std::size_t>, double> stream_meshes(nest::AsyncRenderer& renderer, nest::AssetStreamer& streamer,
+                                                          std::vector<nest::AssetFuture<nest::Mesh>>& meshes)
+{
+    std::atomic<std::size_t> num_decoded{0u};
+    for (std::size_t i = 0u; i < num_meshes; ++i) {
+        meshes.push_back(streamer.stream(
+            [&num_decoded, i] {
+                nest::DecodedAsset<std::vector<Vertex>> decoded;
+                decoded.data.resize(num_vertices);
+                for (std::size_t j = 0u; j < num_vertices; ++j) {
+                    decoded.data[j].position.x = static_cast<float>(i + j);
+                }
+                decoded.size = num_vertices * sizeof(Vertex);
+                num_decoded.fetch_add(1u);
+                return decoded;
+            },
+            [](std::vector<Vertex>&& vertices) -> nest::Mesh {
+                return nest::Mesh::Builder{}.with_vertices(vertices);
+            }));
+    }
+
+    // Gives the workers the time to pass the last decoded meshes to the queue.
+    while (num_decoded.load() < num_meshes) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::size_t> uploaded;
+    auto longest = 0.0;
+    while (streamer.get_pending_count()) {
+        run_frame(renderer, [&] {
+            auto const start = Clock::now();
+            uploaded.push_back(streamer.upload());
+            glFinish();
+            longest = std::max(longest, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        });
+    }
+    return {uploaded, longest};
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+    context.release_current();
+    nest::AsyncRenderer renderer(std::move(context));
+
+    // The meshes are released on the renderer thread, which owns the OpenGL context.
+    std::vector<nest::AssetFuture<nest::Mesh>> meshes;
+
+    double unbudgeted_longest = 0.0;
+    {
+        nest::AssetStreamer streamer(nest::UploadBudget{~std::size_t{0u}, std::chrono::hours(1)});
+        auto const [uploaded, longest] = stream_meshes(renderer, streamer, meshes);
+        std::cout << "Without a budget: " << uploaded.front() << " meshes uploaded in the first frame, which took "
+                  << longest << " ms\n";
+        unbudgeted_longest = longest;
+        run_frame(renderer, [&meshes] { meshes.clear(); });
+    }
+
+    nest::AssetStreamer streamer(nest::UploadBudget{1u << 20u, std::chrono::milliseconds(16)});
+    auto const [uploaded, longest] = stream_meshes(renderer, streamer, meshes);
+    std::cout << "With a budget of 1 MB per frame: "
+              << *std::max_element(uploaded.begin(), uploaded.end()) << " mesh uploaded per frame over "
+              << uploaded.size() << " frames, the longest frame took " << longest << " ms\n";
+    std::cout << "The longest frame with a budget is shorter: " << (longest < unbudgeted_longest ? "yes" : "no")
+              << "\n";
+
+    auto all_ready = true;
+    for (auto const& mesh : meshes) {
+        all_ready = all_ready && mesh.is_ready() && num_vertices == mesh.get().get_vertex_count();
+    }
+    std::cout << "Streamed meshes have their vertices: " << (all_ready ? "yes" : "no") << "\n";
+    run_frame(renderer, [&meshes] { meshes.clear(); });
+
+    auto const failed = streamer.stream(
+        []() -> nest::DecodedAsset<int> { throw std::runtime_error("Cannot read the file."); },
+        [](int&& value) { return value; });
+    while (streamer.get_pending_count()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::cout << "Failed decodes are reported: " << (failed.has_failed() && !failed.is_ready() ? "yes" : "no") << "\n";
+
+    // A single worker fills a queue of 2 assets, and waits for room for the third one, while the rest is still
+    // requested when the streamer is destroyed.
+    std::vector<nest::AssetFuture<int>> abandoned;
+    {
+        nest::AssetStreamer small_streamer({}, 1u, 2u);
+        for (int i = 0; i < 8; ++i) {
+            abandoned.push_back(small_streamer.stream(
+                [] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    return nest::DecodedAsset<int>{1, sizeof(int)};
+                },
+                [](int&& value) { return value; }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    auto const all_failed = std::all_of(abandoned.begin(), abandoned.end(),
+                                        [](auto const& future) { return future.has_failed() && !future.is_ready(); });
+    std::cout << "Assets abandoned by a destroyed streamer are reported failed: " << (all_failed ? "yes" : "no")
+              << "\n";
+
+    return EXIT_SUCCESS;
+}
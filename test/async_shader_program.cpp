@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/async_shader_program.cpp \
+        -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output, the times and the number of frames vary from machine to machine:
+
+    Parallel shader compile supported: yes
+    Blocking build: 32 programs in <N> ms
+    Asynchronous build: 32 programs submitted in <N> ms, ready after <N> ms
+    Frames drawn with the fallback program meanwhile: <N>, all of them correct: yes
+    All programs linked: yes
+    Broken program rejected: yes
+    Compiled program drawn: yes
+
+Every run defines a nonce in the shaders, so that no shader cache of the driver hides the compilation. Drivers, which
+compile on the calling thread despite the extension, e.g. llvmpipe on a single core, have the programs ready right after
+the submission, and draw no frames with the fallback program.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t num_programs = 32u;
+
+/// \returns A builder of the program of the given `variant`, which fills the viewport with the given `color`.
+nest::ShaderProgram::Builder make_builder(std::string const& color, std::size_t const variant)
+{
+    static auto const nonce = std::to_string(Clock::now().time_since_epoch().count() % 1000000);
+
+    nest::ShaderProgram::Builder builder;
+    builder
+        .with_vertex_shader(R"(#version 410
+            void main() {
+                // A triangle covering the viewport.
+                vec2 position = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0;
+                gl_Position = vec4(position, 0.0, 1.0);
+            }
+        )")
+        .with_fragment_shader(R"(#version 410
+            out vec4 color;
+
+            void main() {
+                float noise = 0.0;
+                for (int i = 0; i < VARIANT + 8; ++i) {
+                    noise += sin(float(i) * gl_FragCoord.x + float(NONCE)) * 0.0;
+                }
+                color = COLOR + vec4(noise);
+            }
+        )")
+        .with_define("NONCE", nonce)
+        .with_define("VARIANT", std::to_string(variant))
+        .with_define("COLOR", color);
+    return builder;
+}
+
+/// Draws a frame with the given `program`.
+/// \returns `true` when the center of the frame has the given color, `false` otherwise.
+bool draw(nest::ShaderProgram& program, std::uint8_t const red, std::uint8_t const green)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    program.enable();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    std::uint8_t pixel[4] = {};
+    glReadPixels(32, 32, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    return red == pixel[0] && green == pixel[1] && 0u == pixel[2];
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(64, 64);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Parallel shader compile supported: " << (nest::detail::has_parallel_shader_compile() ? "yes" : "no")
+              << "\n";
+
+    GLuint vao = 0u;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+
+    {
+        auto const start = Clock::now();
+        for (std::size_t i = 0u; i < num_programs; ++i) {
+            nest::ShaderProgram program = make_builder("vec4(0.0, 0.0, 1.0, 1.0)", i);
+        }
+        std::cout << "Blocking build: " << num_programs << " programs in "
+                  << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms\n";
+    }
+
+    nest::ShaderProgram fallback = make_builder("vec4(1.0, 0.0, 0.0, 1.0)", 0u);
+
+    auto const start = Clock::now();
+    std::vector<nest::PendingShaderProgram> pending;
+    for (std::size_t i = 0u; i < num_programs; ++i) {
+        pending.push_back(make_builder("vec4(0.0, 1.0, 0.0, 1.0)", i).build_async());
+    }
+    auto const submitted = Clock::now();
+
+    // Keeps drawing frames with the fallback program until the first program is ready.
+    std::vector<nest::ShaderProgram> programs(num_programs);
+    std::size_t num_ready = 0u;
+    std::size_t num_fallback_frames = 0u;
+    auto fallback_drawn = true;
+    while (num_ready < num_programs) {
+        for (std::size_t i = 0u; i < num_programs; ++i) {
+            if (pending[i] && pending[i].is_ready()) {
+                programs[i] = pending[i].get();
+                ++num_ready;
+            }
+        }
+        if (!programs.front()) {
+            fallback_drawn = draw(fallback, 255u, 0u) && fallback_drawn;
+            ++num_fallback_frames;
+        }
+    }
+    std::cout << "Asynchronous build: " << num_programs << " programs submitted in "
+              << std::chrono::duration<double, std::milli>(submitted - start).count() << " ms, ready after "
+              << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms\n";
+    std::cout << "Frames drawn with the fallback program meanwhile: " << num_fallback_frames
+              << ", all of them correct: " << (fallback_drawn ? "yes" : "no") << "\n";
+
+    auto all_linked = true;
+    for (auto const& program : programs) {
+        all_linked = all_linked && program;
+    }
+    std::cout << "All programs linked: " << (all_linked ? "yes" : "no") << "\n";
+
+    auto broken = make_builder("undefined_color", 0u).build_async();
+    while (!broken.is_ready()) {
+        draw(fallback, 255u, 0u);
+    }
+    std::cout << "Broken program rejected: " << (broken && !broken.get() ? "yes" : "no") << "\n";
+
+    std::cout << "Compiled program drawn: " << (draw(programs.back(), 0u, 255u) ? "yes" : "no") << "\n";
+
+    glBindVertexArray(0u);
+    glDeleteVertexArrays(1, &vao);
+    return EXIT_SUCCESS;
+}
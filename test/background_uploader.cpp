@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/background_uploader.cpp \
+        -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output, the number of frames varies from machine to machine:
+
+    Shared context created, main context still current: yes
+    Uploaded 16 meshes of 1 MB and a shader program while drawing <N> frames
+    Vertex arrays are created on first use: yes
+    Background-uploaded triangle drawn: yes
+    Objects abandoned by a destroyed uploader are reported failed: yes
+
+The objects are created on the upload thread, while the main thread keeps drawing frames.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+struct Vertex final {
+    glm::vec2 position;
+    glm::vec4 color;
+};
+
+constexpr std::size_t num_meshes = 16u;
+constexpr std::size_t num_vertices = (1u << 20u) / sizeof(Vertex);
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    auto const current = eglGetCurrentContext();
+    auto shared_context = nest::make_shared_renderer_context(context);
+    if (!shared_context) {
+        std::cerr << "Failed to create a shared OpenGL context.\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Shared context created, main context still current: "
+              << (current == eglGetCurrentContext() ? "yes" : "no") << "\n";
+
+    std::vector<nest::AssetFuture<nest::Mesh>> meshes;
+    nest::AssetFuture<nest::ShaderProgram> program;
+    {
+        nest::BackgroundUploader uploader(std::move(shared_context));
+
+        program = uploader.upload([]() -> nest::ShaderProgram {
+            return nest::ShaderProgram::Builder{}
+                .with_vertex_shader(R"(#version 410
+                    layout(location = 0) in vec2 position;
+                    layout(location = 1) in vec4 color;
+                    out vec4 vertex_color;
+
+                    void main() {
+                        gl_Position = vec4(position, 0.0, 1.0);
+                        vertex_color = color;
+                    }
+                )")
+                .with_fragment_shader(R"(#version 410
+                    in vec4 vertex_color;
+                    out vec4 fragment_color;
+
+                    void main() {
+                        fragment_color = vertex_color;
+                    }
+                )");
+        });
+
+        for (std::size_t i = 0u; i < num_meshes; ++i) {
+            meshes.push_back(uploader.upload([]() -> nest::Mesh {
+                // A triangle covering the center of the viewport, followed by degenerate ones.
+                std::vector<Vertex> vertices(num_vertices, {glm::vec2(0.f, 0.f), glm::vec4(0.f, 1.f, 0.f, 1.f)});
+                vertices[0].position = glm::vec2(-0.5f, -0.5f);
+                vertices[1].position = glm::vec2(0.5f, -0.5f);
+                vertices[2].position = glm::vec2(0.f, 0.5f);
+                return nest::Mesh::Builder{}.with_deferred_vertex_array().with_vertices(vertices);
+            }));
+        }
+
+        std::size_t num_frames = 0u;
+        while (uploader.get_pending_count()) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            glFinish();
+            ++num_frames;
+        }
+        std::cout << "Uploaded " << meshes.size() << " meshes of 1 MB and a shader program while drawing "
+                  << num_frames << " frames\n";
+    }
+
+    auto& mesh = meshes.back().get();
+    auto const deferred = 0u == mesh.get_vao_handle();
+
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    program.get().enable();
+    mesh.draw();
+    std::cout << "Vertex arrays are created on first use: " << (deferred && mesh.get_vao_handle() ? "yes" : "no")
+              << "\n";
+
+    std::uint8_t pixel[4] = {};
+    glReadPixels(160, 120, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    std::cout << "Background-uploaded triangle drawn: "
+              << (program.is_ready() && 0u == pixel[0] && 255u == pixel[1] && 0u == pixel[2] ? "yes" : "no") << "\n";
+
+    // The uploader is destroyed while creating the first object, before the rest is even started.
+    std::vector<nest::AssetFuture<int>> abandoned;
+    {
+        nest::BackgroundUploader uploader(nest::make_shared_renderer_context(context));
+        for (int i = 0; i < 8; ++i) {
+            abandoned.push_back(uploader.upload([] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                return 1;
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto all_completed = abandoned.back().has_failed();
+    for (auto const& future : abandoned) {
+        all_completed = all_completed && (future.is_ready() || future.has_failed());
+    }
+    std::cout << "Objects abandoned by a destroyed uploader are reported failed: " << (all_completed ? "yes" : "no")
+              << "\n";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,767 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nest/event_loop.hpp>
+#include <nest/obj_parser.hpp>
+#include <nest/renderer.hpp>
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/benchmark.cpp -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Usage:
+    benchmark [--filter <substring>] [--json <file>] [--compare <baseline.json>] [--threshold <percent>]
+
+Runs the benchmarks whose names contain the filter, and prints a table of their statistics. The OpenGL benchmarks run
+on a headless context, so neither a display nor a GPU is needed, e.g. Mesa's llvmpipe will do. With `--json` the
+results are saved to the given file, `-` stands for the standard output. With `--compare` the medians are compared
+against the ones saved in the given file, and the program fails when any of them got worse by more than the threshold,
+10% by default.
+
+Expected output, the numbers vary from machine to machine:
+
+    benchmark                              unit           median         mean       stddev          p95
+    command_queue.enqueue                  ns/command      <N>          ...
+    command_queue.execute                  ns/command      <N>          ...
+    async_renderer.submit_latency          us              <N>          ...
+    mesh.upload.8_byte_vertices            MB/s            <N>          ...
+    mesh.upload.16_byte_vertices           MB/s            <N>          ...
+    mesh.upload.32_byte_vertices           MB/s            <N>          ...
+    mesh.upload.64_byte_vertices           MB/s            <N>          ...
+    shader_program.compile_and_link        ms              <N>          ...
+    shader_program.cold_start              ms              <N>          ...
+    shader_program.warm_start              ms              <N>          ...
+    mesh.draw.10k_objects                  ms              <N>          ...
+    mesh.draw.10k_instances                ms              <N>          ...
+    mesh.load.parse_obj                    ms              <N>          ...
+    mesh.load.mapped_file                  ms              <N>          ...
+    event_loop.pacing_jitter               us              <N>          ...
+*/
+
+using Clock = std::chrono::steady_clock;
+
+/// Holds the statistics of a benchmark's samples.
+struct Statistics final {
+    std::size_t count = 0u;
+    double mean = 0.0;
+    double median = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double p95 = 0.0;
+};
+
+/// Holds the result of a single benchmark.
+struct Result final {
+    std::string name;
+    std::string unit;
+
+    /// Holds a boolean which specifies whether larger values are better, e.g. for throughput.
+    bool higher_is_better = false;
+
+    Statistics statistics;
+};
+
+/// \returns The statistics of the given `samples`.
+Statistics summarize(std::vector<double> samples)
+{
+    Statistics statistics;
+    if (samples.empty()) {
+        return statistics;
+    }
+
+    std::sort(begin(samples), end(samples));
+
+    auto const count = samples.size();
+    auto const percentile = [&samples, count](double const p) {
+        return samples[std::min(count - 1u, static_cast<std::size_t>(p * (count - 1u) + 0.5))];
+    };
+
+    double sum = 0.0;
+    for (auto const sample : samples) {
+        sum += sample;
+    }
+
+    double squares = 0.0;
+    for (auto const sample : samples) {
+        squares += (sample - sum / count) * (sample - sum / count);
+    }
+
+    statistics.count = count;
+    statistics.mean = sum / count;
+    statistics.median = percentile(0.5);
+    statistics.stddev = count > 1u ? std::sqrt(squares / (count - 1u)) : 0.0;
+    statistics.min = samples.front();
+    statistics.max = samples.back();
+    statistics.p95 = percentile(0.95);
+    return statistics;
+}
+
+/// Collects the benchmark results, and skips the benchmarks not matching the filter.
+class Suite final {
+  public:
+    explicit Suite(std::string filter) : filter(std::move(filter))
+    {
+    }
+
+    /// \returns `true` when the benchmark with the given `name` shall be run.
+    bool enabled(std::string const& name) const
+    {
+        return std::string::npos != name.find(filter);
+    }
+
+    /// Runs `measure()` `num_samples` times after a warm-up run, and records the statistics of the measured values,
+    /// unless the benchmark is filtered out.
+    template <typename F> // F models double()
+    void run(std::string const& name, std::string const& unit, bool const higher_is_better,
+             std::size_t const num_samples, F&& measure)
+    {
+        if (!enabled(name)) {
+            return;
+        }
+
+        measure();
+
+        std::vector<double> samples;
+        samples.reserve(num_samples);
+        for (std::size_t i = 0u; i < num_samples; ++i) {
+            samples.push_back(measure());
+        }
+        add({name, unit, higher_is_better, summarize(std::move(samples))});
+    }
+
+    /// Records the given `result`, and prints it.
+    void add(Result result)
+    {
+        auto const& statistics = result.statistics;
+
+        // clang-format off
+        std::cout << std::left  << std::setw(39) << result.name
+                                << std::setw(12) << result.unit
+                  << std::right << std::setw(12) << statistics.median
+                                << std::setw(13) << statistics.mean
+                                << std::setw(13) << statistics.stddev
+                                << std::setw(13) << statistics.p95 << "\n";
+        // clang-format on
+
+        results.push_back(std::move(result));
+    }
+
+    std::vector<Result> const& get_results() const
+    {
+        return results;
+    }
+
+  private:
+    std::string filter;
+    std::vector<Result> results;
+};
+
+/// Writes the given `results` as JSON to the given `stream`.
+void write_json(std::ostream& stream, std::vector<Result> const& results)
+{
+    stream << std::setprecision(9) << "{\n  \"benchmarks\": [";
+    for (std::size_t i = 0u; i < results.size(); ++i) {
+        auto const& result = results[i];
+        auto const& statistics = result.statistics;
+
+        // clang-format off
+        stream << (i ? ",\n" : "\n")
+               << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\", "
+               << "\"higher_is_better\": " << (result.higher_is_better ? "true" : "false") << ", "
+               << "\"samples\": " << statistics.count  << ", "
+               << "\"mean\": "    << statistics.mean   << ", "
+               << "\"median\": "  << statistics.median << ", "
+               << "\"stddev\": "  << statistics.stddev << ", "
+               << "\"min\": "     << statistics.min    << ", "
+               << "\"max\": "     << statistics.max    << ", "
+               << "\"p95\": "     << statistics.p95    << "}";
+        // clang-format on
+    }
+    stream << "\n  ]\n}\n";
+}
+
+/// Reads the medians of the benchmarks saved by `write_json` from the given `stream`. This is not a general purpose
+/// JSON parser: it only understands the files written by this program.
+std::vector<std::pair<std::string, double>> read_medians(std::istream& stream)
+{
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    auto const json = buffer.str();
+
+    std::vector<std::pair<std::string, double>> medians;
+
+    std::string const name_key = "\"name\": \"";
+    std::string const median_key = "\"median\": ";
+
+    for (auto position = json.find(name_key); std::string::npos != position; position = json.find(name_key, position)) {
+        position += name_key.size();
+        auto const name_end = json.find('"', position);
+        auto const median = json.find(median_key, name_end);
+        if (std::string::npos == name_end || std::string::npos == median) {
+            break;
+        }
+        medians.emplace_back(json.substr(position, name_end - position),
+                             std::strtod(json.c_str() + median + median_key.size(), nullptr));
+    }
+    return medians;
+}
+
+/// Compares the medians of the given `results` against the given `baseline`, and prints the differences.
+/// \returns The number of benchmarks, which got worse by more than `threshold` percent.
+std::size_t compare(std::vector<Result> const& results, std::vector<std::pair<std::string, double>> const& baseline,
+                    double const threshold)
+{
+    std::size_t num_regressions = 0u;
+
+    std::cout << "\nComparison against the baseline, threshold " << threshold << "%:\n";
+    for (auto const& result : results) {
+        auto const it = std::find_if(begin(baseline), end(baseline),
+                                     [&result](auto const& entry) { return entry.first == result.name; });
+        if (end(baseline) == it || it->second == 0.0) {
+            std::cout << std::left << std::setw(39) << result.name << "no baseline\n";
+            continue;
+        }
+
+        // Positive changes are improvements, whichever direction is better for the benchmark.
+        auto change = 100.0 * (result.statistics.median - it->second) / it->second;
+        if (!result.higher_is_better) {
+            change = -change;
+        }
+
+        auto const verdict = change < -threshold ? "REGRESSION" : (change > threshold ? "improvement" : "ok");
+        num_regressions += change < -threshold;
+
+        std::cout << std::left << std::setw(39) << result.name << std::right << std::showpos << std::setw(9)
+                  << change << std::noshowpos << "%  " << verdict << "\n";
+    }
+    return num_regressions;
+}
+
+/// Measures how long it takes to record and to execute a queue of small commands.
+void benchmark_command_queue(Suite& suite)
+{
+    using Builder = nest::AsyncRenderer::CommandQueue::Builder;
+
+    constexpr std::size_t num_commands = 100'000u;
+
+    std::uint64_t sink = 0u;
+    auto const payload = std::uint64_t{42u};
+
+    suite.run("command_queue.enqueue", "ns/command", false, 20u, [&] {
+        auto const start = Clock::now();
+        Builder builder;
+        for (std::size_t i = 0u; i < num_commands; ++i) {
+            builder.enqueue([payload, &sink] { sink += payload; });
+        }
+        auto const duration = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        nest::AsyncRenderer::CommandQueue queue = builder;
+        return duration / num_commands;
+    });
+
+    suite.run("command_queue.execute", "ns/command", false, 20u, [&] {
+        Builder builder;
+        for (std::size_t i = 0u; i < num_commands; ++i) {
+            builder.enqueue([payload, &sink] { sink += payload; });
+        }
+        nest::AsyncRenderer::CommandQueue queue = builder;
+
+        auto const start = Clock::now();
+        queue.execute();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / num_commands;
+    });
+
+    if (suite.enabled("command_queue") && sink == 0u) {
+        std::cerr << "Benchmark commands were not executed.\n";
+    }
+}
+
+/// Measures the time between submitting a queue and the renderer starting to execute it, one frame at a time.
+void benchmark_submit_latency(Suite& suite, nest::OpenGL context)
+{
+    if (!suite.enabled("async_renderer.submit_latency")) {
+        return;
+    }
+
+    context.release_current();
+    nest::AsyncRenderer renderer(std::move(context));
+
+    std::atomic<Clock::rep> executed_at = 0;
+
+    suite.run("async_renderer.submit_latency", "us", false, 200u, [&] {
+        executed_at.store(0);
+
+        nest::AsyncRenderer::CommandQueue::Builder builder;
+        builder.enqueue([&executed_at] { executed_at.store(Clock::now().time_since_epoch().count()); });
+
+        auto const submitted_at = Clock::now();
+        renderer.submit(builder);
+
+        Clock::rep executed = 0;
+        while (!(executed = executed_at.load())) {
+            std::this_thread::yield();
+        }
+
+        auto const latency = Clock::time_point(Clock::duration(executed)) - submitted_at;
+        return std::chrono::duration<double, std::micro>(latency).count();
+    });
+}
+
+// clang-format off
+/// Vertices of typical sizes: 8, 16, 32 and 64 bytes.
+/// @{
+struct Vertex8  final { glm::vec2 position; };
+struct Vertex16 final { glm::vec2 position; glm::vec2 texcoord; };
+struct Vertex32 final { glm::vec4 position; glm::vec4 color; };
+struct Vertex64 final { glm::vec4 position; glm::vec4 color; glm::vec2 texcoord; float padding[6]; };
+/// @}
+// clang-format on
+
+/// Measures the bandwidth of uploading meshes made of vertices of the given type.
+template <typename UploadedVertex>
+void benchmark_mesh_upload(Suite& suite)
+{
+    constexpr std::size_t num_vertices = 65'536u;
+
+    std::vector<UploadedVertex> vertices(num_vertices);
+    for (std::size_t i = 0u; i < num_vertices; ++i) {
+        vertices[i].position.x = static_cast<float>(i);
+    }
+
+    auto const name = "mesh.upload." + std::to_string(sizeof(UploadedVertex)) + "_byte_vertices";
+    suite.run(name, "MB/s", true, 20u, [&] {
+        auto const start = Clock::now();
+        nest::Mesh mesh = nest::Mesh::Builder{}.with_vertices(vertices);
+        glFinish();
+        auto const duration = std::chrono::duration<double>(Clock::now() - start).count();
+
+        return num_vertices * sizeof(UploadedVertex) / duration / 1'000'000.0;
+    });
+}
+
+/// Measures how long it takes to compile and link a simple shader program.
+void benchmark_shader_program(Suite& suite)
+{
+    std::size_t nonce = 0u;
+
+    suite.run("shader_program.compile_and_link", "ms", false, 20u, [&nonce] {
+        // Every program differs from the previous ones, so no shader cache can hide the compilation.
+        auto const define = "#define NONCE " + std::to_string(++nonce) + "\n";
+        auto const vertex_shader = "#version 410\n" + define + R"(
+            layout(location = 0) in vec2 position;
+            uniform mat4 transform;
+
+            void main() {
+                gl_Position = transform * vec4(position, float(NONCE) * 0.0, 1.0);
+            }
+        )";
+        auto const fragment_shader = "#version 410\n" + define + R"(
+            uniform vec4 tint;
+            out vec4 color;
+
+            void main() {
+                color = tint * float(NONCE);
+            }
+        )";
+
+        auto const start = Clock::now();
+        nest::ShaderProgram program =
+            nest::ShaderProgram::Builder{}.with_vertex_shader(vertex_shader).with_fragment_shader(fragment_shader);
+        auto const duration = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        if (!program) {
+            std::cerr << "Failed to build a shader program.\n";
+        }
+        return duration;
+    });
+}
+
+/// Measures how long it takes to start up with 16 shader programs, once with an empty program cache, and once with a
+/// cache filled by a previous launch.
+void benchmark_program_cache(Suite& suite)
+{
+    if (!suite.enabled("shader_program.")) {
+        return;
+    }
+
+    constexpr std::size_t num_programs = 16u;
+    auto const directory = std::filesystem::temp_directory_path() / "nest_benchmark_programs";
+    std::size_t nonce = 0u;
+
+    // Every launch constructs its cache anew, and the cold ones build programs no launch has built before.
+    auto const start_up = [&](std::size_t const first_variant) {
+        auto const start = Clock::now();
+        nest::ProgramCache cache(directory);
+        for (std::size_t i = 0u; i < num_programs; ++i) {
+            nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                              .with_vertex_shader(R"(#version 410
+                                                  layout(location = 0) in vec2 position;
+                                                  uniform mat4 transform;
+
+                                                  void main() {
+                                                      gl_Position = transform * vec4(position, 0.0, 1.0);
+                                                  }
+                                              )")
+                                              .with_fragment_shader(R"(#version 410
+                                                  uniform vec4 tint;
+                                                  out vec4 color;
+
+                                                  void main() {
+                                                      color = tint * float(VARIANT);
+                                                  }
+                                              )")
+                                              .with_define("VARIANT", std::to_string(first_variant + i))
+                                              .with_cache(cache);
+            if (!program) {
+                std::cerr << "Failed to build a shader program.\n";
+            }
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    suite.run("shader_program.cold_start", "ms", false, 10u, [&] {
+        std::filesystem::remove_all(directory);
+        nonce += num_programs;
+        return start_up(nonce);
+    });
+
+    suite.run("shader_program.warm_start", "ms", false, 10u, [&] { return start_up(0u); });
+
+    std::filesystem::remove_all(directory);
+}
+
+/// A per-instance attribute of the instancing benchmark.
+struct Instance final {
+    glm::mat4 transform;
+    glm::vec4 tint;
+};
+
+/// Measures how long it takes to draw 10k copies of a mesh, once with a draw per copy, and once with a single
+/// instanced draw.
+void benchmark_instancing(Suite& suite)
+{
+    constexpr std::size_t num_copies = 10'000u;
+
+    // Tiny triangles, so that the time is spent on issuing draws rather than on rasterizing.
+    std::vector<Vertex8> const vertices = {{glm::vec2(0.f, 0.f)}, {glm::vec2(0.002f, 0.f)}, {glm::vec2(0.f, 0.002f)}};
+    std::vector<GLushort> const indices = {0u, 1u, 2u};
+
+    std::vector<Instance> instances(num_copies);
+    for (std::size_t i = 0u; i < num_copies; ++i) {
+        instances[i].transform = glm::mat4(1.f);
+        instances[i].transform[3] = glm::vec4(static_cast<float>(i % 100u) / 50.f - 1.f,
+                                              static_cast<float>(i / 100u) / 50.f - 1.f, 0.f, 1.f);
+        instances[i].tint = glm::vec4(1.f, 0.5f, 0.f, 1.f);
+    }
+
+    constexpr auto fragment_shader = R"(#version 410
+        in vec4 vertex_tint;
+        out vec4 color;
+
+        void main() {
+            color = vertex_tint;
+        }
+    )";
+
+    if (suite.enabled("mesh.draw.10k_objects")) {
+        nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                          .with_vertex_shader(R"(#version 410
+                layout(location = 0) in vec2 position;
+                uniform mat4 transform;
+                uniform vec4 tint;
+                out vec4 vertex_tint;
+
+                void main() {
+                    gl_Position = transform * vec4(position, 0.0, 1.0);
+                    vertex_tint = tint;
+                }
+            )")
+                                          .with_fragment_shader(fragment_shader);
+        program.enable();
+
+        auto const transform = glGetUniformLocation(program.get_handle(), "transform");
+        auto const tint = glGetUniformLocation(program.get_handle(), "tint");
+
+        nest::Mesh mesh = nest::Mesh::Builder{}.with_vertices(vertices).with_indices(indices);
+
+        suite.run("mesh.draw.10k_objects", "ms", false, 20u, [&] {
+            auto const start = Clock::now();
+            for (auto const& instance : instances) {
+                glUniformMatrix4fv(transform, 1, GL_FALSE, &instance.transform[0].x);
+                glUniform4fv(tint, 1, &instance.tint.x);
+                mesh.draw();
+            }
+            glFinish();
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        });
+    }
+
+    if (suite.enabled("mesh.draw.10k_instances")) {
+        nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                          .with_vertex_shader(R"(#version 410
+                layout(location = 0) in vec2 position;
+                layout(location = 3) in mat4 transform;
+                layout(location = 7) in vec4 tint;
+                out vec4 vertex_tint;
+
+                void main() {
+                    gl_Position = transform * vec4(position, 0.0, 1.0);
+                    vertex_tint = tint;
+                }
+            )")
+                                          .with_fragment_shader(fragment_shader);
+        program.enable();
+
+        nest::Mesh mesh =
+            nest::Mesh::Builder{}.with_vertices(vertices).with_indices(indices).with_instances(instances);
+
+        suite.run("mesh.draw.10k_instances", "ms", false, 20u, [&] {
+            auto const start = Clock::now();
+            mesh.draw();
+            glFinish();
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        });
+    }
+}
+
+/// A vertex of the mesh loading benchmark.
+struct LoadedVertex final {
+    glm::vec3 position;
+    glm::vec4 color;
+    glm::vec2 texcoord;
+};
+
+/// Measures how long it takes to load a mesh of 131k vertices and to upload it, once by parsing an OBJ file, and once
+/// by mapping a mesh file.
+void benchmark_mesh_loading(Suite& suite)
+{
+    if (!suite.enabled("mesh.load")) {
+        return;
+    }
+
+    constexpr std::size_t num_rows = 256u;
+    constexpr std::size_t num_columns = 512u;
+    constexpr auto pi = 3.14159265f;
+
+    // A UV sphere with colors and texture coordinates.
+    std::ostringstream obj;
+    for (std::size_t row = 0u; row <= num_rows; ++row) {
+        for (std::size_t column = 0u; column <= num_columns; ++column) {
+            auto const u = static_cast<float>(column) / num_columns;
+            auto const v = static_cast<float>(row) / num_rows;
+            auto const x = std::sin(pi * v) * std::cos(2.f * pi * u);
+            auto const y = -std::cos(pi * v);
+            auto const z = std::sin(pi * v) * std::sin(2.f * pi * u);
+            obj << "v " << x << " " << y << " " << z << " " << 0.5f + 0.5f * x << " " << 0.5f + 0.5f * y << " 0.5\n"
+                << "vt " << u << " " << v << "\n";
+        }
+    }
+    for (std::size_t row = 0u; row < num_rows; ++row) {
+        for (std::size_t column = 0u; column < num_columns; ++column) {
+            auto const corner = row * (num_columns + 1u) + column + 1u;
+            auto const above = corner + num_columns + 1u;
+            obj << "f " << corner << "/" << corner << " " << above << "/" << above << " " << above + 1u << "/"
+                << above + 1u << " " << corner + 1u << "/" << corner + 1u << "\n";
+        }
+    }
+
+    auto const directory = std::filesystem::temp_directory_path();
+    auto const obj_path = (directory / "nest_benchmark.obj").string();
+    auto const mesh_path = (directory / "nest_benchmark.mesh").string();
+    std::ofstream(obj_path, std::ios::binary) << obj.str();
+
+    std::vector<LoadedVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    if (!nest::parse_obj(obj.str(), vertices, indices) ||
+        !nest::write_mesh_file(mesh_path.c_str(), vertices, indices)) {
+        std::cerr << "Failed to write the mesh files.\n";
+        return;
+    }
+
+    suite.run("mesh.load.parse_obj", "ms", false, 10u, [&] {
+        auto const start = Clock::now();
+        std::ifstream file(obj_path, std::ios::binary);
+        std::stringstream text;
+        text << file.rdbuf();
+
+        std::vector<LoadedVertex> parsed_vertices;
+        std::vector<std::uint32_t> parsed_indices;
+        nest::parse_obj(text.str(), parsed_vertices, parsed_indices);
+        nest::Mesh mesh = nest::Mesh::Builder{}.with_vertices(parsed_vertices).with_indices(parsed_indices);
+        glFinish();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    });
+
+    suite.run("mesh.load.mapped_file", "ms", false, 10u, [&] {
+        auto const start = Clock::now();
+        nest::MeshFile file(mesh_path.c_str());
+        nest::Mesh mesh = nest::Mesh::Builder{}.with_mesh_file(file);
+        glFinish();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    });
+
+    std::filesystem::remove(obj_path);
+    std::filesystem::remove(mesh_path);
+}
+
+/// Measures how far the frames of an `EventLoop` paced at 120 Hz stray from their schedule.
+void benchmark_event_loop(Suite& suite)
+{
+    if (!suite.enabled("event_loop.pacing_jitter")) {
+        return;
+    }
+
+    constexpr auto rate = 120.0;
+    constexpr std::size_t num_frames = 240u;
+
+    std::vector<double> samples;
+    samples.reserve(num_frames);
+
+    nest::EventLoop event_loop;
+    event_loop.pacer.set_rate(rate);
+
+    auto previous = Clock::now();
+    event_loop.on_render = [&](float) {
+        auto const now = Clock::now();
+        auto const interval = std::chrono::duration<double, std::micro>(now - std::exchange(previous, now)).count();
+        samples.push_back(std::abs(interval - 1'000'000.0 / rate));
+
+        if (samples.size() == num_frames) {
+            event_loop.quit();
+        }
+    };
+    event_loop.run();
+
+    // The first frame only starts the schedule.
+    samples.erase(begin(samples));
+    suite.add({"event_loop.pacing_jitter", "us", false, summarize(std::move(samples))});
+}
+
+int main(int const argc, char const* const argv[])
+{
+    std::string filter;
+    std::string json_path;
+    std::string baseline_path;
+    double threshold = 10.0;
+
+    for (auto i = 1; i < argc; ++i) {
+        std::string const argument = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing a value of " << argument << ".\n";
+            return EXIT_FAILURE;
+        }
+
+        if ("--filter" == argument) {
+            filter = argv[++i];
+        }
+        else if ("--json" == argument) {
+            json_path = argv[++i];
+        }
+        else if ("--compare" == argument) {
+            baseline_path = argv[++i];
+        }
+        else if ("--threshold" == argument) {
+            threshold = std::strtod(argv[++i], nullptr);
+        }
+        else {
+            std::cerr << "Unknown argument " << argument << ".\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The event loop polls SDL events, which needs no display.
+    if (0 != SDL_Init(SDL_INIT_EVENTS)) {
+        std::cerr << "Cannot initialize SDL: " << SDL_GetError() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::atexit(SDL_Quit);
+
+    // With `--json -` the table goes to the standard error, so the standard output is valid JSON.
+    auto const table_buffer = std::cout.rdbuf();
+    if ("-" == json_path) {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    Suite suite(filter);
+
+    // clang-format off
+    std::cout << std::fixed << std::setprecision(3)
+              << std::left  << std::setw(39) << "benchmark"
+                            << std::setw(12) << "unit"
+              << std::right << std::setw(12) << "median"
+                            << std::setw(13) << "mean"
+                            << std::setw(13) << "stddev"
+                            << std::setw(13) << "p95" << "\n";
+    // clang-format on
+
+    benchmark_command_queue(suite);
+
+#if NEST_OPENGL_HEADLESS
+    if (auto renderer_context = nest::make_headless_renderer_context(640, 480); renderer_context) {
+        benchmark_submit_latency(suite, std::move(renderer_context));
+    }
+    else {
+        std::cerr << "Skipping the renderer benchmarks: failed to create a headless OpenGL context.\n";
+    }
+
+    if (auto context = nest::make_headless_renderer_context(640, 480); context) {
+        benchmark_mesh_upload<Vertex8>(suite);
+        benchmark_mesh_upload<Vertex16>(suite);
+        benchmark_mesh_upload<Vertex32>(suite);
+        benchmark_mesh_upload<Vertex64>(suite);
+        benchmark_shader_program(suite);
+        benchmark_program_cache(suite);
+        benchmark_instancing(suite);
+        benchmark_mesh_loading(suite);
+    }
+    else {
+        std::cerr << "Skipping the OpenGL benchmarks: failed to create a headless OpenGL context.\n";
+    }
+#else
+    std::cerr << "Skipping the OpenGL benchmarks: headless OpenGL contexts are not available.\n";
+#endif
+
+    benchmark_event_loop(suite);
+
+    std::cout.rdbuf(table_buffer);
+
+    if ("-" == json_path) {
+        write_json(std::cout, suite.get_results());
+    }
+    else if (!json_path.empty()) {
+        std::ofstream file(json_path);
+        write_json(file, suite.get_results());
+        if (!file) {
+            std::cerr << "Failed to write " << json_path << ".\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!baseline_path.empty()) {
+        std::ifstream file(baseline_path);
+        if (!file) {
+            std::cerr << "Failed to read " << baseline_path << ".\n";
+            return EXIT_FAILURE;
+        }
+
+        if (compare(suite.get_results(), read_medians(file), threshold)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
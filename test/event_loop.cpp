@@ -11,7 +11,8 @@ Build:
     g++ -std=c++17 -Wall -Werror -I. test/event_loop.cpp -lmingw32 -lSDL2main -lSDL2 -lglew32 -lopengl32
 
 Expected result:
-    A 320 x 240 window filled with changing color.
+    A 320 x 240 window filled with smoothly changing color. The color is simulated at a fixed time step, and rendered
+    interpolated between the last two steps.
 */
 
 extern "C" int SDL_main(int argc, char* argv[])
@@ -32,17 +33,23 @@ extern "C" int SDL_main(int argc, char* argv[])
 
     nest::EventLoop event_loop;
 
-    event_loop.on_tick = [&context](float const time_step) {
-        static float a = 0.f;
-        static float t = 0.f;
+    // The angles of the color wheel at the last two fixed updates, which rendering interpolates between.
+    glm::vec2 previous_angles(0.f);
+    glm::vec2 angles(0.f);
 
-        a += 10.f * time_step;
-        t += 20.f * time_step;
+    event_loop.on_fixed_update = [&previous_angles, &angles](float const time_step) {
+        previous_angles = angles;
+        angles += glm::vec2(10.f, 20.f) * time_step;
 
         // clang-format off
-        if (a > 180.f) a -= 360.f;
-        if (t > 180.f) t -= 360.f;
+        if (angles.x > 180.f) { angles.x -= 360.f; previous_angles.x -= 360.f; }
+        if (angles.y > 180.f) { angles.y -= 360.f; previous_angles.y -= 360.f; }
         // clang-format on
+    };
+
+    event_loop.on_render = [&context, &previous_angles, &angles](float const alpha) {
+        auto const a = glm::mix(previous_angles.x, angles.x, alpha);
+        auto const t = glm::mix(previous_angles.y, angles.y, alpha);
 
         auto const r = 0.5f * (glm::cos(glm::radians(a)) + 1.f);
         auto const b = 0.5f * (glm::sin(glm::radians(t)) + 1.f);
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <nest/fixed_timestep.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. test/fixed_timestep.cpp
+
+Expected output:
+
+    Frames of 1.5 steps: 6 updates in 4 frames, interpolation factors 0.5 0 0.5 0, correct: yes
+    Hitch of 10.25 steps: 5 updates, backlog dropped, interpolation factor 0.25, correct: yes
+    Step shorter than a clock tick rejected: yes
+    Non-positive step rejected: yes
+*/
+
+using Clock = nest::FixedTimestep::Clock;
+
+/// Holds the time step, which is exactly representable as a `float`.
+constexpr float time_step = 1.f / 64.f;
+
+int main(int const argc, char const* const argv[])
+{
+    auto const step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(time_step));
+
+    unsigned num_updates = 0u;
+    auto valid_steps = true;
+    auto const update = [&num_updates, &valid_steps](float const step) {
+        ++num_updates;
+        valid_steps = valid_steps && time_step == step;
+    };
+
+    {
+        nest::FixedTimestep timestep;
+
+        float const expected_alphas[] = {0.5f, 0.f, 0.5f, 0.f};
+        unsigned const expected_updates[] = {1u, 2u, 1u, 2u};
+
+        auto correct = true;
+        float alphas[4] = {};
+        for (int frame = 0; frame < 4; ++frame) {
+            auto const before = num_updates;
+            alphas[frame] = timestep.advance(step * 3 / 2, time_step, 5u, update);
+            correct = correct && expected_updates[frame] == num_updates - before &&
+                      std::abs(expected_alphas[frame] - alphas[frame]) < 1e-6f;
+        }
+        std::cout << "Frames of 1.5 steps: " << num_updates << " updates in 4 frames, interpolation factors "
+                  << alphas[0] << " " << alphas[1] << " " << alphas[2] << " " << alphas[3]
+                  << ", correct: " << (correct && valid_steps ? "yes" : "no") << "\n";
+    }
+    {
+        nest::FixedTimestep timestep;
+
+        num_updates = 0u;
+        auto const alpha = timestep.advance(step * 41 / 4, time_step, 5u, update);
+        auto const correct = 5u == num_updates && std::abs(0.25f - alpha) < 1e-6f &&
+                             0.f == timestep.advance(step * 3 / 4, time_step, 5u, update) && 6u == num_updates;
+        std::cout << "Hitch of 10.25 steps: 5 updates, backlog dropped, interpolation factor " << alpha
+                  << ", correct: " << (correct && valid_steps ? "yes" : "no") << "\n";
+    }
+    {
+        nest::FixedTimestep timestep;
+
+        num_updates = 0u;
+        auto const alpha = timestep.advance(std::chrono::seconds(1), 1e-12f, 5u, update);
+        std::cout << "Step shorter than a clock tick rejected: " << (0u == num_updates && 1.f == alpha ? "yes" : "no")
+                  << "\n";
+    }
+    {
+        nest::FixedTimestep timestep;
+
+        num_updates = 0u;
+        auto const rejected = 1.f == timestep.advance(std::chrono::seconds(1), 0.f, 5u, update) &&
+                              1.f == timestep.advance(std::chrono::seconds(1), -time_step, 5u, update) &&
+                              1.f == timestep.advance(std::chrono::seconds(1), NAN, 5u, update) && 0u == num_updates;
+        std::cout << "Non-positive step rejected: " << (rejected ? "yes" : "no") << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+#include <nest/frame_pacer.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. test/frame_pacer.cpp
+
+Expected output, the numbers vary from machine to machine:
+
+    Paced 120 frames at 120 Hz in about 1 s.
+    Missed deadlines: 0
+    Average jitter:   <N> us
+    Max jitter:       <M> us
+    CPU usage:        <K> %
+
+The jitter should stay well under a millisecond, and the CPU usage should be a small fraction of a core.
+*/
+
+int main(int const argc, char const* const argv[])
+{
+    using Clock = std::chrono::steady_clock;
+    using Microseconds = std::chrono::duration<double, std::micro>;
+    using Seconds = std::chrono::duration<double>;
+
+    nest::FramePacer pacer(120.0);
+
+    auto const cpu_start = std::clock();
+    auto const wall_start = Clock::now();
+
+    // The first call starts the schedule, so it doesn't count as a paced frame.
+    pacer.wait();
+    pacer.reset_statistics();
+
+    for (auto i = 0; i < 120; ++i) {
+        pacer.wait();
+    }
+
+    auto const wall_time = Seconds(Clock::now() - wall_start).count();
+    auto const cpu_time = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+    auto const statistics = pacer.get_statistics();
+
+    // clang-format off
+    std::cout << "Paced " << statistics.frame_count << " frames at 120 Hz in about " << wall_time << " s.\n"
+              << "Missed deadlines: " << statistics.missed_deadline_count << "\n"
+              << "Average jitter:   " << Microseconds(statistics.average_jitter).count() << " us\n"
+              << "Max jitter:       " << Microseconds(statistics.max_jitter).count() << " us\n"
+              << "CPU usage:        " << 100.0 * cpu_time / wall_time << " %\n";
+    // clang-format on
+
+    return EXIT_SUCCESS;
+}
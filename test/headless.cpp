@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include <nest/renderer.hpp>
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/headless.cpp -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs without a display, e.g. on Mesa's software rasterizer. Expected output:
+
+    Headless context: 320 x 240
+    Pixel read back on the main thread:     255 0 0 255
+    Pixel read back on the renderer thread: 0 255 0 255
+*/
+
+/// Reads back the pixel in the middle of the default framebuffer of the current context.
+void print_center_pixel(char const* const label)
+{
+    std::uint8_t pixel[4] = {0u, 0u, 0u, 0u};
+    glReadPixels(160, 120, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    std::cout << label << +pixel[0] << " " << +pixel[1] << " " << +pixel[2] << " " << +pixel[3] << "\n";
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    GLint viewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    std::cout << "Headless context: " << viewport[2] << " x " << viewport[3] << "\n";
+
+    glClearColor(1.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    context.swap_buffers();
+    print_center_pixel("Pixel read back on the main thread:     ");
+
+    // Hands the context over to the renderer thread.
+    context.release_current();
+    {
+        nest::AsyncRenderer renderer(std::move(context));
+        nest::AsyncRenderer::CommandQueue::Builder builder;
+        renderer.submit(builder.enqueue([] { glClearColor(0.f, 1.f, 0.f, 1.f); })
+                            .enqueue([] { glClear(GL_COLOR_BUFFER_BIT); })
+                            .enqueue([] { print_center_pixel("Pixel read back on the renderer thread: "); }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nest/lod_selector.hpp>
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/lod.cpp -lSDL2 -lGLEW -lEGL -lGL
+
+Runs on a headless context. Expected output, the exact numbers may vary slightly:
+
+    Level 0: 16128 triangles, error 0
+    Level 1: 8064 triangles, error 0.0031
+    Level 2: 4031 triangles, error 0.011
+    Level 3: 2014 triangles, error 0.027
+    Shared buffers: 1 vertex buffer, 1 index buffer of 90711 indices
+    Covered pixels per level: 36616 36611 36573 36547, largest difference <= 1%
+    Levels moving away:  0 0 1 1 1 2 2 2 3 3
+    Levels moving back:  3 3 3 2 2 1 1 1 0 0
+    Switches around a switch distance: 100 without hysteresis, 0 with hysteresis
+
+Every level halves the triangles of the previous one, while the silhouette barely changes. The levels switch later on
+the way back than on the way out, so an object hovering around a switch distance doesn't flicker.
+*/
+
+struct Vertex final {
+    glm::vec3 position;
+    glm::vec4 color;
+    glm::vec2 texcoord;
+};
+
+constexpr std::size_t num_rows = 64u;
+constexpr std::size_t num_columns = 128u;
+
+/// Builds a UV sphere of radius 1. The first and the last column of vertices share positions, but not texture
+/// coordinates, and so do the vertices at the poles.
+void make_sphere(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices)
+{
+    constexpr auto pi = 3.14159265f;
+    for (std::size_t row = 0u; row <= num_rows; ++row) {
+        for (std::size_t column = 0u; column <= num_columns; ++column) {
+            auto const u = static_cast<float>(column) / num_columns;
+            auto const v = static_cast<float>(row) / num_rows;
+            auto const position = row == 0u         ? glm::vec3(0.f, -1.f, 0.f)
+                                  : row == num_rows ? glm::vec3(0.f, 1.f, 0.f)
+                                                    : glm::vec3(std::sin(pi * v) * std::cos(2.f * pi * u),
+                                                                -std::cos(pi * v),
+                                                                std::sin(pi * v) * std::sin(2.f * pi * u));
+            auto const color = glm::vec4(0.5f + 0.5f * position.x, 0.5f + 0.5f * position.y, 0.5f, 1.f);
+            vertices.push_back({position, color, glm::vec2(u, v)});
+        }
+    }
+
+    for (std::size_t row = 0u; row < num_rows; ++row) {
+        for (std::size_t column = 0u; column < num_columns; ++column) {
+            auto const corner = static_cast<std::uint32_t>(row * (num_columns + 1u) + column);
+            auto const above = corner + static_cast<std::uint32_t>(num_columns + 1u);
+            if (row != 0u) {
+                indices.insert(indices.end(), {corner, above + 1u, corner + 1u});
+            }
+            if (row + 1u != num_rows) {
+                indices.insert(indices.end(), {corner, above, above + 1u});
+            }
+        }
+    }
+}
+
+/// Draws the given level of the given `mesh`.
+/// \returns The number of pixels covered by the level.
+std::size_t draw(nest::Mesh& mesh, std::size_t const level)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    mesh.set_lod(level);
+    mesh.draw();
+
+    std::vector<std::uint8_t> pixels(320u * 240u * 4u);
+    glReadPixels(0, 0, 320, 240, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::size_t covered = 0u;
+    for (std::size_t i = 0u; i < pixels.size(); i += 4u) {
+        covered += pixels[i + 3u] ? 1u : 0u;
+    }
+    return covered;
+}
+
+/// \returns The number of level switches of a selector of the given `hysteresis`, while a sphere of radius 1 jitters
+/// back and forth around the distance of the first switch.
+std::size_t count_switches(std::vector<float> const& errors, float const hysteresis)
+{
+    constexpr auto fov_y = 1.f;
+    constexpr auto viewport_height = 1080.f;
+
+    nest::LodSelector selector(errors, 1.f, hysteresis);
+    auto distance = 2.f;
+    while (0u == selector.select(nest::LodSelector::get_screen_size(1.f, distance, fov_y, viewport_height))) {
+        distance *= 1.01f;
+    }
+
+    std::size_t num_switches = 0u;
+    for (std::size_t frame = 0u; frame < 100u; ++frame) {
+        auto const level = selector.get_level();
+        auto const jitter = frame % 2u ? 1.02f : 0.98f;
+        auto const size = nest::LodSelector::get_screen_size(1.f, distance * jitter, fov_y, viewport_height);
+        num_switches += level != selector.select(size) ? 1u : 0u;
+    }
+    return num_switches;
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+            layout(location = 0) in vec3 position;
+            layout(location = 1) in vec4 color;
+            out vec4 vertex_color;
+
+            void main() {
+                gl_Position = vec4(0.9 * position.x * 0.75, 0.9 * position.y, 0.5 * position.z, 1.0);
+                vertex_color = color;
+            }
+        )")
+                                      .with_fragment_shader(R"(#version 410
+            in vec4 vertex_color;
+            out vec4 fragment_color;
+
+            void main() {
+                fragment_color = vertex_color;
+            }
+        )");
+    program.enable();
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    make_sphere(vertices, indices);
+
+    nest::Mesh mesh = nest::Mesh::Builder{}.with_lods(vertices, indices);
+
+    std::cout.precision(2);
+    std::vector<float> errors;
+    for (std::size_t level = 0u; level < mesh.get_lods().size(); ++level) {
+        auto const& lod = mesh.get_lods()[level];
+        std::cout << "Level " << level << ": " << lod.index_count / 3u << " triangles, error " << lod.error << "\n";
+        errors.push_back(lod.error);
+    }
+    std::cout << "Shared buffers: 1 vertex buffer, 1 index buffer of " << mesh.get_index_count() << " indices\n";
+
+    std::vector<std::size_t> covered;
+    auto largest_difference = 0.0;
+    for (std::size_t level = 0u; level < errors.size(); ++level) {
+        covered.push_back(draw(mesh, level));
+        auto const difference = std::abs(static_cast<double>(covered.back()) - static_cast<double>(covered[0]));
+        largest_difference = std::max(largest_difference, difference / static_cast<double>(covered[0]));
+    }
+    std::cout << "Covered pixels per level:";
+    for (auto const pixels : covered) {
+        std::cout << " " << pixels;
+    }
+    std::cout << ", largest difference " << (largest_difference <= 0.01 ? "<= 1%" : "> 1%") << "\n";
+
+    // Moves a sphere of radius 1 away from the eye and back, in steps of 1.5x.
+    constexpr auto fov_y = 1.f;
+    constexpr auto viewport_height = 1080.f;
+
+    nest::LodSelector selector(errors);
+    std::vector<float> distances;
+    for (auto distance = 2.f; distances.size() < 10u; distance *= 1.5f) {
+        distances.push_back(distance);
+    }
+
+    std::cout << "Levels moving away: ";
+    for (auto const distance : distances) {
+        std::cout << " " << selector.select(nest::LodSelector::get_screen_size(1.f, distance, fov_y, viewport_height));
+    }
+    std::cout << "\nLevels moving back: ";
+    for (auto it = distances.rbegin(); it != distances.rend(); ++it) {
+        std::cout << " " << selector.select(nest::LodSelector::get_screen_size(1.f, *it, fov_y, viewport_height));
+    }
+
+    std::cout << "\nSwitches around a switch distance: " << count_switches(errors, 0.f) << " without hysteresis, "
+              << count_switches(errors, 0.25f) << " with hysteresis\n";
+
+    return EXIT_SUCCESS;
+}
@@ -32,9 +32,9 @@ int SDL_main(int argc, char* argv[])
     context.make_current();
 
     // TODO:
-    //  - [ ] `Mesh::has_indices()`      to dsicover whether a `Mesh` contains any indices.
-    //  - [ ] `Mesh::get_index_count()`  to discover the number of inidices in a `Mesh`.
-    //  - [ ] `Mesh::get_vertex_count()` to discover the number of vertices in a `Mesh`.
+    //  - [x] `Mesh::has_indices()`      to dsicover whether a `Mesh` contains any indices.
+    //  - [x] `Mesh::get_index_count()`  to discover the number of inidices in a `Mesh`.
+    //  - [x] `Mesh::get_vertex_count()` to discover the number of vertices in a `Mesh`.
     //
     //  Low priority:
     //  - [ ] Macros for vertex attribute locations, which can be used in both C++ and GLSL.
@@ -0,0 +1,227 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <nest/obj_parser.hpp>
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/mesh_format.cpp -lSDL2 -lGLEW -lEGL -lGL
+
+Runs on a headless context. Expected output:
+
+    Parsed OBJ: 8385 vertices, 49152 indices, colors: 1, texture coordinates: 1
+    Mesh file: 3 attributes, 36-byte vertices, 16-bit indices, 4 levels, 486496 bytes
+    Vertices and indices match the parsed ones: 1
+    Differing pixels per level: 0 0 0 0
+    Truncated file rejected: 1
+    Corrupted file rejected: 1
+    Attribute out of the vertex rejected: 1
+    Attribute of an unknown semantic rejected: 1
+    Index out of range rejected: 1
+    Wrapping index count rejected: 1
+
+The mesh loaded from the mapped file draws exactly like the one built from the parsed vertices and indices.
+*/
+
+struct Vertex final {
+    glm::vec3 position;
+    glm::vec4 color;
+    glm::vec2 texcoord;
+};
+
+constexpr std::size_t num_rows = 64u;
+constexpr std::size_t num_columns = 128u;
+
+/// \returns A Wavefront OBJ text of a UV sphere of radius 1 with colors and texture coordinates.
+std::string make_sphere_obj()
+{
+    constexpr auto pi = 3.14159265f;
+
+    std::ostringstream obj;
+    obj << "# A UV sphere\n";
+    for (std::size_t row = 0u; row <= num_rows; ++row) {
+        for (std::size_t column = 0u; column <= num_columns; ++column) {
+            auto const u = static_cast<float>(column) / num_columns;
+            auto const v = static_cast<float>(row) / num_rows;
+            auto const x = std::sin(pi * v) * std::cos(2.f * pi * u);
+            auto const y = -std::cos(pi * v);
+            auto const z = std::sin(pi * v) * std::sin(2.f * pi * u);
+            obj << "v " << x << " " << y << " " << z << " " << 0.5f + 0.5f * x << " " << 0.5f + 0.5f * y << " 0.5\n";
+            obj << "vt " << u << " " << v << "\n";
+        }
+    }
+
+    // Quads, which the parser splits into triangles. Every vertex refers to a position and the texture coordinates of
+    // the same index.
+    for (std::size_t row = 0u; row < num_rows; ++row) {
+        for (std::size_t column = 0u; column < num_columns; ++column) {
+            auto const corner = row * (num_columns + 1u) + column + 1u;
+            auto const above = corner + num_columns + 1u;
+            obj << "f " << corner << "/" << corner << " " << above << "/" << above << "/1 " << above + 1u << "/"
+                << above + 1u << " " << corner + 1u << "/" << corner + 1u << "\n";
+        }
+    }
+    return obj.str();
+}
+
+/// Draws the given level of the given `mesh`.
+/// \returns The pixels of the image.
+std::vector<std::uint8_t> draw(nest::Mesh& mesh, std::size_t const level)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    mesh.set_lod(level);
+    mesh.draw();
+
+    std::vector<std::uint8_t> pixels(320u * 240u * 4u);
+    glReadPixels(0, 0, 320, 240, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+/// Copies the given `size` bytes of the file at the given `source` path into the file at the given `target` path,
+/// flipping the byte at the given `offset`, if it's within the copied bytes.
+void copy_file(std::string const& source, std::string const& target, std::size_t const size, std::size_t const offset)
+{
+    std::ifstream input(source, std::ios::binary);
+    std::vector<char> bytes(size);
+    input.read(bytes.data(), static_cast<std::streamsize>(size));
+    if (offset < size) {
+        bytes[offset] = static_cast<char>(~bytes[offset]);
+    }
+    std::ofstream(target, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(size));
+}
+
+/// Overwrites the given `size` bytes of the file at the given `path`, which start at the given `offset`, with the given
+/// `data`.
+void patch_file(std::string const& path, std::size_t const offset, void const* const data, std::size_t const size)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    nest::ObjAttributes attributes;
+    if (!nest::parse_obj(make_sphere_obj(), vertices, indices, &attributes)) {
+        std::cerr << "Failed to parse the OBJ text.\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Parsed OBJ: " << vertices.size() << " vertices, " << indices.size()
+              << " indices, colors: " << attributes.has_color << ", texture coordinates: " << attributes.has_texcoord
+              << "\n";
+
+    auto const chain = nest::build_lod_chain(vertices, indices);
+    auto const directory = std::filesystem::temp_directory_path();
+    auto const path = (directory / "nest_mesh_format.mesh").string();
+    if (!nest::write_mesh_file(path.c_str(), vertices, chain.indices, chain.levels)) {
+        std::cerr << "Failed to write " << path << ".\n";
+        return EXIT_FAILURE;
+    }
+
+    nest::MeshFile file(path.c_str());
+    if (!file) {
+        std::cerr << "Failed to map " << path << ".\n";
+        return EXIT_FAILURE;
+    }
+    auto const& header = file.get_header();
+    std::cout << "Mesh file: " << header.attribute_count << " attributes, " << header.vertex_stride
+              << "-byte vertices, " << header.index_size * 8u << "-bit indices, " << header.lod_count << " levels, "
+              << std::filesystem::file_size(path) << " bytes\n";
+
+    auto const file_indices = reinterpret_cast<std::uint16_t const*>(file.get_index_data());
+    auto matches = header.vertex_count == vertices.size() && header.index_count == chain.indices.size() &&
+                   0 == std::memcmp(file.get_vertex_data(), vertices.data(), vertices.size() * sizeof(Vertex));
+    for (std::size_t i = 0u; matches && i < chain.indices.size(); ++i) {
+        matches = file_indices[i] == chain.indices[i];
+    }
+    std::cout << "Vertices and indices match the parsed ones: " << matches << "\n";
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+            layout(location = 0) in vec3 position;
+            layout(location = 1) in vec4 color;
+            layout(location = 2) in vec2 texcoord;
+            out vec4 vertex_color;
+
+            void main() {
+                gl_Position = vec4(0.9 * position.x * 0.75, 0.9 * position.y, 0.5 * position.z, 1.0);
+                vertex_color = color * (0.5 + 0.5 * step(0.5, fract(8.0 * texcoord.x)));
+            }
+        )")
+                                      .with_fragment_shader(R"(#version 410
+            in vec4 vertex_color;
+            out vec4 fragment_color;
+
+            void main() {
+                fragment_color = vertex_color;
+            }
+        )");
+    program.enable();
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+
+    nest::Mesh parsed_mesh = nest::Mesh::Builder{}.with_lods(vertices, indices);
+    nest::Mesh file_mesh = nest::Mesh::Builder{}.with_mesh_file(file);
+
+    std::cout << "Differing pixels per level:";
+    for (std::size_t level = 0u; level < chain.levels.size(); ++level) {
+        auto const expected = draw(parsed_mesh, level);
+        auto const actual = draw(file_mesh, level);
+
+        std::size_t differing = 0u;
+        for (std::size_t i = 0u; i < expected.size(); i += 4u) {
+            differing += 0 != std::memcmp(&expected[i], &actual[i], 4u) ? 1u : 0u;
+        }
+        std::cout << " " << differing;
+    }
+    std::cout << "\n";
+
+    auto const size = static_cast<std::size_t>(std::filesystem::file_size(path));
+    auto const broken_path = (directory / "nest_mesh_format_broken.mesh").string();
+
+    copy_file(path, broken_path, size - 1u, size);
+    std::cout << "Truncated file rejected: " << !nest::MeshFile(broken_path.c_str()) << "\n";
+
+    copy_file(path, broken_path, size, offsetof(nest::MeshFileHeader, index_size));
+    std::cout << "Corrupted file rejected: " << !nest::MeshFile(broken_path.c_str()) << "\n";
+
+    auto const attributes_offset = offsetof(nest::MeshFileHeader, attributes);
+    copy_file(path, broken_path, size, attributes_offset + offsetof(nest::MeshFileAttribute, component_count));
+    std::cout << "Attribute out of the vertex rejected: " << !nest::MeshFile(broken_path.c_str()) << "\n";
+
+    copy_file(path, broken_path, size, attributes_offset + sizeof(nest::MeshFileAttribute));
+    std::cout << "Attribute of an unknown semantic rejected: " << !nest::MeshFile(broken_path.c_str()) << "\n";
+
+    // Flips the high byte of the first index.
+    copy_file(path, broken_path, size, static_cast<std::size_t>(header.indices.offset) + 1u);
+    std::cout << "Index out of range rejected: " << !nest::MeshFile(broken_path.c_str()) << "\n";
+
+    // A triangle with 2^63 more indices, whose size wraps around to the size of its index section. The zeros past the
+    // end of the file refer to the first vertex, so the indices would be validated on past the mapped pages.
+    std::vector<Vertex> const triangle(3u);
+    nest::write_mesh_file(broken_path.c_str(), triangle, {0u, 1u, 2u});
+    std::uint64_t const wrapping_count = 3u + (std::uint64_t{1u} << 63u);
+    patch_file(broken_path, offsetof(nest::MeshFileHeader, index_count), &wrapping_count, sizeof(wrapping_count));
+    std::cout << "Wrapping index count rejected: " << !nest::MeshFile(broken_path.c_str()) << "\n";
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(broken_path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/mesh_pool.cpp -lSDL2 -lGLEW -lEGL -lGL
+
+Runs on a headless context. Expected output, the timings vary from machine to machine:
+
+    Separate meshes: 4096 VAOs, 8192 buffers, 4096 state changes per frame, <N> ms per frame
+    Pooled meshes:   1 VAO, 2 buffers, 0 state changes per frame, <M> ms per frame
+    Same image: yes
+    After freeing half of the meshes: 2048 meshes, 4097 free ranges
+    After defragmenting:              2048 meshes, 2 free ranges, same image: yes
+    After growing:                    8192 meshes, 11 grows, same image: yes
+    Separate meshes of signed indices, same image: yes
+
+The pooled meshes are drawn without a single VAO bind, since they share the VAO bound by the first frame.
+*/
+
+struct Vertex final {
+    glm::vec2 position;
+    glm::vec4 color;
+};
+
+constexpr std::size_t grid_size = 64u;
+constexpr std::size_t num_frames = 20u;
+
+/// \returns The vertices of a quad in the given cell of the grid.
+std::vector<Vertex> make_quad(std::size_t const cell)
+{
+    auto const size = 2.f / grid_size;
+    auto const x = -1.f + size * static_cast<float>(cell % grid_size);
+    auto const y = -1.f + size * static_cast<float>(cell / grid_size);
+    auto const color = glm::vec4(static_cast<float>(cell % 7u) / 6.f, static_cast<float>(cell % 5u) / 4.f, 1.f, 1.f);
+
+    return {{glm::vec2(x, y), color},
+            {glm::vec2(x + size, y), color},
+            {glm::vec2(x + size, y + size), color},
+            {glm::vec2(x, y + size), color}};
+}
+
+/// Holds the indices of a quad.
+std::vector<GLushort> const quad_indices = {0u, 1u, 2u, 2u, 3u, 0u};
+
+/// Draws the given `meshes`, and reports the time per frame.
+/// \returns A checksum of the drawn image.
+std::uint64_t draw(std::vector<nest::Mesh>& meshes, double* const milliseconds_per_frame = nullptr)
+{
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0u; frame < num_frames; ++frame) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (auto& mesh : meshes) {
+            if (mesh) {
+                mesh.draw();
+            }
+        }
+        nest::StateCache::current()->end_frame();
+    }
+
+    std::vector<std::uint8_t> pixels(320u * 240u * 4u);
+    glReadPixels(0, 0, 320, 240, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    if (milliseconds_per_frame) {
+        auto const duration = std::chrono::steady_clock::now() - start;
+        *milliseconds_per_frame = std::chrono::duration<double, std::milli>(duration).count() / num_frames;
+    }
+
+    std::uint64_t checksum = 0u;
+    for (auto const pixel : pixels) {
+        checksum = checksum * 1099511628211u + pixel;
+    }
+    return checksum;
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+            layout(location = 0) in vec2 position;
+            layout(location = 1) in vec4 color;
+            out vec4 vertex_color;
+
+            void main() {
+                gl_Position = vec4(position, 0.0, 1.0);
+                vertex_color = color;
+            }
+        )")
+                                      .with_fragment_shader(R"(#version 410
+            in vec4 vertex_color;
+            out vec4 fragment_color;
+
+            void main() {
+                fragment_color = vertex_color;
+            }
+        )");
+    program.enable();
+
+    constexpr auto num_meshes = grid_size * grid_size;
+
+    // The pool must outlive its meshes. It starts small, so it has to grow.
+    nest::MeshPool pool = nest::MeshPool::Builder{}.with_layout<Vertex>().with_capacity(1024u, 1024u);
+
+    // Separate meshes, each with a VAO and two buffers of its own.
+    std::vector<nest::Mesh> meshes;
+    for (std::size_t cell = 0u; cell < num_meshes; ++cell) {
+        meshes.push_back(nest::Mesh::Builder{}.with_vertices(make_quad(cell)).with_indices(quad_indices));
+    }
+
+    double separate_time = 0.0;
+    auto const separate_image = draw(meshes, &separate_time);
+    auto const separate_binds = nest::StateCache::current()->get_frame_counters().issued;
+    meshes.clear();
+
+    // Pooled meshes, which share a VAO and two buffers.
+    for (std::size_t cell = 0u; cell < num_meshes; ++cell) {
+        meshes.push_back(
+            nest::Mesh::Builder{}.with_pool(pool).with_vertices(make_quad(cell)).with_indices(quad_indices));
+    }
+
+    double pooled_time = 0.0;
+    auto const pooled_image = draw(meshes, &pooled_time);
+    auto const pooled_binds = nest::StateCache::current()->get_frame_counters().issued;
+
+    // clang-format off
+    std::cout << "Separate meshes: " << num_meshes << " VAOs, " << 2u * num_meshes << " buffers, "
+              << separate_binds << " state changes per frame, " << separate_time << " ms per frame\n"
+              << "Pooled meshes:   1 VAO, 2 buffers, "
+              << pooled_binds << " state changes per frame, " << pooled_time << " ms per frame\n"
+              << "Same image: " << (separate_image == pooled_image ? "yes" : "no") << "\n";
+    // clang-format on
+
+    // Frees every other mesh, which leaves holes all over the pool.
+    for (std::size_t cell = 0u; cell < num_meshes; cell += 2u) {
+        meshes[cell] = nest::Mesh{};
+    }
+    auto const holey_image = draw(meshes);
+    auto statistics = pool.get_statistics();
+    std::cout << "After freeing half of the meshes: " << statistics.mesh_count << " meshes, "
+              << statistics.free_range_count << " free ranges\n";
+
+    pool.defragment();
+    statistics = pool.get_statistics();
+    std::cout << "After defragmenting:              " << statistics.mesh_count << " meshes, "
+              << statistics.free_range_count << " free ranges, same image: "
+              << (holey_image == draw(meshes) ? "yes" : "no") << "\n";
+
+    // Refills the holes, and adds as many meshes again, which makes the pool grow.
+    for (std::size_t cell = 0u; cell < num_meshes; cell += 2u) {
+        meshes[cell] =
+            nest::Mesh::Builder{}.with_pool(pool).with_vertices(make_quad(cell)).with_indices(quad_indices);
+    }
+    for (std::size_t cell = 0u; cell < num_meshes; ++cell) {
+        meshes.push_back(
+            nest::Mesh::Builder{}.with_pool(pool).with_vertices(make_quad(cell)).with_indices(quad_indices));
+    }
+    statistics = pool.get_statistics();
+    std::cout << "After growing:                    " << statistics.mesh_count << " meshes, " << statistics.grow_count
+              << " grows, same image: " << (pooled_image == draw(meshes) ? "yes" : "no") << "\n";
+    meshes.clear();
+
+    // Signed indices, which OpenGL can't draw, are converted to unsigned ones.
+    std::vector<int> const int_indices(quad_indices.begin(), quad_indices.end());
+    std::vector<short> const short_indices(quad_indices.begin(), quad_indices.end());
+    for (std::size_t cell = 0u; cell < num_meshes; ++cell) {
+        nest::Mesh::Builder builder;
+        builder.with_vertices(make_quad(cell));
+        meshes.push_back(cell % 2u ? builder.with_indices(int_indices) : builder.with_indices(short_indices));
+    }
+    std::cout << "Separate meshes of signed indices, same image: "
+              << (separate_image == draw(meshes) ? "yes" : "no") << "\n";
+
+    return EXIT_SUCCESS;
+}
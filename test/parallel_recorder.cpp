@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <nest/parallel_recorder.hpp>
+
+/// Records draws of the objects in the given part of a scene, `num_objects / num_parts` objects per part. Every draw
+/// appends the index of its object to `drawn`.
+struct Scene final {
+    std::size_t num_objects;
+    std::size_t num_parts;
+    std::vector<std::size_t>* drawn;
+
+    void operator()(std::size_t const part, nest::AsyncRenderer::CommandQueue::Builder& builder) const
+    {
+        auto const objects_per_part = num_objects / num_parts;
+        auto const first = part * objects_per_part;
+        auto const last = part + 1u == num_parts ? num_objects : first + objects_per_part;
+
+        for (auto i = first; i < last; ++i) {
+            // Stands for culling and computing the view-space depth of an object.
+            auto depth = 0.f;
+            for (auto j = 0u; j < 32u; ++j) {
+                depth += std::sin(static_cast<float>(i + j));
+            }
+            depth = std::abs(depth) / 32.f;
+
+            auto const program = static_cast<std::uint32_t>(i % 8u);
+            auto const mesh = static_cast<std::uint32_t>(i % 128u);
+            builder.enqueue(nest::SortKey::make(0u, false, program, mesh, depth),
+                            [drawn = drawn, i] { drawn->push_back(i); });
+        }
+    }
+};
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. test/parallel_recorder.cpp -lpthread
+
+Expected output, one line per thread count up to the number of hardware threads; the timings vary from machine to
+machine, but the order of draws must be the same for every thread count:
+
+    1 thread(s): <T1> ms per frame, same draw order: yes
+    2 thread(s): <T2> ms per frame, same draw order: yes
+    ...
+*/
+
+int main(int const argc, char const* const argv[])
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t num_objects = 200'000u;
+    constexpr std::size_t num_parts = 64u;
+    constexpr int num_frames = 10;
+
+    // Holds the order of draws recorded on a single thread.
+    std::vector<std::size_t> expected;
+
+    auto const max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (auto num_threads = 1u; num_threads <= max_threads; num_threads *= 2u) {
+        nest::ParallelRecorder recorder(num_threads);
+
+        std::vector<std::size_t> drawn;
+        drawn.reserve(num_objects);
+
+        auto const start = Clock::now();
+        for (auto frame = 0; frame < num_frames; ++frame) {
+            drawn.clear();
+            auto queue = recorder.record(num_parts, Scene{num_objects, num_parts, &drawn});
+            queue.execute();
+        }
+        auto const duration = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / num_frames;
+
+        if (expected.empty()) {
+            expected = drawn;
+        }
+
+        // clang-format off
+        std::cout << num_threads << " thread(s): " << duration << " ms per frame, same draw order: "
+                  << (drawn == expected && drawn.size() == num_objects ? "yes" : "no") << "\n";
+        // clang-format on
+    }
+
+    return EXIT_SUCCESS;
+}
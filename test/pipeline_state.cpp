@@ -0,0 +1,201 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nest/renderer.hpp>
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/pipeline_state.cpp \
+        -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output:
+
+    Interned 3 states into 2 pipelines, identical states share an id: yes
+    Depth tested and blended quads drawn: yes
+    Back faces culled: yes
+    Stencil masked quad drawn into the viewport quadrant: yes
+    Reapplied pipeline issued 0 calls, skipped <N>
+    Unsorted: <N> calls issued, <N> skipped for 256 draws
+    Sorted:   <N> calls issued, <N> skipped for 256 draws
+*/
+
+struct Vertex final {
+    glm::vec3 position;
+    glm::vec4 color;
+};
+
+/// \returns A quad of the given `color`, which covers the viewport at the given `depth`. Its front face is the one
+/// facing the viewer unless `back_facing` is `true`.
+nest::Mesh make_quad(float const depth, glm::vec4 const& color, bool const back_facing = false)
+{
+    std::vector<Vertex> vertices = {
+        {glm::vec3(-1.f, -1.f, depth), color}, {glm::vec3(1.f, -1.f, depth), color},
+        {glm::vec3(1.f, 1.f, depth), color},   {glm::vec3(-1.f, -1.f, depth), color},
+        {glm::vec3(1.f, 1.f, depth), color},   {glm::vec3(-1.f, 1.f, depth), color},
+    };
+    if (back_facing) {
+        std::swap(vertices[1], vertices[2]);
+        std::swap(vertices[4], vertices[5]);
+    }
+    return nest::Mesh::Builder{}.with_vertices(vertices);
+}
+
+/// \returns `true` when the given pixel of the frame has the given color give or take 2, `false` otherwise.
+bool has_color(int const x, int const y, glm::ivec3 const& color)
+{
+    std::uint8_t pixel[4] = {};
+    glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    auto const difference = glm::ivec3(pixel[0], pixel[1], pixel[2]) - color;
+    return std::abs(difference.x) <= 2 && std::abs(difference.y) <= 2 && std::abs(difference.z) <= 2;
+}
+
+/// Clears the frame. The default state is applied first, since the write masks of the current one apply to clearing.
+void clear(nest::PipelineRegistry const& registry)
+{
+    registry.apply(0u);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+/// Executes `num_draws` draws with pseudo-random pipelines and meshes, enqueued with sort keys grouping them by
+/// pipeline when `sorted` is `true`, and in submission order otherwise. Reports the number of calls the `StateCache`
+/// has issued and skipped.
+void draw_commands(nest::PipelineRegistry const& registry, std::vector<nest::PipelineId> const& pipelines,
+                   std::vector<nest::Mesh>& meshes, std::size_t const num_draws, bool const sorted)
+{
+    std::uint32_t seed = 12345u;
+
+    nest::AsyncRenderer::CommandQueue::Builder builder;
+    for (std::size_t i = 0u; i < num_draws; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+
+        auto const pipeline = pipelines[(seed >> 8u) % pipelines.size()];
+        auto const mesh = (seed >> 16u) % meshes.size();
+        auto const draw = [&registry, pipeline, &mesh = meshes[mesh]] {
+            registry.apply(pipeline);
+            mesh.draw();
+        };
+
+        if (sorted) {
+            builder.enqueue(nest::SortKey::make(0u, false, pipeline, static_cast<std::uint32_t>(mesh), 0.5f), draw);
+        }
+        else {
+            builder.enqueue(draw);
+        }
+    }
+    nest::AsyncRenderer::CommandQueue queue = builder;
+
+    auto const cache = nest::StateCache::current();
+    clear(registry);
+    cache->invalidate();
+    cache->end_frame();
+    queue.execute();
+    cache->end_frame();
+
+    auto const counters = cache->get_frame_counters();
+    std::cout << (sorted ? "Sorted:   " : "Unsorted: ") << counters.issued << " calls issued, " << counters.skipped
+              << " skipped for " << num_draws << " draws\n";
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(64, 64);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+                                          layout(location = 0) in vec3 position;
+                                          layout(location = 1) in vec4 color;
+                                          out vec4 vertex_color;
+
+                                          void main() {
+                                              gl_Position = vec4(position, 1.0);
+                                              vertex_color = color;
+                                          }
+                                      )")
+                                      .with_fragment_shader(R"(#version 410
+                                          in vec4 vertex_color;
+                                          out vec4 fragment_color;
+
+                                          void main() {
+                                              fragment_color = vertex_color;
+                                          }
+                                      )");
+
+    auto const base = nest::PipelineState::Builder{}.with_program(program).with_vertex_layout<Vertex>();
+
+    nest::PipelineRegistry registry;
+    auto const opaque = registry.intern(nest::PipelineState::Builder(base).with_depth_test());
+    auto const translucent = registry.intern(nest::PipelineState::Builder(base)
+                                                 .with_depth_test(GL_LESS, false)
+                                                 .with_blending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    auto const duplicate = registry.intern(nest::PipelineState::Builder(base).with_depth_test());
+
+    auto const shared = opaque == duplicate && opaque != translucent && 3u == registry.get_size();
+    std::cout << "Interned 3 states into " << registry.get_size() - 1u
+              << " pipelines, identical states share an id: " << (shared ? "yes" : "no") << "\n";
+
+    auto red = make_quad(0.f, glm::vec4(1.f, 0.f, 0.f, 1.f));
+    auto hidden_green = make_quad(0.5f, glm::vec4(0.f, 1.f, 0.f, 1.f));
+    auto translucent_blue = make_quad(-0.5f, glm::vec4(0.f, 0.f, 1.f, 0.5f));
+
+    clear(registry);
+    registry.apply(opaque);
+    red.draw();
+    hidden_green.draw();
+    registry.apply(translucent);
+    translucent_blue.draw();
+    std::cout << "Depth tested and blended quads drawn: " << (has_color(32, 32, {128, 0, 128}) ? "yes" : "no")
+              << "\n";
+
+    auto const culled = registry.intern(nest::PipelineState::Builder(base).with_culling());
+    auto back_facing_red = make_quad(0.f, glm::vec4(1.f, 0.f, 0.f, 1.f), true);
+
+    clear(registry);
+    registry.apply(culled);
+    back_facing_red.draw();
+    auto const back_faces_culled = has_color(32, 32, {0, 0, 0});
+    red.draw();
+    std::cout << "Back faces culled: " << (back_faces_culled && has_color(32, 32, {255, 0, 0}) ? "yes" : "no")
+              << "\n";
+
+    auto const mark = registry.intern(nest::PipelineState::Builder(base)
+                                          .with_viewport(0, 0, 32, 32)
+                                          .with_stencil_test(GL_ALWAYS, 1, ~0u, GL_KEEP, GL_KEEP, GL_REPLACE));
+    auto const masked =
+        registry.intern(nest::PipelineState::Builder(base).with_viewport(0, 0, 64, 64).with_stencil_test(GL_EQUAL, 1));
+    auto green = make_quad(0.f, glm::vec4(0.f, 1.f, 0.f, 1.f));
+
+    clear(registry);
+    registry.apply(mark);
+    red.draw();
+    registry.apply(masked);
+    green.draw();
+    auto const quadrant_drawn =
+        has_color(16, 16, {0, 255, 0}) && has_color(48, 16, {0, 0, 0}) && has_color(48, 48, {0, 0, 0});
+    std::cout << "Stencil masked quad drawn into the viewport quadrant: " << (quadrant_drawn ? "yes" : "no") << "\n";
+
+    auto const cache = nest::StateCache::current();
+    registry.apply(opaque);
+    auto const before = cache->get_counters();
+    registry.apply(opaque);
+    auto const after = cache->get_counters();
+    std::cout << "Reapplied pipeline issued " << after.issued - before.issued << " calls, skipped "
+              << after.skipped - before.skipped << "\n";
+
+    std::vector<nest::Mesh> meshes;
+    for (int i = 0; i < 8; ++i) {
+        meshes.push_back(make_quad(0.1f * static_cast<float>(i), glm::vec4(0.f, 0.f, 1.f, 0.5f)));
+    }
+    std::vector<nest::PipelineId> const pipelines = {opaque, translucent, culled, masked};
+    draw_commands(registry, pipelines, meshes, 256u, false);
+    draw_commands(registry, pipelines, meshes, 256u, true);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/program_cache.cpp \
+        -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output, the times vary from machine to machine:
+
+    Program binaries supported: yes
+    Cold start: 64 programs in <N> ms, 0 hits, 64 misses, 64 writes
+    Warm start: 64 programs in <N> ms, 64 hits, 0 misses, 0 writes
+    Cached program drawn: yes
+    Corrupted entry recompiled: yes, 1 rejected, 1 rewritten
+    Truncated entries recompiled: yes, 2 rejected, 2 rewritten
+    Entries removed after a driver update: yes
+
+Every launch is simulated with a cache constructed anew over the same directory.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t num_programs = 64u;
+
+/// Builds a program for every variant, and stores them into the given `programs`.
+/// \returns The time it took in milliseconds.
+double build_programs(nest::ProgramCache& cache, std::vector<nest::ShaderProgram>& programs)
+{
+    programs.clear();
+    auto const start = Clock::now();
+    for (std::size_t i = 0u; i < num_programs; ++i) {
+        programs.push_back(nest::ShaderProgram::Builder{}
+                               .with_vertex_shader(R"(#version 410
+                                   void main() {
+                                       // A triangle covering the viewport.
+                                       vec2 position = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 4.0 - 1.0;
+                                       gl_Position = vec4(position, 0.0, 1.0);
+                                   }
+                               )")
+                               .with_fragment_shader(R"(#version 410
+                                   out vec4 color;
+
+                                   void main() {
+                                       color = vec4(0.0, 1.0, float(VARIANT) * 0.0, 1.0);
+                                   }
+                               )")
+                               .with_define("VARIANT", std::to_string(i))
+                               .with_cache(cache));
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// \returns The number of entries in the given cache `directory`.
+std::size_t count_entries(std::filesystem::path const& directory)
+{
+    std::size_t count = 0u;
+    for (auto const& entry : std::filesystem::directory_iterator(directory)) {
+        count += ".bin" == entry.path().extension() ? 1u : 0u;
+    }
+    return count;
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(64, 64);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    auto const directory = std::filesystem::temp_directory_path() / "nest_program_cache_test";
+    std::filesystem::remove_all(directory);
+
+    std::vector<nest::ShaderProgram> programs;
+    {
+        nest::ProgramCache cache(directory);
+        std::cout << "Program binaries supported: " << (cache.is_supported() ? "yes" : "no") << "\n";
+        if (!cache.is_supported()) {
+            return EXIT_SUCCESS;
+        }
+
+        auto const duration = build_programs(cache, programs);
+        auto const statistics = cache.get_statistics();
+        std::cout << "Cold start: " << num_programs << " programs in " << duration << " ms, " << statistics.hits
+                  << " hits, " << statistics.misses << " misses, " << statistics.writes << " writes\n";
+    }
+    {
+        nest::ProgramCache cache(directory);
+        auto const duration = build_programs(cache, programs);
+        auto const statistics = cache.get_statistics();
+        std::cout << "Warm start: " << num_programs << " programs in " << duration << " ms, " << statistics.hits
+                  << " hits, " << statistics.misses << " misses, " << statistics.writes << " writes\n";
+    }
+
+    GLuint vao = 0u;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    programs.back().enable();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    std::uint8_t pixel[4] = {};
+    glReadPixels(32, 32, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    std::cout << "Cached program drawn: "
+              << (0u == pixel[0] && 255u == pixel[1] && 0u == pixel[2] ? "yes" : "no") << "\n";
+    glBindVertexArray(0u);
+    glDeleteVertexArrays(1, &vao);
+
+    // Flips the bytes of a binary, which the driver must reject.
+    std::vector<std::filesystem::path> entries;
+    for (auto const& it : std::filesystem::directory_iterator(directory)) {
+        if (".bin" == it.path().extension()) {
+            entries.push_back(it.path());
+        }
+    }
+    {
+        std::fstream file(entries.front(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(64);
+        std::string const garbage(256u, '\x5a');
+        file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+    {
+        nest::ProgramCache cache(directory);
+        build_programs(cache, programs);
+        auto const statistics = cache.get_statistics();
+        auto drawable = true;
+        for (auto const& program : programs) {
+            drawable = drawable && program;
+        }
+        std::cout << "Corrupted entry recompiled: " << (drawable ? "yes" : "no") << ", " << statistics.rejections
+                  << " rejected, " << statistics.writes << " rewritten\n";
+    }
+
+    // Cuts an entry short, and makes the header of another one claim a huge binary. The size follows the magic, the
+    // format, and the key in the header.
+    std::filesystem::resize_file(entries[1], std::filesystem::file_size(entries[1]) / 2u);
+    {
+        std::fstream file(entries[2], std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(24);
+        std::uint64_t const size = ~std::uint64_t{0u};
+        file.write(reinterpret_cast<char const*>(&size), sizeof(size));
+    }
+    {
+        nest::ProgramCache cache(directory);
+        build_programs(cache, programs);
+        auto const statistics = cache.get_statistics();
+        auto drawable = true;
+        for (auto const& program : programs) {
+            drawable = drawable && program;
+        }
+        std::cout << "Truncated entries recompiled: " << (drawable ? "yes" : "no") << ", " << statistics.rejections
+                  << " rejected, " << statistics.writes << " rewritten\n";
+    }
+
+    // Pretends that the entries were written by another driver.
+    std::ofstream(directory / "driver", std::ios::binary | std::ios::trunc) << "Another vendor\n";
+    {
+        nest::ProgramCache cache(directory);
+        std::cout << "Entries removed after a driver update: " << (0u == count_entries(directory) ? "yes" : "no")
+                  << "\n";
+    }
+
+    std::filesystem::remove_all(directory);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/quantization.cpp -lSDL2 -lGLEW -lEGL -lGL
+
+Runs on a headless context. Expected output:
+
+    Half round trip: yes
+    Normalized round trip: yes
+    Packed round trip: yes
+    Vertex size: 36 bytes, quantized: 16 bytes
+    Largest errors: position <= 0.0005, color <= 0.002, texcoord <= 0.0005
+    Pixels differing by more than 2 levels: 0
+
+Quantizing the vertices cuts their size by more than half, while the images differ by rounding only.
+*/
+
+struct Vertex final {
+    glm::vec3 position;
+    glm::vec4 color;
+    glm::vec2 texcoord;
+};
+
+/// \returns `true` when every finite half float survives a round trip through a float, `false` otherwise.
+bool check_half()
+{
+    for (std::uint32_t bits = 0u; bits <= 0xffffu; ++bits) {
+        nest::Half half;
+        half.bits = static_cast<std::uint16_t>(bits);
+        auto const value = static_cast<float>(half);
+        if (!std::isnan(value) && nest::Half(value).bits != half.bits) {
+            return false;
+        }
+    }
+
+    // Rounds to nearest even, and overflows into infinity.
+    return 0x3c00u == nest::Half(1.f + 1.f / 2048.f).bits && 0x3c02u == nest::Half(1.f + 3.f / 2048.f).bits &&
+           0x7c00u == nest::Half(65520.f).bits && 0x7bffu == nest::Half(65519.f).bits;
+}
+
+/// \returns `true` when the normalized integers keep their ends and their steps, `false` otherwise.
+bool check_normalized()
+{
+    // Both -128 and -127 are read as -1.
+    nest::Snorm8 lowest;
+    lowest.value = -128;
+
+    return 255u == nest::Unorm8(1.f).value && 0u == nest::Unorm8(-0.5f).value && 128u == nest::Unorm8(0.5f).value &&
+           -127 == nest::Snorm8(-1.f).value && -1.f == static_cast<float>(lowest) &&
+           32767 == nest::Snorm16(2.f).value && 65535u == nest::Unorm16(1.f).value &&
+           1.5f == static_cast<float>(nest::Fixed(1.5f)) && -65536 == nest::Fixed(-1.f).bits;
+}
+
+/// \returns `true` when the packed vectors keep their components, `false` otherwise.
+bool check_packed()
+{
+    auto const value = static_cast<glm::vec4>(nest::Snorm2101010(glm::vec4(1.f, -1.f, 0.5f, -1.f)));
+    return 1.f == value.x && -1.f == value.y && std::abs(value.z - 0.5f) <= 0.5f / 511.f && -1.f == value.w;
+}
+
+/// \returns The vertices of a grid of triangles covering the viewport, with colors and texture coordinates varying
+/// across it.
+std::vector<Vertex> make_vertices()
+{
+    constexpr std::size_t size = 32u;
+
+    std::vector<Vertex> vertices;
+    for (std::size_t y = 0u; y < size; ++y) {
+        for (std::size_t x = 0u; x < size; ++x) {
+            auto const u = static_cast<float>(x) / size;
+            auto const v = static_cast<float>(y) / size;
+            auto const step = 1.f / size;
+            auto const color = glm::vec4(u, v, 0.37f * std::sin(7.f * u) + 0.5f, 1.f);
+            for (auto const& corner : {glm::vec2(u, v), glm::vec2(u + step, v), glm::vec2(u, v + step)}) {
+                vertices.push_back({glm::vec3(2.f * corner.x - 1.f, 2.f * corner.y - 1.f, 0.f), color, corner});
+            }
+        }
+    }
+    return vertices;
+}
+
+/// Draws the given `mesh`.
+/// \returns The drawn image.
+std::vector<std::uint8_t> draw(nest::Mesh& mesh)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    mesh.draw();
+
+    std::vector<std::uint8_t> pixels(320u * 240u * 4u);
+    glReadPixels(0, 0, 320, 240, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+int main(int const argc, char const* const argv[])
+{
+    std::cout << "Half round trip: " << (check_half() ? "yes" : "no") << "\n"
+              << "Normalized round trip: " << (check_normalized() ? "yes" : "no") << "\n"
+              << "Packed round trip: " << (check_packed() ? "yes" : "no") << "\n";
+
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+            layout(location = 0) in vec3 position;
+            layout(location = 1) in vec4 color;
+            layout(location = 2) in vec2 texcoord;
+            out vec4 vertex_color;
+
+            void main() {
+                gl_Position = vec4(position, 1.0);
+                vertex_color = vec4(color.rg, mix(color.b, texcoord.x, 0.5), 1.0);
+            }
+        )")
+                                      .with_fragment_shader(R"(#version 410
+            in vec4 vertex_color;
+            out vec4 fragment_color;
+
+            void main() {
+                fragment_color = vertex_color;
+            }
+        )");
+    program.enable();
+
+    auto const vertices = make_vertices();
+
+    nest::Mesh mesh = nest::Mesh::Builder{}.with_vertices(vertices);
+    auto const expected = draw(mesh);
+
+    nest::QuantizationError error;
+    nest::Mesh quantized = nest::Mesh::Builder{}.with_quantized_vertices(vertices, &error);
+    auto const actual = draw(quantized);
+
+    std::size_t num_different = 0u;
+    for (std::size_t i = 0u; i < expected.size(); ++i) {
+        num_different += std::abs(static_cast<int>(expected[i]) - static_cast<int>(actual[i])) > 2 ? 1u : 0u;
+    }
+
+    // clang-format off
+    std::cout << "Vertex size: " << sizeof(Vertex) << " bytes, quantized: "
+              << nest::detail::QuantizedLayout<Vertex>::stride << " bytes\n"
+              << "Largest errors: position <= " << (error.position <= 0.0005f ? "0.0005" : "too much")
+              << ", color <= "                  << (error.color    <= 0.002f  ? "0.002"  : "too much")
+              << ", texcoord <= "               << (error.texcoord <= 0.0005f ? "0.0005" : "too much") << "\n"
+              << "Pixels differing by more than 2 levels: " << num_different << "\n";
+    // clang-format on
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/shader_permutations.cpp \
+        -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output:
+
+    Declared 4 features, 16 possible variants, 0 compiled on load
+    Colored triangle drawn with the HAS_COLOR variant: yes
+    Textured triangle drawn with the HAS_TEXCOORD variant: yes
+    Variants reused: yes, 2 compiled
+    Manifest:
+        HAS_COLOR
+        HAS_TEXCOORD
+    Next run prepared 2 variants ahead of time, 2 compiled
+    Prepared variants drawn: yes
+*/
+
+struct ColorVertex final {
+    glm::vec2 position;
+    glm::vec4 color;
+};
+
+struct TexcoordVertex final {
+    glm::vec2 position;
+    glm::vec2 texcoord;
+};
+
+/// \returns The permutations of a program, which takes its color from the attributes the vertices have.
+nest::ShaderPermutations make_permutations()
+{
+    return nest::ShaderPermutations::Builder{}
+        .with_vertex_shader(R"(#version 410
+            layout(location = 0) in vec2 position;
+        #ifdef HAS_COLOR
+            layout(location = 1) in vec4 color;
+        #endif
+        #ifdef HAS_TEXCOORD
+            layout(location = 2) in vec2 texcoord;
+        #endif
+        #ifdef SKINNING
+            uniform mat4 bones[64];
+        #endif
+            out vec4 vertex_color;
+
+            void main() {
+                vertex_color = vec4(1.0);
+            #ifdef HAS_COLOR
+                vertex_color *= color;
+            #endif
+            #ifdef HAS_TEXCOORD
+                vertex_color *= vec4(texcoord, 0.0, 1.0);
+            #endif
+            #ifdef SKINNING
+                gl_Position = bones[0] * vec4(position, 0.0, 1.0);
+            #else
+                gl_Position = vec4(position, 0.0, 1.0);
+            #endif
+            }
+        )")
+        .with_fragment_shader(R"(#version 410
+            in vec4 vertex_color;
+            out vec4 fragment_color;
+
+            void main() {
+            #ifdef FOG
+                fragment_color = mix(vertex_color, vec4(0.5), 0.5);
+            #else
+                fragment_color = vertex_color;
+            #endif
+            }
+        )")
+        .with_feature(nest::ShaderPermutations::ColorFeature)
+        .with_feature(nest::ShaderPermutations::TexcoordFeature)
+        .with_feature("SKINNING")
+        .with_feature("FOG");
+}
+
+/// Draws a frame with a triangle of the given `Vertex` type, which covers the center of the viewport.
+/// \returns `true` when the center of the frame has the given color, `false` otherwise.
+template <typename Vertex>
+bool draw(nest::ShaderPermutations& permutations, Vertex const& vertex, std::uint8_t const red,
+          std::uint8_t const green)
+{
+    std::vector<Vertex> vertices(3u, vertex);
+    vertices[0].position = glm::vec2(-0.5f, -0.5f);
+    vertices[1].position = glm::vec2(0.5f, -0.5f);
+    vertices[2].position = glm::vec2(0.f, 0.5f);
+    nest::Mesh mesh = nest::Mesh::Builder{}.with_vertices(vertices);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    permutations.get<Vertex>().enable();
+    mesh.draw();
+
+    std::uint8_t pixel[4] = {};
+    glReadPixels(32, 32, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    return red == pixel[0] && green == pixel[1] && 0u == pixel[2];
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(64, 64);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+
+    ColorVertex const color_vertex = {glm::vec2(), glm::vec4(0.f, 1.f, 0.f, 1.f)};
+    TexcoordVertex const texcoord_vertex = {glm::vec2(), glm::vec2(1.f, 0.f)};
+
+    std::string manifest;
+    {
+        auto permutations = make_permutations();
+        std::cout << "Declared 4 features, 16 possible variants, " << permutations.get_variant_count()
+                  << " compiled on load\n";
+
+        std::cout << "Colored triangle drawn with the HAS_COLOR variant: "
+                  << (draw(permutations, color_vertex, 0u, 255u) ? "yes" : "no") << "\n";
+        std::cout << "Textured triangle drawn with the HAS_TEXCOORD variant: "
+                  << (draw(permutations, texcoord_vertex, 255u, 0u) ? "yes" : "no") << "\n";
+
+        auto const handle = permutations.get<ColorVertex>().get_handle();
+        auto const reused = handle == permutations.get(permutations.get_mask({"HAS_COLOR"})).get_handle();
+        std::cout << "Variants reused: " << (reused ? "yes" : "no") << ", " << permutations.get_variant_count()
+                  << " compiled\n";
+
+        manifest = permutations.get_manifest();
+        std::cout << "Manifest:\n";
+        for (std::size_t begin = 0u, end = 0u; begin < manifest.size(); begin = end + 1u) {
+            end = manifest.find('\n', begin);
+            std::cout << "    " << manifest.substr(begin, end - begin) << "\n";
+        }
+    }
+    {
+        auto permutations = make_permutations();
+        auto const num_prepared = permutations.prepare(manifest);
+        std::cout << "Next run prepared " << num_prepared << " variants ahead of time, "
+                  << permutations.get_variant_count() << " compiled\n";
+
+        auto const drawn =
+            draw(permutations, color_vertex, 0u, 255u) && draw(permutations, texcoord_vertex, 255u, 0u) &&
+            2u == permutations.get_variant_count();
+        std::cout << "Prepared variants drawn: " << (drawn ? "yes" : "no") << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
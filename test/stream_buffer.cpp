@@ -0,0 +1,149 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/stream_buffer.cpp -lSDL2 -lGLEW -lEGL -lGL
+
+Runs on a headless context. Expected output, the numbers vary from machine to machine:
+
+    glBufferData:       <N> ms per frame
+    Persistent mapping: <M> ms per frame, 240000 bytes per frame, <W> waits, 0 orphans, data intact: yes
+    Orphaning:          <K> ms per frame, 240000 bytes per frame, 0 waits, <O> orphans, data intact: yes
+
+On a GPU both streaming strategies should beat reallocating the buffer every frame. On a software rasterizer drawing
+dominates, so the difference is small.
+*/
+
+struct Vertex final {
+    glm::vec2 position;
+    glm::vec4 color;
+};
+
+constexpr std::size_t num_vertices = 10'000u;
+constexpr std::size_t num_frames = 300u;
+
+/// Writes the vertices of the given `frame`, which form a rotating ring of points.
+void write_vertices(Vertex* const vertices, std::size_t const frame)
+{
+    for (std::size_t i = 0u; i < num_vertices; ++i) {
+        auto const angle = 0.01f * static_cast<float>(frame + i);
+        vertices[i].position = glm::vec2(std::cos(angle), std::sin(angle));
+        vertices[i].color = glm::vec4(1.f, static_cast<float>(i % 256u) / 255.f, 0.f, 1.f);
+    }
+}
+
+/// \returns Milliseconds per frame of drawing vertices, which are re-uploaded every frame with `glBufferData`.
+double benchmark_buffer_data(nest::OpenGL& context)
+{
+    std::vector<Vertex> vertices(num_vertices);
+
+    nest::Mesh mesh = nest::Mesh::Builder{}.with_vertices(vertices);
+    mesh.enable();
+
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0u; frame < num_frames; ++frame) {
+        write_vertices(vertices.data(), frame);
+        glBufferData(GL_ARRAY_BUFFER, num_vertices * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glDrawArrays(GL_POINTS, 0, num_vertices);
+        context.swap_buffers();
+    }
+    glFinish();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / num_frames;
+}
+
+/// Draws vertices streamed with the given `strategy`, and reports the time per frame and the counters.
+void benchmark_stream_buffer(nest::OpenGL& context, nest::StreamBuffer::Strategy const strategy)
+{
+    // Holds about three frames.
+    nest::StreamBuffer buffer(3u * num_vertices * sizeof(Vertex) + 1024u, strategy);
+
+    nest::Mesh mesh = nest::Mesh::Builder{}.with_streaming_vertices<Vertex>(buffer);
+    mesh.enable();
+
+    nest::StreamBuffer::Range<Vertex> range;
+
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0u; frame < num_frames; ++frame) {
+        range = buffer.map<Vertex>(num_vertices);
+        if (!range) {
+            std::cerr << "Failed to map a range of the stream buffer.\n";
+            return;
+        }
+        write_vertices(range.data, frame);
+        buffer.unmap();
+
+        glDrawArrays(GL_POINTS, range.first(), num_vertices);
+
+        buffer.end_frame();
+        context.swap_buffers();
+    }
+    glFinish();
+    auto const duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Reads back the last frame's vertices, and compares them with the expected ones.
+    std::vector<Vertex> expected(num_vertices);
+    std::vector<Vertex> actual(num_vertices);
+    write_vertices(expected.data(), num_frames - 1u);
+    nest::detail::bind_buffer(GL_COPY_READ_BUFFER, buffer.get_handle());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, range.offset, num_vertices * sizeof(Vertex), actual.data());
+
+    auto intact = true;
+    for (std::size_t i = 0u; i < num_vertices; ++i) {
+        intact = intact && expected[i].position.x == actual[i].position.x && expected[i].color.y == actual[i].color.y;
+    }
+
+    auto const& counters = buffer.get_counters();
+    auto const persistent = nest::StreamBuffer::Strategy::PersistentMapping == strategy;
+
+    // clang-format off
+    std::cout << (persistent ? "Persistent mapping: " : "Orphaning:          ")
+              << duration / num_frames                      << " ms per frame, "
+              << buffer.get_frame_counters().uploaded_bytes << " bytes per frame, "
+              << counters.wait_count                        << " waits, "
+              << counters.orphan_count                      << " orphans, data intact: "
+              << (intact ? "yes" : "no")                    << "\n";
+    // clang-format on
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(320, 240);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+            layout(location = 0) in vec2 position;
+            layout(location = 1) in vec4 color;
+            out vec4 vertex_color;
+
+            void main() {
+                gl_Position = vec4(position, 0.0, 1.0);
+                vertex_color = color;
+            }
+        )")
+                                      .with_fragment_shader(R"(#version 410
+            in vec4 vertex_color;
+            out vec4 fragment_color;
+
+            void main() {
+                fragment_color = vertex_color;
+            }
+        )");
+    program.enable();
+
+    std::cout << "glBufferData:       " << benchmark_buffer_data(context) << " ms per frame\n";
+    benchmark_stream_buffer(context, nest::StreamBuffer::Strategy::PersistentMapping);
+    benchmark_stream_buffer(context, nest::StreamBuffer::Strategy::Orphaning);
+
+    return EXIT_SUCCESS;
+}
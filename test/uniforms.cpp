@@ -0,0 +1,225 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nest/renderer_context.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. -DNEST_OPENGL_HEADLESS=1 test/uniforms.cpp -lSDL2 -lGLEW -lEGL -lGL -lpthread
+
+Runs on a headless context. Expected output, the alignment of blocks varies from driver to driver:
+
+    Block layout: 6 members, 160 bytes, offsets match the driver: yes
+    Uniforms set through handles: yes
+    Mismatched and missing uniforms rejected: yes
+    Ring with persistent mapping: 4 draws per frame, <N>-byte aligned blocks, quadrants drawn: yes
+    Ring with orphaning: 4 draws per frame, <N>-byte aligned blocks, quadrants drawn: yes
+    Generic binding kept after a skipped range rebind: yes
+*/
+
+/// The per-draw data, which mirrors the `Draw` uniform block of the shader. The C++ layout differs from the std140
+/// one: `uv_scale` follows `intensity` right away, and the columns of `normal_matrix` are not padded.
+struct DrawBlock final {
+    glm::mat4 transform;
+    glm::vec3 light_direction;
+    float intensity;
+    glm::vec2 uv_scale;
+    glm::mat3 normal_matrix;
+    glm::vec4 tint;
+};
+
+using Layout = nest::Std140Layout<DrawBlock>;
+
+static_assert(6u == Layout::member_count);
+static_assert(64u == Layout::get_offset(1u));
+static_assert(76u == Layout::get_offset(2u));
+static_assert(80u == Layout::get_offset(3u));
+static_assert(96u == Layout::get_offset(4u));
+static_assert(144u == Layout::get_offset(5u));
+static_assert(160u == Layout::size);
+
+struct Vertex final {
+    glm::vec2 position;
+};
+
+/// \returns The color of the given pixel of the frame.
+glm::uvec4 read_pixel(int const x, int const y)
+{
+    std::uint8_t pixel[4] = {};
+    glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    return {pixel[0], pixel[1], pixel[2], pixel[3]};
+}
+
+/// Draws a quad into every quadrant of the frame, each with its own block pushed into a ring of the given `strategy`.
+/// \returns `true` when the quadrants have the colors of their blocks, `false` otherwise.
+bool draw_quadrants(nest::ShaderProgram& program, nest::Mesh& quad, nest::StreamBuffer::Strategy const strategy)
+{
+    nest::UniformRing ring(64u * 1024u, strategy);
+    program.enable();
+
+    auto drawn = true;
+    for (int frame = 0; frame < 3; ++frame) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (int i = 0; i < 4; ++i) {
+            DrawBlock block = {};
+            block.transform = glm::mat4(0.5f);
+            block.transform[3] = glm::vec4(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, 0.f, 1.f);
+            block.light_direction = glm::vec3(0.f, 0.f, 1.f);
+            block.intensity = 1.f;
+            block.uv_scale = glm::vec2(1.f, 1.f);
+            block.normal_matrix = glm::mat3(1.f);
+            block.tint = glm::vec4(i & 1 ? 1.f : 0.f, i & 2 ? 1.f : 0.f, 1.f, 1.f);
+
+            ring.bind(0u, ring.push(block));
+            quad.draw();
+        }
+        ring.end_frame();
+
+        for (int i = 0; i < 4; ++i) {
+            auto const expected = glm::uvec4(i & 1 ? 255u : 0u, i & 2 ? 255u : 0u, 255u, 255u);
+            drawn = drawn && expected == read_pixel(i & 1 ? 48 : 16, i & 2 ? 48 : 16);
+        }
+    }
+    return drawn;
+}
+
+/// Rebinds a range to a binding point, which the `StateCache` skips, after another buffer has been bound to the
+/// generic `GL_UNIFORM_BUFFER` binding point, then binds the buffer of the range to the generic one.
+/// \returns `true` when an upload to the generic binding point reaches the buffer of the range, `false` otherwise.
+bool rebind_uniform_range()
+{
+    auto const cache = nest::StateCache::current();
+
+    GLuint buffers[2] = {};
+    glGenBuffers(2, buffers);
+    for (auto const buffer : buffers) {
+        cache->bind_buffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, 256, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    cache->bind_uniform_buffer(0u, buffers[0], 0, 256);
+    cache->bind_buffer(GL_UNIFORM_BUFFER, buffers[1]);
+    cache->bind_uniform_buffer(0u, buffers[0], 0, 256);
+    cache->bind_buffer(GL_UNIFORM_BUFFER, buffers[0]);
+
+    std::uint32_t const value = 0x12345678u;
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(value), &value);
+
+    std::uint32_t actual = 0u;
+    cache->bind_buffer(GL_COPY_READ_BUFFER, buffers[0]);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(actual), &actual);
+
+    GLint bound = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_BINDING, &bound);
+
+    nest::detail::delete_buffers(2, buffers);
+    return value == actual && buffers[0] == static_cast<GLuint>(bound);
+}
+
+int main(int const argc, char const* const argv[])
+{
+    auto context = nest::make_headless_renderer_context(64, 64);
+    if (!context) {
+        std::cerr << "Failed to initialize headless OpenGL 4.1 context.\n";
+        return EXIT_FAILURE;
+    }
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+
+    std::vector<Vertex> vertices = {
+        {glm::vec2(-1.f, -1.f)}, {glm::vec2(1.f, -1.f)}, {glm::vec2(1.f, 1.f)},
+        {glm::vec2(-1.f, -1.f)}, {glm::vec2(1.f, 1.f)},  {glm::vec2(-1.f, 1.f)},
+    };
+    nest::Mesh quad = nest::Mesh::Builder{}.with_vertices(vertices);
+
+    nest::ShaderProgram block_program = nest::ShaderProgram::Builder{}
+                                            .with_vertex_shader(R"(#version 410
+                                                layout(location = 0) in vec2 position;
+                                                layout(std140) uniform Draw {
+                                                    mat4 transform;
+                                                    vec3 light_direction;
+                                                    float intensity;
+                                                    vec2 uv_scale;
+                                                    mat3 normal_matrix;
+                                                    vec4 tint;
+                                                };
+                                                out vec4 vertex_color;
+
+                                                void main() {
+                                                    gl_Position = transform * vec4(position, 0.0, 1.0);
+                                                    vec3 normal = normal_matrix * light_direction;
+                                                    vertex_color = tint * intensity * normal.z * uv_scale.x;
+                                                }
+                                            )")
+                                            .with_fragment_shader(R"(#version 410
+                                                in vec4 vertex_color;
+                                                out vec4 fragment_color;
+
+                                                void main() {
+                                                    fragment_color = vertex_color;
+                                                }
+                                            )");
+
+    GLchar const* const names[] = {"transform", "light_direction", "intensity", "uv_scale", "normal_matrix", "tint"};
+    GLuint indices[Layout::member_count] = {};
+    GLint offsets[Layout::member_count] = {};
+    glGetUniformIndices(block_program.get_handle(), Layout::member_count, names, indices);
+    glGetActiveUniformsiv(block_program.get_handle(), Layout::member_count, indices, GL_UNIFORM_OFFSET, offsets);
+    auto offsets_match = block_program.bind_uniform_block<DrawBlock>("Draw", 0u);
+    for (std::size_t i = 0u; i < Layout::member_count; ++i) {
+        offsets_match = offsets_match && Layout::get_offset(i) == static_cast<std::size_t>(offsets[i]);
+    }
+    std::cout << "Block layout: " << Layout::member_count << " members, " << Layout::size
+              << " bytes, offsets match the driver: " << (offsets_match ? "yes" : "no") << "\n";
+
+    nest::ShaderProgram program = nest::ShaderProgram::Builder{}
+                                      .with_vertex_shader(R"(#version 410
+                                          layout(location = 0) in vec2 position;
+
+                                          void main() {
+                                              gl_Position = vec4(position, 0.0, 1.0);
+                                          }
+                                      )")
+                                      .with_fragment_shader(R"(#version 410
+                                          uniform vec4 tint;
+                                          uniform float scales[4];
+                                          out vec4 color;
+
+                                          void main() {
+                                              color = tint * scales[2];
+                                          }
+                                      )");
+
+    auto const tint = program.get_uniform<glm::vec4>("tint");
+    auto const scales = program.get_uniform<float>("scales");
+    float const scale_values[] = {0.f, 0.f, 1.f, 0.f};
+    tint.set(glm::vec4(1.f, 1.f, 0.f, 1.f));
+    scales.set(scale_values, 4u);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    program.enable();
+    quad.draw();
+    std::cout << "Uniforms set through handles: "
+              << (tint && scales && glm::uvec4(255u, 255u, 0u, 255u) == read_pixel(32, 32) ? "yes" : "no") << "\n";
+
+    auto const rejected = !program.get_uniform<glm::vec3>("tint") && !program.get_uniform<float>("missing") &&
+                          scales.get_location() == program.get_uniform<float>("scales[0]").get_location() &&
+                          !block_program.bind_uniform_block("Missing", 1u);
+    std::cout << "Mismatched and missing uniforms rejected: " << (rejected ? "yes" : "no") << "\n";
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    std::cout << "Ring with persistent mapping: 4 draws per frame, " << alignment << "-byte aligned blocks, quadrants "
+              << "drawn: "
+              << (draw_quadrants(block_program, quad, nest::StreamBuffer::Strategy::PersistentMapping) ? "yes" : "no")
+              << "\n";
+    std::cout << "Ring with orphaning: 4 draws per frame, " << alignment << "-byte aligned blocks, quadrants drawn: "
+              << (draw_quadrants(block_program, quad, nest::StreamBuffer::Strategy::Orphaning) ? "yes" : "no")
+              << "\n";
+
+    std::cout << "Generic binding kept after a skipped range rebind: " << (rebind_uniform_range() ? "yes" : "no")
+              << "\n";
+
+    return EXIT_SUCCESS;
+}
@@ -12,6 +12,19 @@ struct Vertex {
     int blah;
 };
 
+struct PackedVertex {
+    nest::Half position[3];
+    nest::Unorm8 color[4];
+    nest::Snorm16 texcoord[2];
+    nest::Snorm2101010 normal;
+};
+
+struct Instance {
+    glm::mat4 transform;
+    glm::vec4 tint;
+    glm::mat3 normal_transform;
+};
+
 struct Dummy {
 };
 
@@ -30,6 +43,16 @@ struct Evil {
     {
         return false;
     }
+
+    glm::mat4 transform()
+    {
+        return glm::mat4(1.f);
+    }
+
+    glm::vec4 tint()
+    {
+        return glm::vec4(1.f);
+    }
 };
 
 /*
@@ -41,6 +64,13 @@ Expected output:
     1 0 0
     5126 5126 5126
     3 3 2 1
+    5131 5121 5122 36255
+    3 4 2 4
+    0 1 1 1
+    1 0 0
+    1 0 0
+    4 4 3
+    4 1 3
 */
 
 int main(int const argc, char const* const argv[])
@@ -76,5 +106,54 @@ int main(int const argc, char const* const argv[])
               << nest::component_count<decltype(Vertex::blah    )> << std::endl;
     // clang-format on
 
+    // clang-format off
+    std::cout << nest::opengl_type<decltype(PackedVertex::position)> << " "
+              << nest::opengl_type<decltype(PackedVertex::color   )> << " "
+              << nest::opengl_type<decltype(PackedVertex::texcoord)> << " "
+              << nest::opengl_type<decltype(PackedVertex::normal  )> << std::endl;
+    // clang-format on
+
+    // clang-format off
+    std::cout << nest::component_count<decltype(PackedVertex::position)> << " "
+              << nest::component_count<decltype(PackedVertex::color   )> << " "
+              << nest::component_count<decltype(PackedVertex::texcoord)> << " "
+              << nest::component_count<decltype(PackedVertex::normal  )> << std::endl;
+    // clang-format on
+
+    // clang-format off
+    std::cout << nest::is_normalized<decltype(PackedVertex::position)> << " "
+              << nest::is_normalized<decltype(PackedVertex::color   )> << " "
+              << nest::is_normalized<decltype(PackedVertex::texcoord)> << " "
+              << nest::is_normalized<decltype(PackedVertex::normal  )> << std::endl;
+    // clang-format on
+
+    // clang-format off
+    std::cout << nest::has_transform<Instance> << " "
+              << nest::has_transform<Dummy>    << " "
+              << nest::has_transform<Evil>     << std::endl;
+    // clang-format on
+
+    // clang-format off
+    std::cout << nest::has_tint<Instance> << " "
+              << nest::has_tint<Dummy>    << " "
+              << nest::has_tint<Evil>     << std::endl;
+    // clang-format on
+
+    // clang-format off
+    std::cout << nest::component_count<decltype(Instance::transform       )> << " "
+              << nest::component_count<decltype(Instance::tint            )> << " "
+              << nest::component_count<decltype(Instance::normal_transform)> << std::endl;
+    // clang-format on
+
+    // clang-format off
+    std::cout << nest::slot_count<decltype(Instance::transform       )> << " "
+              << nest::slot_count<decltype(Instance::tint            )> << " "
+              << nest::slot_count<decltype(Instance::normal_transform)> << std::endl;
+    // clang-format on
+
+    static_assert(nest::has_transform<Instance> && !nest::has_transform<Evil>, "has_transform is broken.");
+    static_assert(nest::has_tint<Instance> && !nest::has_tint<Evil>, "has_tint is broken.");
+    static_assert(4u == nest::slot_count<glm::mat4> && 1u == nest::slot_count<glm::vec4>, "slot_count is broken.");
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <nest/mesh_format.hpp>
+#include <nest/mesh_optimizer.hpp>
+#include <nest/mesh_simplifier.hpp>
+#include <nest/obj_parser.hpp>
+
+/*
+Build:
+    g++ -std=c++17 -O2 -Wall -Werror -I. tools/mesh_cooker.cpp -o mesh_cooker
+
+Usage:
+    mesh_cooker [--optimize] [--lods <count>] <input.obj> <output.mesh>
+
+Converts a Wavefront OBJ file into a mesh file, which `nest::MeshFile` maps into memory and `Mesh::Builder` uploads
+with no parsing. The vertices keep the attributes found in the OBJ file: positions, and colors and texture coordinates
+if present. With `--optimize` the mesh is optimized by `optimize_mesh`, and with `--lods` a chain of up to the given
+number of levels of detail is built by `build_lod_chain`. glTF files are not supported yet.
+*/
+
+// clang-format off
+/// Vertices of the attributes found in OBJ files.
+/// @{
+struct FullVertex     final { glm::vec3 position; glm::vec4 color; glm::vec2 texcoord; };
+struct ColorVertex    final { glm::vec3 position; glm::vec4 color; };
+struct TexturedVertex final { glm::vec3 position; glm::vec2 texcoord; };
+struct PositionVertex final { glm::vec3 position; };
+/// @}
+// clang-format on
+
+/// Holds the command line options.
+struct Options final {
+    bool optimize = false;
+    std::size_t lod_count = 1u;
+    std::string input;
+    std::string output;
+};
+
+/// Writes the given parsed `vertices` and `indices` into a mesh file, keeping the attributes of the given `Vertex`
+/// type only.
+/// \returns `true` on success, `false` otherwise.
+template <typename Vertex>
+bool cook(std::vector<FullVertex> const& parsed, std::vector<std::uint32_t> indices, Options const& options)
+{
+    std::vector<Vertex> vertices(parsed.size());
+    for (std::size_t i = 0u; i < parsed.size(); ++i) {
+        vertices[i].position = parsed[i].position;
+        if constexpr (nest::has_color<Vertex>) {
+            vertices[i].color = parsed[i].color;
+        }
+        if constexpr (nest::has_texcoord<Vertex>) {
+            vertices[i].texcoord = parsed[i].texcoord;
+        }
+    }
+
+    if (options.optimize) {
+        auto const report = nest::optimize_mesh(vertices, indices);
+        std::cout << "Optimized: ACMR " << report.before.acmr << " -> " << report.after.acmr << ", ATVR "
+                  << report.before.atvr << " -> " << report.after.atvr << "\n";
+    }
+
+    std::vector<nest::MeshLod> lods;
+    if (options.lod_count > 1u) {
+        nest::LodOptions lod_options;
+        lod_options.max_level_count = options.lod_count;
+
+        auto chain = nest::build_lod_chain(vertices, indices, lod_options);
+        indices = std::move(chain.indices);
+        lods = std::move(chain.levels);
+        for (std::size_t level = 0u; level < lods.size(); ++level) {
+            std::cout << "Level " << level << ": " << lods[level].index_count / 3u << " triangles, error "
+                      << lods[level].error << "\n";
+        }
+    }
+
+    std::cout << "Writing " << vertices.size() << " vertices of " << sizeof(Vertex) << " bytes, " << indices.size()
+              << " indices.\n";
+    return nest::write_mesh_file(options.output.c_str(), vertices, indices, lods);
+}
+
+int main(int const argc, char const* const argv[])
+{
+    Options options;
+    std::vector<std::string> paths;
+    for (auto i = 1; i < argc; ++i) {
+        std::string const argument = argv[i];
+        if ("--optimize" == argument) {
+            options.optimize = true;
+        }
+        else if ("--lods" == argument && i + 1 < argc) {
+            options.lod_count = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!argument.empty() && '-' == argument[0]) {
+            std::cerr << "Unknown argument " << argument << ".\n";
+            return EXIT_FAILURE;
+        }
+        else {
+            paths.push_back(argument);
+        }
+    }
+
+    if (2u != paths.size()) {
+        std::cerr << "Usage: mesh_cooker [--optimize] [--lods <count>] <input.obj> <output.mesh>\n";
+        return EXIT_FAILURE;
+    }
+    options.input = paths[0];
+    options.output = paths[1];
+
+    std::ifstream file(options.input, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open " << options.input << ".\n";
+        return EXIT_FAILURE;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::vector<FullVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    nest::ObjAttributes attributes;
+    if (!nest::parse_obj(text.str(), vertices, indices, &attributes) || indices.empty()) {
+        std::cerr << "Cannot parse " << options.input << ": not an OBJ file, or one with no faces.\n";
+        return EXIT_FAILURE;
+    }
+
+    auto const cooked = attributes.has_color && attributes.has_texcoord ? cook<FullVertex>(vertices, indices, options)
+                        : attributes.has_color    ? cook<ColorVertex>(vertices, indices, options)
+                        : attributes.has_texcoord ? cook<TexturedVertex>(vertices, indices, options)
+                                                  : cook<PositionVertex>(vertices, indices, options);
+    if (!cooked) {
+        std::cerr << "Cannot write " << options.output << ".\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}